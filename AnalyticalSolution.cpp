@@ -0,0 +1,442 @@
+#include "AnalyticalSolution.h"
+
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+#include "Instrumentation.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ANALYTICAL_X86 1
+//! The vector helpers are always inlined into the AVX2 / AVX-512 kernels, no vector crosses a call boundary
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace
+{
+	//! Largest number of terms of either series
+	constexpr int MAX_TERMS = 1 << 20;
+	//! Cost of one erf call in Fourier terms (one rotation and one product per point, vectorized), measured
+	constexpr double ERF_COST = 100.0;
+	//! Points evaluated at once by the error norms
+	constexpr int NORM_BLOCK = 1024;
+	//! erf(z) rounds to +-1 for |z| >= 6 (erfc(6) < 2.2e-17), so a face only needs erf on the points closer than 6 widths
+	constexpr double ERF_SATURATION = 6.0;
+
+	//! Signature of a Fourier kernel: out[i] = tsurf + sum_j coefficients[j] sin((2j + 1) theta_i) for count points
+	typedef void (*FourierKernel)(const double *sine, const double *cosine, const double *rotationSine, const double *rotationCosine,
+								  const double *coefficients, int terms, double tsurf, double *out, long count);
+
+	//! Scalar sum on the points [first, count); the odd harmonics follow by rotating (sin, cos) of n theta by 2 theta
+	void fourierScalar(const double *sine, const double *cosine, const double *rotationSine, const double *rotationCosine,
+					   const double *coefficients, int terms, double tsurf, double *out, long first, long count)
+	{
+		for (long i = first; i < count; i++)
+		{
+			double s = sine[i];
+			double c = cosine[i];
+			double sum = 0;
+			for (int j = 0; j < terms; j++)
+			{
+				sum = sum + coefficients[j] * s;
+				double rotated = s * rotationCosine[i] + c * rotationSine[i];
+				c = c * rotationCosine[i] - s * rotationSine[i];
+				s = rotated;
+			}
+			out[i] = tsurf + sum;
+		}
+	}
+
+	void kernelScalar(const double *sine, const double *cosine, const double *rotationSine, const double *rotationCosine,
+					  const double *coefficients, int terms, double tsurf, double *out, long count)
+	{
+		fourierScalar(sine, cosine, rotationSine, rotationCosine, coefficients, terms, tsurf, out, 0, count);
+	}
+
+#ifdef ANALYTICAL_X86
+	typedef double Vector4 __attribute__((vector_size(32)));
+	typedef double Vector8 __attribute__((vector_size(64)));
+
+	template <class V>
+	__attribute__((always_inline)) inline V load(const double *p)
+	{
+		V value;
+		__builtin_memcpy(&value, p, sizeof(V));
+		return value;
+	}
+
+	//! Four registers of W points at a time, so that the rotations of independent points hide each other's latency
+	template <class V, int W>
+	__attribute__((always_inline)) inline void fourierVector(const double *sine, const double *cosine, const double *rotationSine, const double *rotationCosine,
+															 const double *coefficients, int terms, double tsurf, double *out, long count)
+	{
+		constexpr int U = 4;
+		long i = 0;
+		for (; i + U * W <= count; i += U * W)
+		{
+			V s[U], c[U], rs[U], rc[U], sum[U];
+#pragma GCC unroll 4
+			for (int u = 0; u < U; u++)
+			{
+				s[u] = load<V>(sine + i + u * W);
+				c[u] = load<V>(cosine + i + u * W);
+				rs[u] = load<V>(rotationSine + i + u * W);
+				rc[u] = load<V>(rotationCosine + i + u * W);
+				sum[u] = V{} + 0.0;
+			}
+			for (int j = 0; j < terms; j++)
+			{
+				double coefficient = coefficients[j];
+#pragma GCC unroll 4
+				for (int u = 0; u < U; u++)
+				{
+					sum[u] = sum[u] + coefficient * s[u];
+					V rotated = s[u] * rc[u] + c[u] * rs[u];
+					c[u] = c[u] * rc[u] - s[u] * rs[u];
+					s[u] = rotated;
+				}
+			}
+#pragma GCC unroll 4
+			for (int u = 0; u < U; u++)
+			{
+				V value = tsurf + sum[u];
+				__builtin_memcpy(out + i + u * W, &value, sizeof(V));
+			}
+		}
+		fourierScalar(sine, cosine, rotationSine, rotationCosine, coefficients, terms, tsurf, out, i, count);
+	}
+
+	__attribute__((target("avx2"))) void kernelAvx2(const double *sine, const double *cosine, const double *rotationSine, const double *rotationCosine,
+													const double *coefficients, int terms, double tsurf, double *out, long count)
+	{
+		fourierVector<Vector4, 4>(sine, cosine, rotationSine, rotationCosine, coefficients, terms, tsurf, out, count);
+		//! Not inserted by the compiler here; without it the SSE code that follows (erf in libm) runs with a dirty upper state, several times slower
+		__builtin_ia32_vzeroupper();
+	}
+
+	__attribute__((target("avx512f"))) void kernelAvx512(const double *sine, const double *cosine, const double *rotationSine, const double *rotationCosine,
+														 const double *coefficients, int terms, double tsurf, double *out, long count)
+	{
+		fourierVector<Vector8, 8>(sine, cosine, rotationSine, rotationCosine, coefficients, terms, tsurf, out, count);
+		//! Not inserted by the compiler here; without it the SSE code that follows (erf in libm) runs with a dirty upper state, several times slower
+		__builtin_ia32_vzeroupper();
+	}
+#endif
+
+	//! Picks the widest kernel supported by the CPU, once
+	FourierKernel kernel()
+	{
+		static const FourierKernel selected = []
+		{
+#ifdef ANALYTICAL_X86
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+			{
+				return kernelAvx512;
+			}
+			if (__builtin_cpu_supports("avx2"))
+			{
+				return kernelAvx2;
+			}
+#endif
+			return kernelScalar;
+		}();
+		return selected;
+	}
+}
+
+// Constructor
+AnalyticalSolution::AnalyticalSolution(double D, double tsurf, double tinit, double tolerance)
+	: as_D(D), as_tsurf(tsurf), as_tinit(tinit), as_tolerance(tolerance)
+{
+	if (!(D > 0) || !(tolerance > 0))
+	{
+		throw std::invalid_argument("D and the tolerance of the analytical solution must be positive");
+	}
+}
+
+int AnalyticalSolution::fourierTerms(double length, double t) const
+{
+	if (!(t > 0))
+	{
+		return MAX_TERMS;
+	}
+	double decay = as_D * std::numbers::pi * std::numbers::pi * t / (length * length);
+	double amplitude = 4 * std::abs(as_tinit - as_tsurf) / std::numbers::pi;
+
+	//! After the terms 1, 3 .. n, the first neglected term is bounded by amplitude / (n + 2) exp(-decay (n + 2)^2),
+	//! and the tail by a geometric series of ratio exp(-decay (4 (n + 2) + 4))
+	for (int terms = 0; terms < MAX_TERMS; terms++)
+	{
+		int next = 2 * terms + 1;
+		double ratio = std::exp(-decay * (4.0 * next + 4));
+		double tail = amplitude / next * std::exp(-decay * next * next) / (1 - ratio);
+		if (tail < as_tolerance)
+		{
+			return terms;
+		}
+	}
+	return MAX_TERMS;
+}
+
+int AnalyticalSolution::imageTerms(double length, double t) const
+{
+	if (!(t > 0))
+	{
+		return 1;
+	}
+	//! Faces -M L .. M L: the neglected images are alternating and at least (M - 1) L away, each side is bounded by its first term
+	double width = 2 * std::sqrt(as_D * t);
+	double amplitude = std::abs(as_tinit - as_tsurf);
+	for (int pairs = 2; pairs < MAX_TERMS; pairs++)
+	{
+		if (amplitude * std::erfc((pairs - 1) * length / width) < as_tolerance)
+		{
+			return pairs;
+		}
+	}
+	return MAX_TERMS;
+}
+
+void AnalyticalSolution::prepareGrid(double deltax, int numberOfPoint)
+{
+	if (numberOfPoint < 2 || !(deltax > 0))
+	{
+		throw std::invalid_argument("The analytical solution needs at least two points and a positive deltax");
+	}
+	if (deltax == as_deltax && numberOfPoint == as_numberOfPoint)
+	{
+		return;
+	}
+
+	as_position.resize(numberOfPoint);
+	for (int i = 0; i < numberOfPoint; i++)
+	{
+		as_position[i] = i * deltax;
+	}
+	as_deltax = deltax;
+	as_numberOfPoint = numberOfPoint;
+	as_length = (numberOfPoint - 1) * deltax;
+	fillTables();
+}
+
+void AnalyticalSolution::prepareGrid(std::span<const double> positions)
+{
+	if (positions.size() < 2 || positions[0] != 0 || !std::is_sorted(positions.begin(), positions.end()) || !(positions.back() > 0))
+	{
+		throw std::invalid_argument("The analytical solution needs at least two increasing positions from x=0");
+	}
+	if (as_deltax == 0 && std::equal(positions.begin(), positions.end(), as_position.begin(), as_position.end()))
+	{
+		return;
+	}
+
+	as_position.assign(positions.begin(), positions.end());
+	as_deltax = 0;
+	as_numberOfPoint = positions.size();
+	as_length = positions.back();
+	fillTables();
+}
+
+void AnalyticalSolution::fillTables()
+{
+	HEAT_PROFILE_SCOPE("analytical.sine_tables");
+	as_sine.resize(as_numberOfPoint);
+	as_cosine.resize(as_numberOfPoint);
+	as_rotationSine.resize(as_numberOfPoint);
+	as_rotationCosine.resize(as_numberOfPoint);
+	for (int i = 0; i < as_numberOfPoint; i++)
+	{
+		//! On a uniform grid pi i / (N - 1), exactly the angle of the point whatever the rounding of x_i
+		double theta = as_deltax > 0 ? std::numbers::pi * i / (as_numberOfPoint - 1) : std::numbers::pi * as_position[i] / as_length;
+		as_sine[i] = std::sin(theta);
+		as_cosine[i] = std::cos(theta);
+		as_rotationSine[i] = std::sin(2 * theta);
+		as_rotationCosine[i] = std::cos(2 * theta);
+	}
+}
+
+int AnalyticalSolution::prepareTime(double t)
+{
+	if (t < 0)
+	{
+		throw std::invalid_argument("The analytical solution is defined for t >= 0");
+	}
+	double length = as_length;
+	int fourier = fourierTerms(length, t);
+	int images = imageTerms(length, t);
+	if (t == 0)
+	{
+		return images;
+	}
+
+	//! Average number of erf calls per point: each face is evaluated on the part of the wall closer than ERF_SATURATION widths
+	double reach = ERF_SATURATION * 2 * std::sqrt(as_D * t);
+	double erfCalls = 0;
+	for (int k = -images; k <= images; k++)
+	{
+		erfCalls += std::max(0.0, std::min(length, k * length + reach) - std::max(0.0, k * length - reach)) / length;
+	}
+	if (ERF_COST * erfCalls < fourier)
+	{
+		return images;
+	}
+
+	double decay = as_D * std::numbers::pi * std::numbers::pi * t / (length * length);
+	as_coefficients.resize(fourier);
+	for (int j = 0; j < fourier; j++)
+	{
+		int n = 2 * j + 1;
+		as_coefficients[j] = 4 * (as_tinit - as_tsurf) / (n * std::numbers::pi) * std::exp(-decay * n * n);
+	}
+	return 0;
+}
+
+void AnalyticalSolution::evaluateBlock(double t, int imageTerms, int first, int count, double *out) const
+{
+	int last = first + count;
+	if (imageTerms == 0)
+	{
+		kernel()(as_sine.data() + first, as_cosine.data() + first, as_rotationSine.data() + first, as_rotationCosine.data() + first,
+				 as_coefficients.data(), as_coefficients.size(), as_tsurf, out, count);
+	}
+	else if (t == 0)
+	{
+		std::fill(out, out + count, as_tinit);
+	}
+	else
+	{
+		double length = as_length;
+		double width = 2 * std::sqrt(as_D * t);
+		double reach = ERF_SATURATION * width;
+
+		//! Faces k L, k = -M .. M, weight (-1)^k (half at both ends). Away from a face its erf is +1 (k <= 0) or -1 (k >= 1),
+		//! so the sum starts from that constant and each face only corrects the points closer than 'reach'
+		double saturated = 0;
+		for (int k = -imageTerms; k <= imageTerms; k++)
+		{
+			double weight = (k % 2 ? -1.0 : 1.0) * (k == -imageTerms || k == imageTerms ? 0.5 : 1.0);
+			saturated += k <= 0 ? weight : -weight;
+		}
+		std::fill(out, out + count, saturated);
+
+		for (int k = -imageTerms; k <= imageTerms; k++)
+		{
+			double face = k * length;
+			int lo = std::max<long>(first, std::lower_bound(as_position.begin(), as_position.end(), face - reach) - as_position.begin());
+			int hi = std::min<long>(last, std::upper_bound(as_position.begin(), as_position.end(), face + reach) - as_position.begin());
+			double weight = (k % 2 ? -1.0 : 1.0) * (k == -imageTerms || k == imageTerms ? 0.5 : 1.0);
+			double sign = k <= 0 ? 1.0 : -1.0;
+			for (int i = lo; i < hi; i++)
+			{
+				out[i - first] += weight * (std::erf((as_position[i] - face) / width) - sign);
+			}
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			out[i] = as_tsurf + (as_tinit - as_tsurf) * out[i];
+		}
+	}
+
+	//! Both faces are at tsurf, exactly
+	if (first == 0)
+	{
+		out[0] = as_tsurf;
+	}
+	if (last == as_numberOfPoint)
+	{
+		out[count - 1] = as_tsurf;
+	}
+}
+
+void AnalyticalSolution::evaluate(double deltax, int numberOfPoint, double t, std::span<double> out)
+{
+	HEAT_PROFILE_SCOPE("analytical.evaluate");
+	if (out.size() != static_cast<std::size_t>(numberOfPoint))
+	{
+		throw std::invalid_argument("The output of the analytical solution must have numberOfPoint values");
+	}
+	prepareGrid(deltax, numberOfPoint);
+	int images = prepareTime(t);
+	evaluateBlock(t, images, 0, numberOfPoint, out.data());
+}
+
+std::vector<double> AnalyticalSolution::evaluate(double deltax, int numberOfPoint, double t)
+{
+	std::vector<double> temperature(numberOfPoint);
+	evaluate(deltax, numberOfPoint, t, temperature);
+	return temperature;
+}
+
+AnalyticalSolution::ErrorNorms AnalyticalSolution::errorNorms(double deltax, std::span<const double> temperature, double t)
+{
+	HEAT_PROFILE_SCOPE("analytical.error_norms");
+	int numberOfPoint = temperature.size();
+	prepareGrid(deltax, numberOfPoint);
+	int images = prepareTime(t);
+
+	ErrorNorms norms;
+	double block[NORM_BLOCK];
+	for (int first = 0; first < numberOfPoint; first += NORM_BLOCK)
+	{
+		int count = std::min(NORM_BLOCK, numberOfPoint - first);
+		evaluateBlock(t, images, first, count, block);
+		for (int i = 0; i < count; i++)
+		{
+			double difference = std::abs(temperature[first + i] - block[i]);
+			norms.l1 += difference;
+			norms.l2 += difference * difference;
+			//! A value that is not a number makes the largest error infinite
+			norms.linf = difference == difference ? std::max(norms.linf, difference) : std::numeric_limits<double>::infinity();
+		}
+	}
+	norms.l1 *= deltax;
+	norms.l2 = std::sqrt(norms.l2 * deltax);
+	return norms;
+}
+
+void AnalyticalSolution::evaluate(std::span<const double> positions, double t, std::span<double> out)
+{
+	HEAT_PROFILE_SCOPE("analytical.evaluate");
+	if (out.size() != positions.size())
+	{
+		throw std::invalid_argument("The output of the analytical solution must have one value per position");
+	}
+	prepareGrid(positions);
+	int images = prepareTime(t);
+	evaluateBlock(t, images, 0, as_numberOfPoint, out.data());
+}
+
+AnalyticalSolution::ErrorNorms AnalyticalSolution::errorNorms(std::span<const double> positions, std::span<const double> temperature, double t)
+{
+	HEAT_PROFILE_SCOPE("analytical.error_norms");
+	if (temperature.size() != positions.size())
+	{
+		throw std::invalid_argument("The profile must have one value per position");
+	}
+	int numberOfPoint = positions.size();
+	prepareGrid(positions);
+	int images = prepareTime(t);
+
+	ErrorNorms norms;
+	double block[NORM_BLOCK];
+	for (int first = 0; first < numberOfPoint; first += NORM_BLOCK)
+	{
+		int count = std::min(NORM_BLOCK, numberOfPoint - first);
+		evaluateBlock(t, images, first, count, block);
+		for (int i = 0; i < count; i++)
+		{
+			int point = first + i;
+			double cells = positions[std::min(point + 1, numberOfPoint - 1)] - positions[std::max(point - 1, 0)];
+			double difference = std::abs(temperature[point] - block[i]);
+			norms.l1 += 0.5 * cells * difference;
+			norms.l2 += 0.5 * cells * difference * difference;
+			norms.linf = difference == difference ? std::max(norms.linf, difference) : std::numeric_limits<double>::infinity();
+		}
+	}
+	norms.l2 = std::sqrt(norms.l2);
+	return norms;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#ifndef ANALYTICALSOLUTION_H
+#define ANALYTICALSOLUTION_H
+
+#include <vector>
+#include <span>
+
+/**
+ * @class AnalyticalSolution
+ * @brief Exact temperature of the wall problem set up by Initializer::getT_values: T = tinit inside at t=0 and
+ * T = tsurf at x=0 and x=L for t > 0
+ *
+ * Two exact series are used, whichever needs fewer terms at the requested time for the tolerance:
+ * - Fourier series, fast for long times:
+ *   T = tsurf + (tinit - tsurf) sum_{n odd} 4 / (n pi) sin(n pi x / L) exp(-D (n pi / L)^2 t)
+ * - image series, fast for short times (s = 2 sqrt(D t)):
+ *   T = tsurf + (tinit - tsurf) sum_k (-1)^k erf((x - k L) / s), over the images k of the two faces
+ *
+ * The grid of the last evaluation is cached: sin(pi x / L), cos(pi x / L) and the rotation by 2 pi x / L, from which
+ * the sines of the odd harmonics follow by rotation (two products per term, no sine call). The Fourier sum runs on
+ * blocks of points held in SIMD registers (AVX-512, AVX2 or scalar, chosen at runtime).
+ * The error norms evaluate the solution block by block and compare it on the fly, without storing the profile.
+ */
+
+class AnalyticalSolution
+{
+public:
+	//! Norms of the difference between a profile and the analytical solution
+	struct ErrorNorms
+	{
+		//! deltax * sum |e_i|
+		double l1 = 0;
+		//! sqrt(deltax * sum e_i^2)
+		double l2 = 0;
+		//! max |e_i|
+		double linf = 0;
+	};
+
+private:
+	//! Attributes for the physical parameters
+	double as_D;
+	double as_tsurf;
+	double as_tinit;
+	//! Attribute for the largest neglected part of a series, in temperature units
+	double as_tolerance;
+
+	//! Attributes for the cached grid: step (0 for a grid given by its positions), number of points, length, and per point
+	//! x, sin(theta), cos(theta), sin(2 theta), cos(2 theta), theta = pi x / L
+	double as_deltax = 0;
+	int as_numberOfPoint = 0;
+	double as_length = 0;
+	std::vector<double> as_position;
+	std::vector<double> as_sine;
+	std::vector<double> as_cosine;
+	std::vector<double> as_rotationSine;
+	std::vector<double> as_rotationCosine;
+	//! Attribute for the coefficients of the odd harmonics at the current time
+	std::vector<double> as_coefficients;
+
+	//! Fills the sine tables for a grid, unless it is the cached one
+	void prepareGrid(double deltax, int numberOfPoint);
+	//! Same for a grid given by its positions, from 0 to L
+	void prepareGrid(std::span<const double> positions);
+	//! Fills the sine tables from as_position and as_length
+	void fillTables();
+
+	/**
+	 * @brief Writes the solution at the points [first, first + count) of the prepared grid.
+	 * @param t Time
+	 * @param imageTerms Number of image pairs, 0 to use the Fourier series with as_coefficients
+	 */
+	void evaluateBlock(double t, int imageTerms, int first, int count, double *out) const;
+
+	/**
+	 * @brief Chooses the series for time t on the prepared grid: fills as_coefficients (Fourier) or returns the number of image pairs.
+	 * @return Number of image pairs, 0 when the Fourier series is used
+	 */
+	int prepareTime(double t);
+
+public:
+	/**
+	 * @brief Builds the evaluator.
+	 * @param D Coefficient
+	 * @param tsurf Temperature at x=0 and x=L
+	 * @param tinit Temperature at t=0
+	 * @param tolerance Largest neglected part of the series, in temperature units
+	 */
+	AnalyticalSolution(double D, double tsurf, double tinit, double tolerance = 1e-10);
+
+	/**
+	 * @brief Number of odd Fourier harmonics needed at time t on a wall of length L.
+	 */
+	int fourierTerms(double length, double t) const;
+
+	/**
+	 * @brief Number of image pairs needed at time t on a wall of length L.
+	 */
+	int imageTerms(double length, double t) const;
+
+	/**
+	 * @brief Evaluates the solution on a uniform grid x_i = i deltax, i = 0 .. numberOfPoint - 1 (L = (numberOfPoint - 1) deltax).
+	 * @param deltax Grid step
+	 * @param numberOfPoint Total number of points
+	 * @param t Time
+	 * @param out Receives the numberOfPoint temperatures
+	 */
+	void evaluate(double deltax, int numberOfPoint, double t, std::span<double> out);
+
+	//! Same, returning the profile
+	std::vector<double> evaluate(double deltax, int numberOfPoint, double t);
+
+	/**
+	 * @brief Error norms of a profile on the grid x_i = i deltax against the solution at time t, in one pass.
+	 * @param deltax Grid step
+	 * @param temperature Profile to check, one value per point
+	 * @param t Time of the profile
+	 */
+	ErrorNorms errorNorms(double deltax, std::span<const double> temperature, double t);
+
+	/**
+	 * @brief Evaluates the solution on any grid, such as the points of a stretched Grid (L is the last position).
+	 * @param positions Increasing positions of the points, from 0 to L
+	 * @param t Time
+	 * @param out Receives one temperature per point
+	 */
+	void evaluate(std::span<const double> positions, double t, std::span<double> out);
+
+	/**
+	 * @brief Error norms of a profile on any grid, each point weighted by half of its two cells (trapezoidal rule)
+	 * in the L1 and L2 norms.
+	 * @param positions Increasing positions of the points, from 0 to L
+	 * @param temperature Profile to check, one value per point
+	 * @param t Time of the profile
+	 */
+	ErrorNorms errorNorms(std::span<const double> positions, std::span<const double> temperature, double t);
+};
+#endif // ANALYTICALSOLUTION_H
@@ -0,0 +1,153 @@
+#include "BandedOperator.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+
+#include "StencilKernels.h"
+#include "Instrumentation.h"
+
+void BandedOperator::setOperator(SpatialOrder order, Boundary boundary)
+{
+	bo_order = order;
+	bo_boundary = boundary;
+}
+
+void BandedOperator::setBackend(BandedSolver::Backend backend)
+{
+	bo_backend = backend;
+}
+
+bool BandedOperator::changesOperator() const
+{
+	return bo_order != SecondOrder || bo_boundary != Dirichlet;
+}
+
+bool BandedOperator::changesSolver() const
+{
+	return changesOperator() || (bo_backend != BandedSolver::Automatic && bo_backend != BandedSolver::Thomas);
+}
+
+void BandedOperator::assemble(int size, double coefficient, double tsurf, bool crankNicholson)
+{
+	bo_crankNicholson = crankNicholson;
+	bo_boundaryTerms.clear();
+	bo_matrix.cyclic = bo_boundary == Periodic;
+	if (bo_order == SecondOrder)
+	{
+		if (size < 3)
+		{
+			throw std::invalid_argument("A periodic rod needs at least 3 points");
+		}
+		bo_matrix.lower2.clear();
+		bo_matrix.upper2.clear();
+		bo_matrix.lower.assign(size, -coefficient);
+		bo_matrix.diag.assign(size, 1 + 2 * coefficient);
+		bo_matrix.upper.assign(size, -coefficient);
+	}
+	else
+	{
+		if (size < 5)
+		{
+			throw std::invalid_argument("The fourth-order operator needs at least 5 points");
+		}
+		//! I - c M with M = (-1, 16, -30, 16, -1) / 12
+		bo_matrix.lower2.assign(size, coefficient / 12);
+		bo_matrix.lower.assign(size, -16 * coefficient / 12);
+		bo_matrix.diag.assign(size, 1 + 30 * coefficient / 12);
+		bo_matrix.upper.assign(size, -16 * coefficient / 12);
+		bo_matrix.upper2.assign(size, coefficient / 12);
+		if (bo_boundary == Dirichlet)
+		{
+			//! The boundary is tsurf one step outside the end points, and the point two steps outside is 2 tsurf - T_end:
+			//! the end rows lose 1/12 on the diagonal, and tsurf adds 14/12 to them and -1/12 to their neighbours.
+			//! The right-hand side of Crank-Nicholson holds the terms of both levels
+			double termScale = crankNicholson ? 2 : 1;
+			bo_matrix.diag[0] = bo_matrix.diag[size - 1] = 1 + 29 * coefficient / 12;
+			double end = termScale * coefficient * 14 / 12 * tsurf;
+			double next = -termScale * coefficient / 12 * tsurf;
+			bo_boundaryTerms = {{0, end}, {1, next}, {size - 2, next}, {size - 1, end}};
+		}
+	}
+	bo_rhs.resize(size);
+}
+
+void BandedOperator::assemble(const std::vector<double> &lower, const std::vector<double> &diag, const std::vector<double> &upper)
+{
+	bo_crankNicholson = false;
+	bo_boundaryTerms.clear();
+	bo_matrix.lower2.clear();
+	bo_matrix.upper2.clear();
+	bo_matrix.lower.assign(lower.begin(), lower.end());
+	bo_matrix.diag.assign(diag.begin(), diag.end());
+	bo_matrix.upper.assign(upper.begin(), upper.end());
+	bo_matrix.cyclic = false;
+}
+
+void BandedOperator::factorize()
+{
+	bo_solver.setBackend(bo_backend);
+	bo_solver.factorize(bo_matrix);
+}
+
+void BandedOperator::solve(std::span<double> x)
+{
+	bo_solver.solve(x);
+}
+
+int BandedOperator::step(std::vector<double> &temperature, int steps, double changeLimit, int level, int checkInterval, bool &steady)
+{
+	HEAT_PROFILE_COUNT("banded.steps", steps);
+	int size = bo_matrix.size();
+	for (int step = 0; step < steps; step++)
+	{
+		//! Laasonen solves in place except on the check steps, Crank-Nicholson solves its right-hand side in bo_rhs
+		bool check = changeLimit > 0 && (level + step + 1) % checkInterval == 0;
+		bool inPlace = !bo_crankNicholson && !check;
+		std::vector<double> &x = inPlace ? temperature : bo_rhs;
+		if (bo_crankNicholson)
+		{
+			HEAT_PROFILE_SCOPE("crank_nicholson.rhs_assembly");
+			bo_matrix.multiply(temperature, bo_rhs);
+			for (int i = 0; i < size; i++)
+			{
+				bo_rhs[i] = 2 * temperature[i] - bo_rhs[i];
+			}
+		}
+		else if (!inPlace)
+		{
+			bo_rhs.assign(temperature.begin(), temperature.end());
+		}
+		for (const std::pair<int, double> &term : bo_boundaryTerms)
+		{
+			x[term.first] += term.second;
+		}
+		bo_solver.solve(x);
+
+		if (inPlace)
+		{
+			continue;
+		}
+		double change = std::numeric_limits<double>::infinity();
+		if (check)
+		{
+			change = StencilKernels::copyMaxChange(bo_rhs.data(), temperature.data(), size);
+		}
+		else
+		{
+			std::copy(bo_rhs.begin(), bo_rhs.end(), temperature.begin());
+		}
+		if (change <= changeLimit)
+		{
+			steady = true;
+			return step + 1;
+		}
+	}
+	return steps;
+}
+
+// Get functions
+BandedSolver::Backend BandedOperator::getBackend() const
+{
+	return bo_solver.getBackend();
+}
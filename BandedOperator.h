@@ -0,0 +1,119 @@
+#pragma once
+#ifndef BANDEDOPERATOR_H
+#define BANDEDOPERATOR_H
+
+#include <vector>
+#include <span>
+#include <utility>
+
+#include "BandedSolver.h"
+
+/**
+ * @class BandedOperator
+ * @brief This class holds the spatial operators of the implicit schemes other than the second-order Dirichlet one,
+ * and the BandedSolver of their systems
+ *
+ * The system is I - c M on all the points of the rod, M deltax^-2 being the approximation of d2T/dx2: the
+ * fourth-order stencil gives five-band systems, the periodic rod cyclic ones. With Dirichlet conditions tsurf lies
+ * one step outside both ends, the layout of ImplicitMethods::laasonenMethod, and the point two steps outside is the
+ * odd reflection 2 tsurf - T of the end point; tsurf then adds fixed terms to the rows next to the ends.
+ * ImplicitMethods keeps its tridiagonal solvers for the second-order Dirichlet operator, and only hands that system
+ * to this class when a BandedSolver backend is forced.
+ */
+
+class BandedOperator
+{
+public:
+	//! Finite-difference approximations of d2T/dx2
+	enum SpatialOrder
+	{
+		//! (T_{i-1} - 2 T_i + T_{i+1}) / deltax^2, tridiagonal systems
+		SecondOrder,
+		//! (-T_{i-2} + 16 T_{i-1} - 30 T_i + 16 T_{i+1} - T_{i+2}) / (12 deltax^2), five-band systems
+		FourthOrder
+	};
+
+	//! Boundary conditions of the rod
+	enum Boundary
+	{
+		//! Temperature tsurf outside both ends of the rod
+		Dirichlet,
+		//! Ring of numberOfPoint points: the last point is the left neighbour of the first one, tsurf is not used
+		Periodic
+	};
+
+private:
+	//! Attributes for the operator and the backend of the next assembly
+	SpatialOrder bo_order = SecondOrder;
+	Boundary bo_boundary = Dirichlet;
+	BandedSolver::Backend bo_backend = BandedSolver::Automatic;
+	//! Attribute for the scheme of the assembled system: Crank-Nicholson, or Laasonen
+	bool bo_crankNicholson = false;
+	//! Attribute for the matrix I - c M, its factorization, and the boundary terms (row, value) added to each right-hand side
+	BandedMatrix bo_matrix;
+	BandedSolver bo_solver;
+	std::vector<std::pair<int, double>> bo_boundaryTerms;
+	//! Attribute for the right-hand side of Crank-Nicholson, and of the Laasonen steps that are checked for a steady state
+	std::vector<double> bo_rhs;
+
+public:
+	/**
+	 * @brief Selects the operator of the next assembly, second-order Dirichlet by default.
+	 */
+	void setOperator(SpatialOrder order, Boundary boundary);
+
+	/**
+	 * @brief Selects the BandedSolver backend of the next factorization, Automatic by default (see BandedSolver).
+	 */
+	void setBackend(BandedSolver::Backend backend);
+
+	//! True when the operator is not the second-order Dirichlet one
+	bool changesOperator() const;
+	//! True when the systems go through BandedSolver: another operator, or a forced backend other than Thomas
+	bool changesSolver() const;
+
+	/**
+	 * @brief Assembles I - c M with the operator of setOperator on all the points of the rod.
+	 * @param size Number of points
+	 * @param coefficient c (theta for Laasonen, lambda for Crank-Nicholson)
+	 * @param tsurf Temperature outside both ends (Dirichlet)
+	 * @param crankNicholson Crank-Nicholson, whose right-hand side also holds the boundary terms of level n, or Laasonen
+	 */
+	void assemble(int size, double coefficient, double tsurf, bool crankNicholson);
+
+	/**
+	 * @brief Takes a given tridiagonal system, the second-order Dirichlet one of ImplicitMethods, to solve it with a
+	 * forced backend (solve only, no boundary terms).
+	 */
+	void assemble(const std::vector<double> &lower, const std::vector<double> &diag, const std::vector<double> &upper);
+
+	/**
+	 * @brief Factorizes the assembled system with the backend of setBackend.
+	 */
+	void factorize();
+
+	/**
+	 * @brief Solves the factorized system in place.
+	 * @param x Right-hand side / solution
+	 */
+	void solve(std::span<double> x);
+
+	/**
+	 * @brief Takes time steps on the temperature with the assembled system: (I - c M) T^{n+1} = T^n + terms for
+	 * Laasonen, or (I - c M) T^{n+1} = (I + c M) T^n + terms = 2 T^n - (I - c M) T^n + terms for Crank-Nicholson, with
+	 * the matrix-free product of the bands. Laasonen solves in place except on the steps that produce a level multiple
+	 * of checkInterval when changeLimit > 0: those solve a copy, and the copy back measures the largest change.
+	 * @param temperature Temperature of all the points, advanced in place
+	 * @param steps Number of time steps
+	 * @param changeLimit Largest change per step of a steady level, 0 for no detection
+	 * @param level Time level of the temperature
+	 * @param checkInterval Number of time steps between two steady-state checks
+	 * @param steady Set when a check finds a steady level, on which the loop stops
+	 * @return Number of time steps taken
+	 */
+	int step(std::vector<double> &temperature, int steps, double changeLimit, int level, int checkInterval, bool &steady);
+
+	//! Backend of the factorized system
+	BandedSolver::Backend getBackend() const;
+};
+#endif // BANDEDOPERATOR_H
@@ -0,0 +1,807 @@
+#include "BandedSolver.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "Instrumentation.h"
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <immintrin.h>
+#define BANDED_SOLVER_X86 1
+#endif
+
+namespace
+{
+	/**
+	 * @brief Flushes subnormal results and operands to zero (MXCSR FTZ and DAZ) until it goes out of scope.
+	 * A correction or a Sherman-Morrison vector that decays away from a boundary layer ends up as subnormals, which
+	 * rounding keeps there (the smallest subnormal times 0.9 is itself): every later operation on them costs a
+	 * microcode assist, two orders of magnitude slower. Flushing only drops values below the smallest normal double.
+	 */
+	class FlushSubnormals
+	{
+#ifdef BANDED_SOLVER_X86
+		unsigned int fs_saved;
+
+	public:
+		FlushSubnormals() : fs_saved(_mm_getcsr())
+		{
+			_mm_setcsr(fs_saved | _MM_FLUSH_ZERO_ON | _MM_DENORMALS_ZERO_ON);
+		}
+		~FlushSubnormals()
+		{
+			_mm_setcsr(fs_saved);
+		}
+#endif
+	};
+
+	//! Grids of at most this many points are solved directly, larger ones are coarsened
+	constexpr int MULTIGRID_COARSEST = 32;
+	//! Gauss-Seidel sweeps before and after the coarse-grid correction
+	constexpr int MULTIGRID_SMOOTHING = 2;
+
+	//! Sum of the neighbour terms of row i (diagonal excluded); the neighbours outside a non-cyclic matrix are skipped
+	double neighbourSum(const BandedMatrix &matrix, const double *x, int i, int size)
+	{
+		int bandwidth = matrix.lower2.empty() ? 1 : 2;
+		double sum = 0;
+		for (int offset = -bandwidth; offset <= bandwidth; offset++)
+		{
+			int j = i + offset;
+			if (offset == 0)
+			{
+				continue;
+			}
+			if (j < 0 || j >= size)
+			{
+				if (!matrix.cyclic)
+				{
+					continue;
+				}
+				j = (j + size) % size;
+			}
+			sum += matrix.band(offset)[i] * x[j];
+		}
+		return sum;
+	}
+
+	//! Rows [first, last) of the interior, where no neighbour is missing or wraps around
+	int interiorFirst(const BandedMatrix &matrix)
+	{
+		return matrix.lower2.empty() ? 1 : 2;
+	}
+
+	int interiorLast(const BandedMatrix &matrix)
+	{
+		return std::max(interiorFirst(matrix), matrix.size() - interiorFirst(matrix));
+	}
+
+	/**
+	 * @brief One Gauss-Seidel sweep, rows in increasing or decreasing order. The sweep uses the rows scaled by their
+	 * inverse diagonal, x_i = b_i / diag_i - sum scaled_ij x_j, and adds the two neighbours just updated last: they are
+	 * the only terms on the dependency chain from one row to the next.
+	 * @param scaled Bands of the matrix divided by its diagonal (the diagonal itself is not used)
+	 * @param inverseDiag Inverse diagonal of the matrix
+	 */
+	void gaussSeidel(const BandedMatrix &scaled, const std::vector<double> &inverseDiag, double *x, const double *b, bool forward)
+	{
+		int size = scaled.size();
+		int first = std::min(interiorFirst(scaled), size);
+		int last = interiorLast(scaled);
+		const double *l2 = scaled.lower2.data();
+		const double *l1 = scaled.lower.data();
+		const double *u1 = scaled.upper.data();
+		const double *u2 = scaled.upper2.data();
+		const double *m = inverseDiag.data();
+		auto edgeRow = [&](int i)
+		{
+			x[i] = b[i] * m[i] - neighbourSum(scaled, x, i, size);
+		};
+
+		if (forward)
+		{
+			for (int i = 0; i < first; i++)
+			{
+				edgeRow(i);
+			}
+			//! The two previous values stay in registers instead of going through a store and a reload
+			double previous2 = first < last ? x[first - 2] : 0;
+			double previous1 = first < last ? x[first - 1] : 0;
+			for (int i = first; i < last; i++)
+			{
+				double ahead = b[i] * m[i] - u1[i] * x[i + 1] - u2[i] * x[i + 2];
+				double value = (ahead - l2[i] * previous2) - l1[i] * previous1;
+				x[i] = value;
+				previous2 = previous1;
+				previous1 = value;
+			}
+			for (int i = last; i < size; i++)
+			{
+				edgeRow(i);
+			}
+		}
+		else
+		{
+			for (int i = size - 1; i >= last; i--)
+			{
+				edgeRow(i);
+			}
+			double next2 = first < last ? x[last + 1] : 0;
+			double next1 = first < last ? x[last] : 0;
+			for (int i = last - 1; i >= first; i--)
+			{
+				double behind = b[i] * m[i] - l2[i] * x[i - 2] - l1[i] * x[i - 1];
+				double value = (behind - u2[i] * next2) - u1[i] * next1;
+				x[i] = value;
+				next2 = next1;
+				next1 = value;
+			}
+			for (int i = first - 1; i >= 0; i--)
+			{
+				edgeRow(i);
+			}
+		}
+	}
+
+	//! Coarse point of the right neighbour of the odd fine point i, -1 past the end of a non-cyclic grid
+	int rightCoarse(int i, int coarseSize, bool cyclic)
+	{
+		int right = (i + 1) / 2;
+		return right < coarseSize ? right : (cyclic ? 0 : -1);
+	}
+
+	/**
+	 * @brief Galerkin coarse matrix P^T A P of a five-band matrix. The coarse grid keeps the even fine points and an odd
+	 * point is interpolated from its two neighbours, so coarse column j spans the fine points 2j - 1 .. 2j + 1, A P
+	 * spans 2j - 3 .. 2j + 3 and P^T A P couples j with j - 2 .. j + 2: the coarse matrix is five-band again.
+	 */
+	void galerkinCoarse(const BandedMatrix &fine, BandedMatrix &coarse)
+	{
+		int size = fine.size();
+		int coarseSize = (size + 1) / 2;
+		bool cyclic = fine.cyclic;
+		coarse.cyclic = cyclic;
+		for (int offset = -2; offset <= 2; offset++)
+		{
+			coarse.band(offset).assign(coarseSize, 0.0);
+		}
+		double *coarseBands[5] = {coarse.lower2.data(), coarse.lower.data(), coarse.diag.data(), coarse.upper.data(), coarse.upper2.data()};
+		auto addCoarse = [&](int k, int j, double value)
+		{
+			//! Across the wrap of a cyclic grid, j - k is off by the grid size
+			int offset = j - k;
+			offset = offset > 2 ? offset - coarseSize : offset < -2 ? offset + coarseSize : offset;
+			coarseBands[offset + 2][k] += value;
+		};
+
+		const double *bands[5] = {fine.lower2.data(), fine.lower.data(), fine.diag.data(), fine.upper.data(), fine.upper2.data()};
+		for (int j = 0; j < coarseSize; j++)
+		{
+			//! Column j of P: the fine points 2j - 1 .. 2j + 1, those past a non-cyclic end are left out
+			double weight[3] = {0.5, 1.0, 0.5};
+			if (j == 0 && !(cyclic && size % 2 == 0))
+			{
+				weight[0] = 0;
+			}
+			if (2 * j + 1 >= size)
+			{
+				weight[2] = 0;
+			}
+
+			//! Column j of A P on the fine rows 2j - 3 .. 2j + 3 (wrapped around when cyclic)
+			double values[7] = {0, 0, 0, 0, 0, 0, 0};
+			for (int s = 0; s < 3; s++)
+			{
+				int column = 2 * j - 1 + s;
+				for (int offset = -2; offset <= 2 && weight[s] != 0; offset++)
+				{
+					//! A[r][column] is on the band column - r of row r
+					int r = column - offset;
+					if (r < 0 || r >= size)
+					{
+						if (!cyclic)
+						{
+							continue;
+						}
+						r = (r + size) % size;
+					}
+					values[s + 2 - offset] += bands[offset + 2][r] * weight[s];
+				}
+			}
+
+			//! Column j of P^T A P
+			for (int e = 0; e < 7; e++)
+			{
+				int r = 2 * j - 3 + e;
+				if (values[e] == 0 || ((r < 0 || r >= size) && !cyclic))
+				{
+					continue;
+				}
+				r = (r + size) % size;
+				if (r % 2 == 0)
+				{
+					addCoarse(r / 2, j, values[e]);
+					continue;
+				}
+				addCoarse((r - 1) / 2, j, 0.5 * values[e]);
+				int right = rightCoarse(r, coarseSize, cyclic);
+				if (right >= 0)
+				{
+					addCoarse(right, j, 0.5 * values[e]);
+				}
+			}
+		}
+	}
+}
+
+// BandedMatrix
+int BandedMatrix::size() const
+{
+	return diag.size();
+}
+
+std::vector<double> &BandedMatrix::band(int offset)
+{
+	return const_cast<std::vector<double> &>(static_cast<const BandedMatrix &>(*this).band(offset));
+}
+
+const std::vector<double> &BandedMatrix::band(int offset) const
+{
+	switch (offset)
+	{
+	case -2:
+		return lower2;
+	case -1:
+		return lower;
+	case 0:
+		return diag;
+	case 1:
+		return upper;
+	case 2:
+		return upper2;
+	default:
+		throw std::invalid_argument("A band offset is between -2 and 2");
+	}
+}
+
+bool BandedMatrix::pentadiagonal() const
+{
+	int n = size();
+	for (int i = 0; i < static_cast<int>(lower2.size()); i++)
+	{
+		if ((lower2[i] != 0 && (cyclic || i >= 2)) || (upper2[i] != 0 && (cyclic || i < n - 2)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool BandedMatrix::wraps() const
+{
+	int n = size();
+	if (!cyclic || n == 0)
+	{
+		return false;
+	}
+	bool corners = lower[0] != 0 || upper[n - 1] != 0;
+	bool secondCorners = !lower2.empty() && (lower2[0] != 0 || lower2[1] != 0 || upper2[n - 2] != 0 || upper2[n - 1] != 0);
+	return corners || secondCorners;
+}
+
+void BandedMatrix::multiply(std::span<const double> x, std::span<double> y) const
+{
+	int n = size();
+	if (static_cast<int>(x.size()) != n || static_cast<int>(y.size()) != n)
+	{
+		throw std::invalid_argument("The vectors of a product must have the size of the matrix");
+	}
+	int first = std::min(interiorFirst(*this), n);
+	int last = interiorLast(*this);
+	const double *l1 = lower.data();
+	const double *d = diag.data();
+	const double *u1 = upper.data();
+	for (int i = 0; i < first; i++)
+	{
+		y[i] = d[i] * x[i] + neighbourSum(*this, x.data(), i, n);
+	}
+	if (lower2.empty())
+	{
+		for (int i = first; i < last; i++)
+		{
+			y[i] = l1[i] * x[i - 1] + d[i] * x[i] + u1[i] * x[i + 1];
+		}
+	}
+	else
+	{
+		const double *l2 = lower2.data();
+		const double *u2 = upper2.data();
+		for (int i = first; i < last; i++)
+		{
+			y[i] = l2[i] * x[i - 2] + l1[i] * x[i - 1] + d[i] * x[i] + u1[i] * x[i + 1] + u2[i] * x[i + 2];
+		}
+	}
+	for (int i = last; i < n; i++)
+	{
+		y[i] = d[i] * x[i] + neighbourSum(*this, x.data(), i, n);
+	}
+}
+
+// BandedSolver
+BandedSolver::Backend BandedSolver::selectBackend(const BandedMatrix &matrix)
+{
+	bool wraps = matrix.wraps();
+	if (!matrix.pentadiagonal())
+	{
+		return wraps ? CyclicThomas : Thomas;
+	}
+	return wraps ? Multigrid : Pentadiagonal;
+}
+
+const char *BandedSolver::backendName(Backend backend)
+{
+	switch (backend)
+	{
+	case Automatic:
+		return "automatic";
+	case Thomas:
+		return "thomas";
+	case CyclicThomas:
+		return "cyclic_thomas";
+	case Pentadiagonal:
+		return "pentadiagonal";
+	case Multigrid:
+		return "multigrid";
+	}
+	return "unknown";
+}
+
+void BandedSolver::setBackend(Backend backend)
+{
+	bs_requested = backend;
+}
+
+void BandedSolver::setMultigridTolerance(double tolerance, int maxCycles)
+{
+	if (!(tolerance > 0) || maxCycles < 1)
+	{
+		throw std::invalid_argument("The multigrid tolerance must be positive and maxCycles at least 1");
+	}
+	bs_tolerance = tolerance;
+	bs_maxCycles = maxCycles;
+}
+
+void BandedSolver::factorize(const BandedMatrix &matrix)
+{
+	HEAT_PROFILE_SCOPE("banded.factorize");
+	//! No solve until the factorization is complete
+	bs_size = 0;
+	int size = matrix.size();
+	if (size == 0 || matrix.lower.size() != static_cast<std::size_t>(size) || matrix.upper.size() != static_cast<std::size_t>(size))
+	{
+		throw std::invalid_argument("Vectors diag, lower and upper must have the same non-zero size");
+	}
+	if (matrix.lower2.size() != matrix.upper2.size() || (!matrix.lower2.empty() && matrix.lower2.size() != static_cast<std::size_t>(size)))
+	{
+		throw std::invalid_argument("Vectors lower2 and upper2 must both be empty or have the size of diag");
+	}
+	//! Below these sizes, two offsets of a cyclic row would reach the same column
+	if (matrix.cyclic && size < (matrix.lower2.empty() ? 3 : 5))
+	{
+		throw std::invalid_argument("A cyclic matrix needs at least 3 rows (5 with the second bands)");
+	}
+
+	Backend backend = bs_requested == Automatic ? selectBackend(matrix) : bs_requested;
+	bool pentadiagonal = matrix.pentadiagonal();
+	bool wraps = matrix.wraps();
+	if ((backend == Thomas && (pentadiagonal || wraps)) || (backend == CyclicThomas && pentadiagonal) || (backend == Pentadiagonal && wraps))
+	{
+		throw std::invalid_argument(std::string("The ") + backendName(backend) + " backend cannot solve a matrix of this structure");
+	}
+
+	switch (backend)
+	{
+	case Thomas:
+		bs_thomas.factorize(matrix.lower, matrix.diag, matrix.upper);
+		break;
+	case CyclicThomas:
+		factorizeCyclic(matrix);
+		break;
+	case Pentadiagonal:
+		factorizePentadiagonal(matrix);
+		break;
+	default:
+		factorizeMultigrid(matrix);
+		break;
+	}
+	bs_backend = backend;
+	bs_size = size;
+	bs_cycles = 0;
+}
+
+void BandedSolver::factorizeCyclic(const BandedMatrix &matrix)
+{
+	int size = matrix.size();
+	//! A = B + u v^T with u = (gamma, 0, ..., 0, alpha) and v = (1, 0, ..., 0, beta / gamma): B is tridiagonal.
+	//! gamma = -diag_0 keeps diag_0 - gamma away from cancellation.
+	double beta = matrix.cyclic ? matrix.lower[0] : 0;
+	double alpha = matrix.cyclic ? matrix.upper[size - 1] : 0;
+	double gamma = -matrix.diag[0];
+	std::vector<double> diag(matrix.diag);
+	diag[0] -= gamma;
+	diag[size - 1] -= alpha * beta / gamma;
+	bs_thomas.factorize(matrix.lower, diag, matrix.upper);
+
+	bs_cyclicZ.assign(size, 0.0);
+	bs_cyclicZ[0] = gamma;
+	bs_cyclicZ[size - 1] += alpha;
+	{
+		//! z decays geometrically away from the two ends: without the flush, most of it would be subnormal
+		FlushSubnormals flush;
+		bs_thomas.solve(bs_cyclicZ);
+	}
+	bs_cyclicLast = beta / gamma;
+	bs_cyclicScale = 1.0 / (1.0 + bs_cyclicZ[0] + bs_cyclicLast * bs_cyclicZ[size - 1]);
+}
+
+void BandedSolver::factorizePentadiagonal(const BandedMatrix &matrix)
+{
+	int size = matrix.size();
+	bool secondBands = !matrix.lower2.empty();
+	bs_lower1.assign(size, 0.0);
+	bs_lower2.assign(size, 0.0);
+	bs_inversePivot.resize(size);
+	bs_upper1.assign(size, 0.0);
+	bs_upper2.assign(size, 0.0);
+
+	//! Row i eliminates its columns i - 2 and i - 1 with the rows i - 2 and i - 1 of U; nothing fills in outside the bands
+	for (int i = 0; i < size; i++)
+	{
+		double lower = i >= 1 ? matrix.lower[i] : 0;
+		double pivot = matrix.diag[i];
+		double upper = i + 1 < size ? matrix.upper[i] : 0;
+		if (i >= 2 && secondBands)
+		{
+			double multiplier = matrix.lower2[i] * bs_inversePivot[i - 2];
+			lower -= multiplier * bs_upper1[i - 2];
+			pivot -= multiplier * bs_upper2[i - 2];
+			bs_lower2[i] = multiplier;
+		}
+		if (i >= 1)
+		{
+			double multiplier = lower * bs_inversePivot[i - 1];
+			pivot -= multiplier * bs_upper1[i - 1];
+			upper -= multiplier * bs_upper2[i - 1];
+			bs_lower1[i] = multiplier;
+		}
+		if (pivot == 0)
+		{
+			throw std::invalid_argument("Zero pivot in the pentadiagonal factorization");
+		}
+		bs_inversePivot[i] = 1.0 / pivot;
+		bs_upper1[i] = upper;
+		bs_upper2[i] = i + 2 < size && secondBands ? matrix.upper2[i] : 0;
+	}
+}
+
+void BandedSolver::solvePentadiagonal(std::span<double> x) const
+{
+	int size = bs_size;
+	const double *l1 = bs_lower1.data();
+	const double *l2 = bs_lower2.data();
+	const double *m = bs_inversePivot.data();
+	const double *u1 = bs_upper1.data();
+	const double *u2 = bs_upper2.data();
+
+	//! Forward substitution with L (unit diagonal)
+	if (size > 1)
+	{
+		x[1] -= l1[1] * x[0];
+	}
+	for (int i = 2; i < size; i++)
+	{
+		x[i] -= l1[i] * x[i - 1] + l2[i] * x[i - 2];
+	}
+
+	//! Back substitution with U
+	x[size - 1] *= m[size - 1];
+	if (size > 1)
+	{
+		x[size - 2] = (x[size - 2] - u1[size - 2] * x[size - 1]) * m[size - 2];
+	}
+	for (int i = size - 3; i >= 0; i--)
+	{
+		x[i] = (x[i] - u1[i] * x[i + 1] - u2[i] * x[i + 2]) * m[i];
+	}
+}
+
+void BandedSolver::factorizeMultigrid(const BandedMatrix &matrix)
+{
+	int levels = 1;
+	for (int size = matrix.size(); size > MULTIGRID_COARSEST; size = (size + 1) / 2)
+	{
+		levels++;
+	}
+	bs_levels.resize(levels);
+
+	//! Finest grid: five bands, without the unused coefficients of a non-cyclic matrix
+	BandedMatrix &finest = bs_levels[0].matrix;
+	int size = matrix.size();
+	finest.cyclic = matrix.cyclic;
+	for (int offset = -2; offset <= 2; offset++)
+	{
+		const std::vector<double> &band = matrix.band(offset);
+		std::vector<double> &copy = finest.band(offset);
+		if (band.empty())
+		{
+			copy.assign(size, 0.0);
+			continue;
+		}
+		copy.assign(band.begin(), band.end());
+		for (int i = 0; i < size && !matrix.cyclic; i++)
+		{
+			if (i + offset < 0 || i + offset >= size)
+			{
+				copy[i] = 0;
+			}
+		}
+	}
+
+	for (int l = 0; l < levels; l++)
+	{
+		MultigridLevel &level = bs_levels[l];
+		if (l > 0)
+		{
+			galerkinCoarse(bs_levels[l - 1].matrix, level.matrix);
+		}
+		int levelSize = level.matrix.size();
+		level.inverseDiag.resize(levelSize);
+		level.scaled.cyclic = level.matrix.cyclic;
+		for (int i = 0; i < levelSize; i++)
+		{
+			level.inverseDiag[i] = 1.0 / level.matrix.diag[i];
+		}
+		for (int offset = -2; offset <= 2; offset++)
+		{
+			const std::vector<double> &band = level.matrix.band(offset);
+			std::vector<double> &scaled = level.scaled.band(offset);
+			scaled.resize(levelSize);
+			for (int i = 0; i < levelSize; i++)
+			{
+				scaled[i] = band[i] * level.inverseDiag[i];
+			}
+		}
+		level.solution.resize(levelSize);
+		level.rhs.resize(levelSize);
+		level.residual.resize(levelSize);
+	}
+
+	//! Dense LU with partial pivoting of the coarsest grid
+	const BandedMatrix &coarsest = bs_levels.back().matrix;
+	int n = coarsest.size();
+	bs_coarseLU.assign(static_cast<std::size_t>(n) * n, 0.0);
+	bs_coarsePivot.resize(n);
+	for (int i = 0; i < n; i++)
+	{
+		for (int offset = -2; offset <= 2; offset++)
+		{
+			int j = i + offset;
+			if (j < 0 || j >= n)
+			{
+				if (!coarsest.cyclic)
+				{
+					continue;
+				}
+				j = (j + n) % n;
+			}
+			bs_coarseLU[i * n + j] += coarsest.band(offset)[i];
+		}
+	}
+	double *a = bs_coarseLU.data();
+	for (int k = 0; k < n; k++)
+	{
+		int pivot = k;
+		for (int i = k + 1; i < n; i++)
+		{
+			pivot = std::abs(a[i * n + k]) > std::abs(a[pivot * n + k]) ? i : pivot;
+		}
+		if (a[pivot * n + k] == 0)
+		{
+			throw std::invalid_argument("The coarsest multigrid matrix is singular");
+		}
+		bs_coarsePivot[k] = pivot;
+		if (pivot != k)
+		{
+			std::swap_ranges(a + k * n, a + (k + 1) * n, a + pivot * n);
+		}
+		for (int i = k + 1; i < n; i++)
+		{
+			double multiplier = a[i * n + k] / a[k * n + k];
+			a[i * n + k] = multiplier;
+			for (int j = k + 1; j < n; j++)
+			{
+				a[i * n + j] -= multiplier * a[k * n + j];
+			}
+		}
+	}
+}
+
+void BandedSolver::solveCoarsest(double *x) const
+{
+	int n = bs_coarsePivot.size();
+	const double *a = bs_coarseLU.data();
+	for (int k = 0; k < n; k++)
+	{
+		std::swap(x[k], x[bs_coarsePivot[k]]);
+		for (int i = k + 1; i < n; i++)
+		{
+			x[i] -= a[i * n + k] * x[k];
+		}
+	}
+	for (int i = n - 1; i >= 0; i--)
+	{
+		for (int j = i + 1; j < n; j++)
+		{
+			x[i] -= a[i * n + j] * x[j];
+		}
+		x[i] /= a[i * n + i];
+	}
+}
+
+void BandedSolver::vCycle(int l, double *x)
+{
+	MultigridLevel &level = bs_levels[l];
+	const double *b = level.rhs.data();
+	int size = level.matrix.size();
+	if (l == static_cast<int>(bs_levels.size()) - 1)
+	{
+		std::copy(b, b + size, x);
+		solveCoarsest(x);
+		return;
+	}
+
+	for (int sweep = 0; sweep < MULTIGRID_SMOOTHING; sweep++)
+	{
+		gaussSeidel(level.scaled, level.inverseDiag, x, b, true);
+	}
+
+	//! Residual, restricted by P^T to the right-hand side of the coarse correction
+	double *r = level.residual.data();
+	level.matrix.multiply(std::span<const double>(x, size), level.residual);
+	MultigridLevel &coarse = bs_levels[l + 1];
+	int coarseSize = coarse.matrix.size();
+	double *coarseRhs = coarse.rhs.data();
+	std::fill(coarse.rhs.begin(), coarse.rhs.end(), 0.0);
+	for (int i = 0; i < size; i++)
+	{
+		double residual = b[i] - r[i];
+		if (i % 2 == 0)
+		{
+			coarseRhs[i / 2] += residual;
+			continue;
+		}
+		coarseRhs[(i - 1) / 2] += 0.5 * residual;
+		int right = rightCoarse(i, coarseSize, level.matrix.cyclic);
+		if (right >= 0)
+		{
+			coarseRhs[right] += 0.5 * residual;
+		}
+	}
+
+	std::fill(coarse.solution.begin(), coarse.solution.end(), 0.0);
+	vCycle(l + 1, coarse.solution.data());
+
+	//! Interpolated correction
+	const double *e = coarse.solution.data();
+	for (int i = 0; i < size; i++)
+	{
+		if (i % 2 == 0)
+		{
+			x[i] += e[i / 2];
+			continue;
+		}
+		int right = rightCoarse(i, coarseSize, level.matrix.cyclic);
+		x[i] += 0.5 * (e[(i - 1) / 2] + (right >= 0 ? e[right] : 0.0));
+	}
+
+	for (int sweep = 0; sweep < MULTIGRID_SMOOTHING; sweep++)
+	{
+		gaussSeidel(level.scaled, level.inverseDiag, x, b, false);
+	}
+}
+
+void BandedSolver::solveMultigrid(std::span<double> x)
+{
+	HEAT_PROFILE_SCOPE("banded.multigrid_solve");
+	FlushSubnormals flush;
+	MultigridLevel &finest = bs_levels[0];
+	finest.rhs.assign(x.begin(), x.end());
+	double rhsNorm = 0;
+	for (double value : finest.rhs)
+	{
+		rhsNorm = std::max(rhsNorm, std::abs(value));
+	}
+
+	//! x holds the right-hand side, which is the initial guess
+	int cycles = 0;
+	for (;; cycles++)
+	{
+		finest.matrix.multiply(x, finest.residual);
+		double residualNorm = 0;
+		for (int i = 0; i < bs_size; i++)
+		{
+			residualNorm = std::max(residualNorm, std::abs(finest.rhs[i] - finest.residual[i]));
+		}
+		if (residualNorm <= bs_tolerance * rhsNorm)
+		{
+			break;
+		}
+		if (cycles == bs_maxCycles || !std::isfinite(residualNorm))
+		{
+			throw std::runtime_error("The multigrid V-cycles did not converge in " + std::to_string(cycles) + " cycles (relative residual " +
+									 std::to_string(residualNorm / rhsNorm) + ")");
+		}
+		vCycle(0, x.data());
+	}
+	bs_cycles = cycles;
+	HEAT_PROFILE_COUNT("banded.multigrid_cycles", cycles);
+}
+
+void BandedSolver::solve(std::span<double> x)
+{
+	if (bs_size == 0)
+	{
+		throw std::logic_error("factorize must be called before solve");
+	}
+	if (static_cast<int>(x.size()) != bs_size)
+	{
+		throw std::invalid_argument("Right-hand side must have the size of the factorized matrix");
+	}
+
+	switch (bs_backend)
+	{
+	case CyclicThomas:
+	{
+		bs_thomas.solve(x);
+		//! x = y - z (v.y) / (1 + v.z)
+		double projection = (x[0] + bs_cyclicLast * x[bs_size - 1]) * bs_cyclicScale;
+		const double *z = bs_cyclicZ.data();
+		for (int i = 0; i < bs_size; i++)
+		{
+			x[i] -= projection * z[i];
+		}
+		break;
+	}
+	case Pentadiagonal:
+		solvePentadiagonal(x);
+		break;
+	case Multigrid:
+		solveMultigrid(x);
+		break;
+	default:
+		bs_thomas.solve(x);
+		break;
+	}
+}
+
+// Get functions
+int BandedSolver::size() const
+{
+	return bs_size;
+}
+
+BandedSolver::Backend BandedSolver::getBackend() const
+{
+	return bs_backend;
+}
+
+int BandedSolver::getCycles() const
+{
+	return bs_cycles;
+}
+
+int BandedSolver::getLevels() const
+{
+	return bs_backend == Multigrid ? bs_levels.size() : 0;
+}
@@ -0,0 +1,177 @@
+#pragma once
+#ifndef BANDEDSOLVER_H
+#define BANDEDSOLVER_H
+
+#include <vector>
+#include <span>
+
+#include "TridiagonalSolver.h"
+
+/**
+ * @struct BandedMatrix
+ * @brief Matrix whose row i couples x_i with at most two neighbours on each side, optionally with a periodic wrap
+ *
+ * Row i is lower2[i] x_{i-2} + lower[i] x_{i-1} + diag[i] x_i + upper[i] x_{i+1} + upper2[i] x_{i+2}. lower2 and
+ * upper2 are empty for a tridiagonal matrix. When cyclic is set the indices wrap around (lower[0] multiplies x_{N-1},
+ * upper2[N-1] multiplies x_1, ...), as for a periodic rod; otherwise the coefficients of the missing neighbours of the
+ * first and last rows are not used.
+ */
+
+struct BandedMatrix
+{
+	std::vector<double> lower2;
+	std::vector<double> lower;
+	std::vector<double> diag;
+	std::vector<double> upper;
+	std::vector<double> upper2;
+	bool cyclic = false;
+
+	//! Number of rows
+	int size() const;
+	//! Coefficients of the neighbours at offset -2 .. 2 (0 is the diagonal); empty for the second bands of a tridiagonal matrix
+	std::vector<double> &band(int offset);
+	const std::vector<double> &band(int offset) const;
+	//! True when a second band has a used non-zero coefficient
+	bool pentadiagonal() const;
+	//! True when the matrix is cyclic with a non-zero coefficient across the wrap
+	bool wraps() const;
+
+	/**
+	 * @brief Matrix-vector product y = A x, one stencil sweep over the bands (x and y must not overlap).
+	 */
+	void multiply(std::span<const double> x, std::span<double> y) const;
+};
+
+/**
+ * @class BandedSolver
+ * @brief This class solves the linear systems of BandedMatrix with the direct or iterative backend fitted to their structure
+ *
+ * - Thomas: tridiagonal matrix, TridiagonalSolver.
+ * - CyclicThomas: tridiagonal matrix with periodic corners. The corners are a rank-one update u v^T of a tridiagonal
+ *   matrix B (Sherman-Morrison); z = B^-1 u is computed by factorize(), so a solve is one Thomas solve of B and an axpy.
+ * - Pentadiagonal: LU factorization without pivoting of a five-band matrix (no fill-in outside the bands).
+ * - Multigrid: geometric V-cycles for any BandedMatrix, cyclic five-band matrices included. The coarse grids keep the
+ *   even points; prolongation is linear interpolation and the coarse matrices are the Galerkin products P^T A P, which
+ *   stay five-band. The smoother (Gauss-Seidel, forward before the coarse correction and backward after) and the
+ *   residuals apply the bands as a stencil, without a sparse matrix; the coarsest grid is solved by a dense LU. The
+ *   initial guess is the right-hand side, which for the (I - c L) matrices of the implicit schemes is close to the
+ *   solution; V-cycles stop once |b - A x| <= tolerance |b| (infinity norms).
+ *
+ * Automatic selects Thomas, CyclicThomas, Pentadiagonal or Multigrid for tridiagonal, cyclic tridiagonal, five-band
+ * and cyclic five-band matrices. The direct backends do not pivot: they are meant for the diagonally dominant or
+ * symmetric positive definite matrices of the implicit schemes, as is Gauss-Seidel.
+ */
+
+class BandedSolver
+{
+public:
+	//! Solution methods
+	enum Backend
+	{
+		Automatic,
+		Thomas,
+		CyclicThomas,
+		Pentadiagonal,
+		Multigrid
+	};
+
+private:
+	//! One grid of the multigrid hierarchy: five-band operator, its rows divided by the diagonal for the smoother,
+	//! inverse diagonal, and the vectors of a V-cycle
+	struct MultigridLevel
+	{
+		BandedMatrix matrix;
+		BandedMatrix scaled;
+		std::vector<double> inverseDiag;
+		std::vector<double> solution;
+		std::vector<double> rhs;
+		std::vector<double> residual;
+	};
+
+	//! Backend given to setBackend, and the one selected by the last factorize
+	Backend bs_requested = Automatic;
+	Backend bs_backend = Automatic;
+	//! Number of rows of the factorized matrix
+	int bs_size = 0;
+
+	//! Thomas, and the matrix B of CyclicThomas
+	TridiagonalSolver bs_thomas;
+	//! CyclicThomas: z = B^-1 u, the last coefficient of v (first is 1) and 1 / (1 + v.z)
+	std::vector<double> bs_cyclicZ;
+	double bs_cyclicLast = 0;
+	double bs_cyclicScale = 0;
+
+	//! Pentadiagonal: multipliers of the rows i - 1 and i - 2, inverse pivots and the two upper bands of U
+	std::vector<double> bs_lower1;
+	std::vector<double> bs_lower2;
+	std::vector<double> bs_inversePivot;
+	std::vector<double> bs_upper1;
+	std::vector<double> bs_upper2;
+
+	//! Multigrid: grids from the finest, dense LU of the coarsest (row-major, with its row permutation)
+	std::vector<MultigridLevel> bs_levels;
+	std::vector<double> bs_coarseLU;
+	std::vector<int> bs_coarsePivot;
+	//! Multigrid stopping test and the number of V-cycles of the last solve
+	double bs_tolerance = 1e-12;
+	int bs_maxCycles = 50;
+	int bs_cycles = 0;
+
+	void factorizeCyclic(const BandedMatrix &matrix);
+	void factorizePentadiagonal(const BandedMatrix &matrix);
+	void factorizeMultigrid(const BandedMatrix &matrix);
+	void solvePentadiagonal(std::span<double> x) const;
+	void solveMultigrid(std::span<double> x);
+
+	/**
+	 * @brief One V-cycle on level l: improves x (level size) for the right-hand side of the level.
+	 */
+	void vCycle(int l, double *x);
+
+	//! Dense LU solve of the coarsest grid, in place
+	void solveCoarsest(double *x) const;
+
+public:
+	/**
+	 * @brief Backend Automatic would choose for a matrix.
+	 */
+	static Backend selectBackend(const BandedMatrix &matrix);
+
+	//! Name of a backend, for reports
+	static const char *backendName(Backend backend);
+
+	/**
+	 * @brief Forces a backend for the next factorize; Automatic (default) selects it from the structure of the matrix.
+	 */
+	void setBackend(Backend backend);
+
+	/**
+	 * @brief Stopping test of the multigrid backend.
+	 * @param tolerance Largest |b - A x| / |b| (infinity norms) of a returned solution
+	 * @param maxCycles V-cycles after which solve throws std::runtime_error
+	 */
+	void setMultigridTolerance(double tolerance, int maxCycles = 50);
+
+	/**
+	 * @brief Factorizes the matrix with the backend selected for it (for Multigrid: builds the grids and the Galerkin
+	 * coarse matrices, and factorizes the coarsest). The storage is reused when the size does not change.
+	 * Throws std::invalid_argument when the forced backend cannot solve a matrix of this structure.
+	 */
+	void factorize(const BandedMatrix &matrix);
+
+	/**
+	 * @brief Solves the system in place: x holds the right-hand side on entry and the solution on exit.
+	 * @param x Right-hand side / solution, of the factorized size
+	 */
+	void solve(std::span<double> x);
+
+	//! Get Methods
+	int size() const;
+	//! Backend of the factorized matrix
+	Backend getBackend() const;
+	//! V-cycles of the last multigrid solve
+	int getCycles() const;
+	//! Number of multigrid grids, finest included (0 for the direct backends)
+	int getLevels() const;
+};
+#endif // BANDEDSOLVER_H
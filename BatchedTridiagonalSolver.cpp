@@ -0,0 +1,222 @@
+#include "BatchedTridiagonalSolver.h"
+#include <stdexcept>
+#include <cstddef>
+
+#include "Instrumentation.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BATCHED_THOMAS_X86 1
+#endif
+
+namespace
+{
+	//! Signature of a batched sweep kernel: count interleaved systems of the given size, row stride 'stride'
+	typedef void (*BatchedKernel)(double *x, int size, int stride, int count, const double *lower, const double *upperStar, const double *inversePivot);
+
+	//! Scalar sweeps for the systems [first, count)
+	void sweepScalar(double *x, int size, int stride, int first, int count, const double *lower, const double *upperStar, const double *inversePivot)
+	{
+		//! Forward sweep
+		for (int k = first; k < count; k++)
+		{
+			x[k] = x[k] * inversePivot[0];
+		}
+		for (int i = 1; i < size; i++)
+		{
+			double *row = x + static_cast<std::ptrdiff_t>(i) * stride;
+			const double *previous = row - stride;
+			for (int k = first; k < count; k++)
+			{
+				row[k] = (row[k] - lower[i] * previous[k]) * inversePivot[i];
+			}
+		}
+
+		//! Back substitution
+		for (int i = size - 2; i >= 0; i--)
+		{
+			double *row = x + static_cast<std::ptrdiff_t>(i) * stride;
+			const double *next = row + stride;
+			for (int k = first; k < count; k++)
+			{
+				row[k] = row[k] - upperStar[i] * next[k];
+			}
+		}
+	}
+
+	void solveScalar(double *x, int size, int stride, int count, const double *lower, const double *upperStar, const double *inversePivot)
+	{
+		sweepScalar(x, size, stride, 0, count, lower, upperStar, inversePivot);
+	}
+
+#ifdef BATCHED_THOMAS_X86
+	//! AVX2 sweeps, 4 systems per register; multiply and subtract are kept separate (no FMA) to match the scalar path
+	__attribute__((target("avx2"))) void solveAvx2(double *x, int size, int stride, int count, const double *lower, const double *upperStar, const double *inversePivot)
+	{
+		int vectorCount = count - count % 4;
+
+		//! Forward sweep
+		__m256d pivot = _mm256_set1_pd(inversePivot[0]);
+		for (int k = 0; k < vectorCount; k += 4)
+		{
+			_mm256_storeu_pd(x + k, _mm256_mul_pd(_mm256_loadu_pd(x + k), pivot));
+		}
+		for (int i = 1; i < size; i++)
+		{
+			double *row = x + static_cast<std::ptrdiff_t>(i) * stride;
+			const double *previous = row - stride;
+			__m256d l = _mm256_set1_pd(lower[i]);
+			__m256d m = _mm256_set1_pd(inversePivot[i]);
+			for (int k = 0; k < vectorCount; k += 4)
+			{
+				__m256d value = _mm256_sub_pd(_mm256_loadu_pd(row + k), _mm256_mul_pd(l, _mm256_loadu_pd(previous + k)));
+				_mm256_storeu_pd(row + k, _mm256_mul_pd(value, m));
+			}
+		}
+
+		//! Back substitution
+		for (int i = size - 2; i >= 0; i--)
+		{
+			double *row = x + static_cast<std::ptrdiff_t>(i) * stride;
+			const double *next = row + stride;
+			__m256d c = _mm256_set1_pd(upperStar[i]);
+			for (int k = 0; k < vectorCount; k += 4)
+			{
+				_mm256_storeu_pd(row + k, _mm256_sub_pd(_mm256_loadu_pd(row + k), _mm256_mul_pd(c, _mm256_loadu_pd(next + k))));
+			}
+		}
+
+		//! Remaining systems
+		sweepScalar(x, size, stride, vectorCount, count, lower, upperStar, inversePivot);
+	}
+
+	//! AVX-512 sweeps, 8 systems per register
+	__attribute__((target("avx512f"))) void solveAvx512(double *x, int size, int stride, int count, const double *lower, const double *upperStar, const double *inversePivot)
+	{
+		int vectorCount = count - count % 8;
+
+		//! Forward sweep
+		__m512d pivot = _mm512_set1_pd(inversePivot[0]);
+		for (int k = 0; k < vectorCount; k += 8)
+		{
+			_mm512_storeu_pd(x + k, _mm512_mul_pd(_mm512_loadu_pd(x + k), pivot));
+		}
+		for (int i = 1; i < size; i++)
+		{
+			double *row = x + static_cast<std::ptrdiff_t>(i) * stride;
+			const double *previous = row - stride;
+			__m512d l = _mm512_set1_pd(lower[i]);
+			__m512d m = _mm512_set1_pd(inversePivot[i]);
+			for (int k = 0; k < vectorCount; k += 8)
+			{
+				__m512d value = _mm512_sub_pd(_mm512_loadu_pd(row + k), _mm512_mul_pd(l, _mm512_loadu_pd(previous + k)));
+				_mm512_storeu_pd(row + k, _mm512_mul_pd(value, m));
+			}
+		}
+
+		//! Back substitution
+		for (int i = size - 2; i >= 0; i--)
+		{
+			double *row = x + static_cast<std::ptrdiff_t>(i) * stride;
+			const double *next = row + stride;
+			__m512d c = _mm512_set1_pd(upperStar[i]);
+			for (int k = 0; k < vectorCount; k += 8)
+			{
+				_mm512_storeu_pd(row + k, _mm512_sub_pd(_mm512_loadu_pd(row + k), _mm512_mul_pd(c, _mm512_loadu_pd(next + k))));
+			}
+		}
+
+		//! Remaining systems
+		sweepScalar(x, size, stride, vectorCount, count, lower, upperStar, inversePivot);
+	}
+#endif
+
+	//! Picks the widest kernel supported by the CPU, once
+	BatchedKernel selectKernel(const char **name)
+	{
+#ifdef BATCHED_THOMAS_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			*name = "avx512";
+			return solveAvx512;
+		}
+		if (__builtin_cpu_supports("avx2"))
+		{
+			*name = "avx2";
+			return solveAvx2;
+		}
+#endif
+		*name = "scalar";
+		return solveScalar;
+	}
+
+	const char *g_kernelName = "scalar";
+
+	//! Kernel selected on first use, safe to call during static initialization of other files
+	BatchedKernel kernel()
+	{
+		static const BatchedKernel selected = selectKernel(&g_kernelName);
+		return selected;
+	}
+}
+
+// Constructors
+BatchedTridiagonalSolver::BatchedTridiagonalSolver()
+{
+}
+
+BatchedTridiagonalSolver::BatchedTridiagonalSolver(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag)
+	: bts_factorization(lower_diag, diag, upper_diag)
+{
+}
+
+void BatchedTridiagonalSolver::factorize(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag)
+{
+	bts_factorization.factorize(lower_diag, diag, upper_diag);
+}
+
+void BatchedTridiagonalSolver::solve(std::span<double> x, int batchSize) const
+{
+	int size = bts_factorization.size();
+
+	if (batchSize <= 0 || x.size() != static_cast<std::size_t>(size) * batchSize)
+	{
+		throw std::invalid_argument("Interleaved right-hand sides must have size() * batchSize entries");
+	}
+
+	HEAT_PROFILE_SCOPE("batched_thomas.solve");
+	HEAT_PROFILE_COUNT("batched_thomas.systems", batchSize);
+	kernel()(x.data(), size, batchSize, batchSize,
+			 bts_factorization.getLower().data(), bts_factorization.getUpperStar().data(), bts_factorization.getInversePivot().data());
+}
+
+void BatchedTridiagonalSolver::solve(double *x, int stride, int count) const
+{
+	if (count <= 0 || stride < count)
+	{
+		throw std::invalid_argument("A strided batch needs at least one system and a stride of at least count");
+	}
+
+	HEAT_PROFILE_SCOPE("batched_thomas.solve");
+	HEAT_PROFILE_COUNT("batched_thomas.systems", count);
+	kernel()(x, bts_factorization.size(), stride, count,
+			 bts_factorization.getLower().data(), bts_factorization.getUpperStar().data(), bts_factorization.getInversePivot().data());
+}
+
+// Get functions
+int BatchedTridiagonalSolver::size() const
+{
+	return bts_factorization.size();
+}
+
+const TridiagonalSolver &BatchedTridiagonalSolver::getFactorization() const
+{
+	return bts_factorization;
+}
+
+const char *BatchedTridiagonalSolver::instructionSet()
+{
+	kernel();
+	return g_kernelName;
+}
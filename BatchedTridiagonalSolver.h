@@ -0,0 +1,64 @@
+#pragma once
+#ifndef BATCHEDTRIDIAGONALSOLVER_H
+#define BATCHEDTRIDIAGONALSOLVER_H
+
+#include <vector>
+#include <span>
+
+#include "TridiagonalSolver.h"
+
+/**
+ * @class BatchedTridiagonalSolver
+ * @brief This class solves K right-hand sides that share one tridiagonal matrix in a single pair of sweeps
+ *
+ * The right-hand sides are stored interleaved (structure of arrays): entry i of system k is x[i * K + k].
+ * The recurrence of the Thomas algorithm runs along i, so the K systems are independent at each row and the
+ * sweeps are vectorized across systems (AVX-512, AVX2 or scalar, chosen at runtime from the CPU features).
+ * Each system gives exactly the same result as TridiagonalSolver::solve.
+ */
+
+class BatchedTridiagonalSolver
+{
+private:
+	//! Attribute for the shared factorization of the matrix
+	TridiagonalSolver bts_factorization;
+
+public:
+	BatchedTridiagonalSolver();
+
+	/**
+	 * @brief Builds the solver and factorizes the shared matrix.
+	 * @param lower_diag Lower diagonal of the tridiagonal matrix
+	 * @param diag Diagonal of the tridiagonal matrix
+	 * @param upper_diag Upper diagonal of the tridiagonal matrix
+	 */
+	BatchedTridiagonalSolver(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag);
+
+	/**
+	 * @brief Factorizes the shared matrix, see TridiagonalSolver::factorize.
+	 */
+	void factorize(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag);
+
+	/**
+	 * @brief Solves batchSize interleaved systems in place.
+	 * @param x Interleaved right-hand sides / solutions, of size size() * batchSize
+	 * @param batchSize Number of systems K
+	 */
+	void solve(std::span<double> x, int batchSize) const;
+
+	/**
+	 * @brief Solves count interleaved systems of a larger batch in place, e.g. the members of one thread.
+	 * @param x First value of the first system: row i of system k is x[i * stride + k]
+	 * @param stride Distance between two rows (the size of the whole batch), at least count
+	 * @param count Number of systems
+	 */
+	void solve(double *x, int stride, int count) const;
+
+	//! Get Methods
+	int size() const;
+	const TridiagonalSolver &getFactorization() const;
+
+	//! Name of the instruction set selected at runtime ("avx512", "avx2" or "scalar")
+	static const char *instructionSet();
+};
+#endif // BATCHEDTRIDIAGONALSOLVER_H
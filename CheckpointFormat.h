@@ -0,0 +1,71 @@
+#pragma once
+#ifndef CHECKPOINTFORMAT_H
+#define CHECKPOINTFORMAT_H
+
+#include <cstdint>
+
+#include "SnapshotFormat.h"
+
+/**
+ * @file CheckpointFormat.h
+ * @brief Layout of the checkpoint files written by CheckpointWriter and read by CheckpointReader
+ *
+ * A file is one 128-byte CheckpointHeader followed by the time level 'step' and, for the three-level schemes
+ * (levels = 2), the level step-1: numberOfPoint float64 values each, little-endian like the snapshot files. The size
+ * of the file is exactly given by the header. The scheme and the precision are the values of HeatSolver::Scheme and
+ * Precision.
+ */
+
+//! First 8 bytes of every checkpoint file
+constexpr char CHECKPOINT_MAGIC[8] = {'H', 'E', 'A', 'T', 'C', 'K', 'P', 'T'};
+//! Format version written in the header
+constexpr std::uint32_t CHECKPOINT_VERSION = 1;
+
+struct CheckpointHeader
+{
+	//! CHECKPOINT_MAGIC
+	char magic[8];
+	//! CHECKPOINT_VERSION
+	std::uint32_t version;
+	//! Scheme of the run (HeatSolver::Scheme)
+	std::uint32_t scheme;
+	//! Time level of the first stored level, counted from the initial distribution
+	std::int64_t step;
+	//! Number of values per level
+	std::uint64_t numberOfPoint;
+	//! Number of stored levels: 2 for Richardson and Dufort-Frankel, 1 for the implicit schemes
+	std::uint32_t levels;
+	//! Precision of the run (Precision)
+	std::uint32_t precision;
+	//! Grid step, time step and physical parameters of the run
+	double deltax;
+	double deltat;
+	double D;
+	double tsurf;
+	//! Reserved, zero
+	char padding[56];
+};
+static_assert(sizeof(CheckpointHeader) == 128, "CheckpointHeader must stay 128 bytes");
+
+//! Size in bytes of a checkpoint file
+inline std::uint64_t checkpointFileBytes(const CheckpointHeader &header)
+{
+	return sizeof(CheckpointHeader) + header.levels * header.numberOfPoint * sizeof(double);
+}
+
+//! Converts every number of a header between host and little-endian order (no-op on little-endian hosts)
+inline CheckpointHeader checkpointLittleEndian(CheckpointHeader header)
+{
+	header.version = snapshotLittleEndian(header.version);
+	header.scheme = snapshotLittleEndian(header.scheme);
+	header.step = snapshotLittleEndian(header.step);
+	header.numberOfPoint = snapshotLittleEndian(header.numberOfPoint);
+	header.levels = snapshotLittleEndian(header.levels);
+	header.precision = snapshotLittleEndian(header.precision);
+	for (double *value : {&header.deltax, &header.deltat, &header.D, &header.tsurf})
+	{
+		*value = snapshotLittleEndian(*value);
+	}
+	return header;
+}
+#endif // CHECKPOINTFORMAT_H
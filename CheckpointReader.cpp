@@ -0,0 +1,114 @@
+#include "CheckpointReader.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Instrumentation.h"
+
+CheckpointReader::CheckpointReader(const std::string &fileName) : crd_fileName(fileName)
+{
+	HEAT_PROFILE_SCOPE("checkpoint.open");
+	int descriptor = open(crd_fileName.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		throw std::runtime_error("Cannot open checkpoint file '" + crd_fileName + "'");
+	}
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(CheckpointHeader)))
+	{
+		::close(descriptor);
+		throw std::runtime_error("'" + crd_fileName + "' is too short to be a checkpoint file");
+	}
+
+	void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+	::close(descriptor);
+	if (mapping == MAP_FAILED)
+	{
+		throw std::runtime_error("Cannot map checkpoint file '" + crd_fileName + "'");
+	}
+	crd_data = static_cast<const char *>(mapping);
+	crd_length = status.st_size;
+
+	std::memcpy(&crd_header, crd_data, sizeof(CheckpointHeader));
+	crd_header = checkpointLittleEndian(crd_header);
+	if (std::memcmp(crd_header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 || crd_header.version != CHECKPOINT_VERSION ||
+		(crd_header.levels != 1 && crd_header.levels != 2) || crd_header.numberOfPoint == 0 || crd_header.step < 0 || checkpointFileBytes(crd_header) != crd_length)
+	{
+		munmap(const_cast<char *>(crd_data), crd_length);
+		throw std::runtime_error("'" + crd_fileName + "' is not a complete checkpoint file of version " + std::to_string(CHECKPOINT_VERSION));
+	}
+}
+
+CheckpointReader::~CheckpointReader()
+{
+	munmap(const_cast<char *>(crd_data), crd_length);
+}
+
+const char *CheckpointReader::levelData(int level) const
+{
+	return crd_data + sizeof(CheckpointHeader) + level * crd_header.numberOfPoint * sizeof(double);
+}
+
+std::span<const double> CheckpointReader::current() const
+{
+	if (std::endian::native != std::endian::little)
+	{
+		throw std::logic_error("Checkpoint levels can only be viewed in place on little-endian hosts, use load()");
+	}
+	//! The 128-byte header keeps the values aligned in the page-aligned mapping
+	return std::span<const double>(reinterpret_cast<const double *>(levelData(0)), crd_header.numberOfPoint);
+}
+
+std::span<const double> CheckpointReader::previous() const
+{
+	if (crd_header.levels < 2)
+	{
+		return {};
+	}
+	if (std::endian::native != std::endian::little)
+	{
+		throw std::logic_error("Checkpoint levels can only be viewed in place on little-endian hosts, use load()");
+	}
+	return std::span<const double>(reinterpret_cast<const double *>(levelData(1)), crd_header.numberOfPoint);
+}
+
+void CheckpointReader::load(SolverState &state) const
+{
+	auto read = [&](int level, std::vector<double> &values)
+	{
+		values.resize(crd_header.numberOfPoint);
+		std::memcpy(values.data(), levelData(level), values.size() * sizeof(double));
+		if constexpr (std::endian::native != std::endian::little)
+		{
+			for (double &value : values)
+			{
+				value = snapshotLittleEndian(value);
+			}
+		}
+	};
+	state.step = crd_header.step;
+	read(0, state.current);
+	if (crd_header.levels == 2)
+	{
+		read(1, state.previous);
+	}
+	else
+	{
+		state.previous.clear();
+	}
+}
+
+// Get functions
+const CheckpointHeader &CheckpointReader::getHeader() const
+{
+	return crd_header;
+}
+
+const std::string &CheckpointReader::getFileName() const
+{
+	return crd_fileName;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef CHECKPOINTREADER_H
+#define CHECKPOINTREADER_H
+
+#include <string>
+#include <span>
+
+#include "CheckpointFormat.h"
+#include "SolverState.h"
+
+/**
+ * @class CheckpointReader
+ * @brief Reads a checkpoint file (CheckpointFormat.h) through a read-only memory mapping
+ *
+ * Opening a checkpoint only maps it and checks its header and its size: the levels are viewed in place with
+ * current() and previous(), or copied into a SolverState with load() to resume a run (HeatSolver::restart).
+ */
+
+class CheckpointReader
+{
+private:
+	//! Header of the file (host byte order)
+	CheckpointHeader crd_header;
+	//! Mapped file and its length
+	const char *crd_data = nullptr;
+	std::size_t crd_length = 0;
+	std::string crd_fileName;
+
+	//! Start of a stored level, 0 for current and 1 for previous
+	const char *levelData(int level) const;
+
+public:
+	/**
+	 * @brief Maps the file and checks it, throws std::runtime_error if it is not a complete checkpoint file.
+	 * @param fileName Checkpoint file
+	 */
+	explicit CheckpointReader(const std::string &fileName);
+	~CheckpointReader();
+
+	CheckpointReader(const CheckpointReader &) = delete;
+	CheckpointReader &operator=(const CheckpointReader &) = delete;
+
+	/**
+	 * @brief Zero-copy view of the level header.step, valid until destruction.
+	 * Throws std::logic_error on big-endian hosts, where load() must be used.
+	 */
+	std::span<const double> current() const;
+
+	//! Same for the level header.step - 1, empty when the file stores one level
+	std::span<const double> previous() const;
+
+	/**
+	 * @brief Copies the stored levels into a state (previous left empty for one level).
+	 * @param state Receives the step and the levels
+	 */
+	void load(SolverState &state) const;
+
+	//! Get Methods
+	const CheckpointHeader &getHeader() const;
+	const std::string &getFileName() const;
+};
+#endif // CHECKPOINTREADER_H
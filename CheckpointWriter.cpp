@@ -0,0 +1,139 @@
+#include "CheckpointWriter.h"
+
+#include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Instrumentation.h"
+
+CheckpointWriter::CheckpointWriter(const std::string &fileName, bool durable) : cw_fileName(fileName), cw_temporaryName(fileName + ".tmp"), cw_durable(durable)
+{
+}
+
+CheckpointHeader CheckpointWriter::makeHeader(int scheme, long step, int numberOfPoint, int levels, int precision, double deltax, double deltat, double D, double tsurf)
+{
+	CheckpointHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	header.version = CHECKPOINT_VERSION;
+	header.scheme = scheme;
+	header.step = step;
+	header.numberOfPoint = numberOfPoint;
+	header.levels = levels;
+	header.precision = precision;
+	header.deltax = deltax;
+	header.deltat = deltat;
+	header.D = D;
+	header.tsurf = tsurf;
+	return header;
+}
+
+void CheckpointWriter::write(const CheckpointHeader &header, std::span<const double> current, std::span<const double> previous)
+{
+	HEAT_PROFILE_SCOPE("checkpoint.write");
+	if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 || (header.levels != 1 && header.levels != 2) || header.numberOfPoint == 0)
+	{
+		throw std::invalid_argument("Invalid checkpoint header, build it with CheckpointWriter::makeHeader");
+	}
+	if (current.size() != header.numberOfPoint || (header.levels == 2 && previous.size() != header.numberOfPoint))
+	{
+		throw std::invalid_argument("The levels of a checkpoint must have numberOfPoint values");
+	}
+
+	std::uint64_t size = checkpointFileBytes(header);
+	int descriptor = open(cw_temporaryName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (descriptor < 0)
+	{
+		throw std::runtime_error("Cannot create checkpoint file '" + cw_temporaryName + "': " + std::strerror(errno));
+	}
+	//! On any error the temporary file goes away and the previous checkpoint stays
+	auto fail = [&](const std::string &what)
+	{
+		std::string message = what + " '" + cw_temporaryName + "': " + std::strerror(errno);
+		::close(descriptor);
+		unlink(cw_temporaryName.c_str());
+		throw std::runtime_error(message);
+	};
+	//! Reserving the blocks up front spares the file system an allocation at each first write to a page
+	int reserved = posix_fallocate(descriptor, 0, size);
+	if (reserved != 0)
+	{
+		errno = reserved;
+		fail("Cannot size checkpoint file");
+	}
+	void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	if (mapping == MAP_FAILED)
+	{
+		fail("Cannot map checkpoint file");
+	}
+
+	//! The levels go from the solver into the page cache with one copy each
+	char *out = static_cast<char *>(mapping);
+	CheckpointHeader stored = checkpointLittleEndian(header);
+	std::memcpy(out, &stored, sizeof(stored));
+	auto copyLevel = [&](std::span<const double> level, char *destination)
+	{
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			std::memcpy(destination, level.data(), level.size_bytes());
+		}
+		else
+		{
+			for (std::size_t i = 0; i < level.size(); i++)
+			{
+				double value = snapshotLittleEndian(level[i]);
+				std::memcpy(destination + i * sizeof(double), &value, sizeof(double));
+			}
+		}
+	};
+	copyLevel(current, out + sizeof(CheckpointHeader));
+	if (header.levels == 2)
+	{
+		copyLevel(previous, out + sizeof(CheckpointHeader) + current.size_bytes());
+	}
+
+	bool flushed = !cw_durable || msync(mapping, size, MS_SYNC) == 0;
+	munmap(mapping, size);
+	if (!flushed || (cw_durable && fsync(descriptor) != 0))
+	{
+		fail("Cannot flush checkpoint file");
+	}
+	::close(descriptor);
+
+	//! rename replaces the previous checkpoint in one step
+	if (std::rename(cw_temporaryName.c_str(), cw_fileName.c_str()) != 0)
+	{
+		std::string message = "Cannot replace checkpoint file '" + cw_fileName + "': " + std::strerror(errno);
+		unlink(cw_temporaryName.c_str());
+		throw std::runtime_error(message);
+	}
+	if (cw_durable)
+	{
+		//! The new directory entry is only durable once the directory itself is flushed
+		std::filesystem::path directory = std::filesystem::path(cw_fileName).parent_path();
+		int directoryDescriptor = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+		if (directoryDescriptor >= 0)
+		{
+			fsync(directoryDescriptor);
+			::close(directoryDescriptor);
+		}
+	}
+	cw_checkpoints++;
+}
+
+// Get functions
+const std::string &CheckpointWriter::getFileName() const
+{
+	return cw_fileName;
+}
+
+long CheckpointWriter::getCheckpoints() const
+{
+	return cw_checkpoints;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef CHECKPOINTWRITER_H
+#define CHECKPOINTWRITER_H
+
+#include <string>
+#include <span>
+
+#include "CheckpointFormat.h"
+
+/**
+ * @class CheckpointWriter
+ * @brief Writes the state of a run to a checkpoint file (CheckpointFormat.h) that is replaced atomically
+ *
+ * Each write() maps a new file next to the checkpoint (fileName + ".tmp"), copies the header and the time levels
+ * straight from the solver into the mapping, with no intermediate buffer, then renames it over the checkpoint. A crash
+ * at any point leaves either the previous checkpoint or the new one, never a mix. With durable set, the data and the
+ * rename are flushed to the disk (msync, fsync of the file and of its directory) before write() returns.
+ */
+
+class CheckpointWriter
+{
+private:
+	//! Checkpoint file and the temporary file of a write in progress
+	std::string cw_fileName;
+	std::string cw_temporaryName;
+	//! Flush every checkpoint to the disk before replacing the previous one
+	bool cw_durable;
+	//! Number of checkpoints written
+	long cw_checkpoints = 0;
+
+public:
+	/**
+	 * @brief Prepares the writer, nothing is written before the first write().
+	 * @param fileName Checkpoint file
+	 * @param durable If true (default), a checkpoint is on the disk when write() returns; if false it may still be
+	 * in the page cache, which survives a crash of the process but not of the machine
+	 */
+	explicit CheckpointWriter(const std::string &fileName, bool durable = true);
+
+	/**
+	 * @brief Builds a header for a run.
+	 * @param scheme Scheme of the run (HeatSolver::Scheme)
+	 * @param step Time level of current
+	 * @param numberOfPoint Number of values per level
+	 * @param levels 2 when the level step-1 is stored as well, else 1
+	 * @param precision Precision of the run (Precision)
+	 */
+	static CheckpointHeader makeHeader(int scheme, long step, int numberOfPoint, int levels, int precision, double deltax, double deltat, double D, double tsurf);
+
+	/**
+	 * @brief Writes a checkpoint and atomically replaces the previous one. Throws std::runtime_error on an I/O error,
+	 * leaving the previous checkpoint in place.
+	 * @param header Run description, see makeHeader
+	 * @param current Level header.step, numberOfPoint values
+	 * @param previous Level header.step - 1 when header.levels is 2, ignored otherwise
+	 */
+	void write(const CheckpointHeader &header, std::span<const double> current, std::span<const double> previous);
+
+	//! Get Methods
+	const std::string &getFileName() const;
+	long getCheckpoints() const;
+};
+#endif // CHECKPOINTWRITER_H
@@ -0,0 +1,31 @@
+#include "CsvExporter.h"
+#include "SnapshotReader.h"
+#include "Instrumentation.h"
+
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+void CsvExporter::write(const std::string &fileName, std::span<const double> values)
+{
+	HEAT_PROFILE_SCOPE("output.csv");
+	std::ofstream file(fileName);
+	file.precision(std::numeric_limits<double>::max_digits10);
+	for (double value : values)
+	{
+		file << value << "\n";
+	}
+	file.close();
+	if (!file)
+	{
+		throw std::runtime_error("Cannot write CSV file '" + fileName + "'");
+	}
+}
+
+void CsvExporter::exportFrame(const SnapshotReader &reader, long frame, const std::string &fileName)
+{
+	std::vector<double> values;
+	reader.read(frame, values);
+	write(fileName, values);
+}
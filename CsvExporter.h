@@ -0,0 +1,35 @@
+#pragma once
+#ifndef CSVEXPORTER_H
+#define CSVEXPORTER_H
+
+#include <string>
+#include <span>
+
+class SnapshotReader;
+
+/**
+ * @class CsvExporter
+ * @brief Writes temperature profiles as CSV text, one value per line
+ *
+ * Values are written with max_digits10 significant digits, so reading the file back gives the exact doubles.
+ */
+
+class CsvExporter
+{
+public:
+	/**
+	 * @brief Writes one profile, throws std::runtime_error if the file cannot be written.
+	 * @param fileName Name of the CSV file
+	 * @param values Values to write
+	 */
+	static void write(const std::string &fileName, std::span<const double> values);
+
+	/**
+	 * @brief Exports one frame of a snapshot file.
+	 * @param reader Opened snapshot file
+	 * @param frame Frame index
+	 * @param fileName Name of the CSV file
+	 */
+	static void exportFrame(const SnapshotReader &reader, long frame, const std::string &fileName);
+};
+#endif // CSVEXPORTER_H
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef DEFAULTINITALLOCATOR_H
+#define DEFAULTINITALLOCATOR_H
+
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @class DefaultInitAllocator
+ * @brief Allocator whose resize() leaves new doubles uninitialized instead of zeroing them
+ *
+ * Large blocks come from fresh pages that are only mapped when first written. With this allocator the first
+ * write is done by the thread that owns the chunk, so on NUMA machines each chunk lands on that thread's node
+ * (first-touch placement).
+ */
+
+template <class T>
+class DefaultInitAllocator : public std::allocator<T>
+{
+public:
+	template <class U>
+	struct rebind
+	{
+		typedef DefaultInitAllocator<U> other;
+	};
+
+	DefaultInitAllocator() noexcept {}
+
+	template <class U>
+	DefaultInitAllocator(const DefaultInitAllocator<U> &) noexcept {}
+
+	//! Value-less construction: default-initialize (no write)
+	template <class U>
+	void construct(U *p) noexcept
+	{
+		::new (static_cast<void *>(p)) U;
+	}
+
+	template <class U, class... Args>
+	void construct(U *p, Args &&...args)
+	{
+		::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+	}
+};
+#endif // DEFAULTINITALLOCATOR_H
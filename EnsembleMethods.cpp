@@ -0,0 +1,340 @@
+#include "EnsembleMethods.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+
+#include "StencilKernels.h"
+#include "SolverState.h"
+#include "Instrumentation.h"
+
+using namespace StencilKernels;
+
+void EnsembleMethods::setThreads(int numberOfThreads)
+{
+	if (numberOfThreads < 1)
+	{
+		throw std::invalid_argument("The number of threads must be at least 1");
+	}
+
+	if (numberOfThreads == 1)
+	{
+		em_pool.reset();
+	}
+	else if (getThreads() != numberOfThreads)
+	{
+		em_pool = std::make_shared<ThreadPool>(numberOfThreads);
+	}
+}
+
+int EnsembleMethods::getThreads() const
+{
+	return em_pool ? em_pool->size() : 1;
+}
+
+void EnsembleMethods::setTileMembers(int tileMembers)
+{
+	if (tileMembers < 0)
+	{
+		throw std::invalid_argument("The number of members per tile must be non-negative");
+	}
+	em_tileMembers = tileMembers;
+}
+
+int EnsembleMethods::getTileMembers(int levels) const
+{
+	long width = em_tileMembers;
+	if (width == 0)
+	{
+		//! Widest multiple of 8 members whose levels fit in TILE_BYTES, but at least one tile per thread
+		long bytesPerMember = static_cast<long>(levels) * em_numberOfPoint * sizeof(double);
+		width = std::max(8L, TILE_BYTES / std::max(1L, bytesPerMember) / 8 * 8);
+		int threads = getThreads();
+		width = std::min(width, std::max(8L, (em_members + threads - 1) / threads + 7L) / 8 * 8);
+	}
+	return static_cast<int>(std::max(1L, std::min(width, static_cast<long>(em_members))));
+}
+
+template <class Body>
+void EnsembleMethods::forEachTile(int levels, const Body &body)
+{
+	int width = getTileMembers(levels);
+	int numberOfTiles = (em_members + width - 1) / width;
+	int numberOfThreads = getThreads();
+	std::size_t tileSize = static_cast<std::size_t>(levels) * em_numberOfPoint * width;
+	em_tile.resize(tileSize * numberOfThreads);
+
+	//! Contiguous tiles per thread, each thread working in its own part of em_tile
+	auto work = [&](int thread)
+	{
+		int firstTile = static_cast<long>(numberOfTiles) * thread / numberOfThreads;
+		int lastTile = static_cast<long>(numberOfTiles) * (thread + 1) / numberOfThreads;
+		for (int tile = firstTile; tile < lastTile; tile++)
+		{
+			int first = tile * width;
+			body(em_tile.data() + tileSize * thread, first, std::min(width, em_members - first));
+		}
+	};
+
+	if (em_pool)
+	{
+		em_pool->run(work);
+	}
+	else
+	{
+		work(0);
+	}
+}
+
+void EnsembleMethods::gather(int first, int count, double *tile) const
+{
+	for (int i = 0; i < em_numberOfPoint; i++)
+	{
+		const double *row = em_temperature.data() + static_cast<std::size_t>(i) * em_members + first;
+		std::copy(row, row + count, tile + static_cast<std::size_t>(i) * count);
+	}
+}
+
+void EnsembleMethods::scatter(int first, int count, const double *tile)
+{
+	for (int i = 0; i < em_numberOfPoint; i++)
+	{
+		const double *row = tile + static_cast<std::size_t>(i) * count;
+		std::copy(row, row + count, em_temperature.data() + static_cast<std::size_t>(i) * em_members + first);
+	}
+}
+
+void EnsembleMethods::load(int numberOfPoint, const std::vector<double> &tsurf, const std::vector<std::vector<double>> &temperatureInits)
+{
+	int members = temperatureInits.size();
+	if (members == 0 || tsurf.size() != static_cast<std::size_t>(members))
+	{
+		throw std::invalid_argument("An ensemble needs one tsurf value per initial profile");
+	}
+	if (numberOfPoint < 3)
+	{
+		throw std::invalid_argument("An ensemble needs at least three points");
+	}
+
+	em_numberOfPoint = numberOfPoint;
+	em_members = members;
+	em_tsurf = tsurf;
+	//! resize reuses the existing capacity, so only the first load of an ensemble size allocates
+	em_temperature.resize(static_cast<std::size_t>(numberOfPoint) * members);
+	for (int k = 0; k < members; k++)
+	{
+		if (temperatureInits[k].size() != static_cast<std::size_t>(numberOfPoint))
+		{
+			throw std::invalid_argument("Every initial profile of an ensemble must have numberOfPoint values");
+		}
+		for (int i = 0; i < numberOfPoint; i++)
+		{
+			em_temperature[static_cast<std::size_t>(i) * members + k] = temperatureInits[k][i];
+		}
+	}
+}
+
+template <class Update>
+void EnsembleMethods::explicitSteps(const Update &update, double beta, int steps)
+{
+	HEAT_PROFILE_SCOPE("ensemble.explicit_steps");
+	HEAT_PROFILE_COUNT("ensemble.member_point_updates", (steps + 1ULL) * em_numberOfPoint * em_members);
+	int numberOfPoint = em_numberOfPoint;
+
+	forEachTile(3, [&](double *tile, int first, int count)
+				{
+		//! Three local levels with rows of count members
+		std::size_t levelSize = static_cast<std::size_t>(numberOfPoint) * count;
+		double *prev = tile;
+		double *curr = prev + levelSize;
+		double *next = curr + levelSize;
+		const double *tsurf = em_tsurf.data() + first;
+		gather(first, count, curr);
+
+		//! FTCS step from the initial profiles, then the scheme; each step rotates the three levels
+		for (int step = 0; step <= steps; step++)
+		{
+			std::copy(tsurf, tsurf + count, next);
+			std::copy(tsurf, tsurf + count, next + levelSize - count);
+			if (step == 0)
+			{
+				applyStencilRows(FtcsStencil(beta), nullptr, curr, next, 1, numberOfPoint - 1, count, count);
+			}
+			else
+			{
+				applyStencilRows(update, prev, curr, next, 1, numberOfPoint - 1, count, count);
+			}
+
+			double *recycled = prev;
+			prev = curr;
+			curr = next;
+			next = recycled;
+		}
+		scatter(first, count, curr); });
+}
+
+void EnsembleMethods::laasonenSteps(double theta, int steps)
+{
+	HEAT_PROFILE_SCOPE("ensemble.laasonen_steps");
+	HEAT_PROFILE_COUNT("ensemble.member_point_updates", static_cast<unsigned long long>(steps) * em_numberOfPoint * em_members);
+	int numberOfPoint = em_numberOfPoint;
+
+	forEachTile(1, [&](double *temperature, int first, int count)
+				{
+		double *lastRow = temperature + static_cast<std::size_t>(numberOfPoint - 1) * count;
+		const double *tsurf = em_tsurf.data() + first;
+		gather(first, count, temperature);
+		for (int step = 0; step < steps; step++)
+		{
+			//! Add boundary conditions of each member, then solve the members of the tile together in place
+			for (int k = 0; k < count; k++)
+			{
+				temperature[k] += theta * tsurf[k];
+				lastRow[k] += theta * tsurf[k];
+			}
+			em_solver.solve(temperature, count, count);
+		}
+		scatter(first, count, temperature); });
+}
+
+void EnsembleMethods::crankNicholsonSteps(double lambda, int steps)
+{
+	HEAT_PROFILE_SCOPE("ensemble.crank_nicholson_steps");
+	HEAT_PROFILE_COUNT("ensemble.member_point_updates", static_cast<unsigned long long>(steps) * em_numberOfPoint * em_members);
+	int numberOfPoint = em_numberOfPoint;
+	CrankNicolsonRhsStencil rhsStencil(lambda);
+	int last = numberOfPoint - 2;
+
+	forEachTile(2, [&](double *temperature, int first, int count)
+				{
+		//! The right-hand sides follow the temperatures in the tile
+		double *calculus_vector = temperature + static_cast<std::size_t>(numberOfPoint) * count;
+		const double *tsurf = em_tsurf.data() + first;
+		gather(first, count, temperature);
+
+		//! Row i of member k is row(i)[k]
+		auto row = [&](int i)
+		{ return temperature + static_cast<std::size_t>(i) * count; };
+
+		for (int step = 0; step < steps; step++)
+		{
+			//! First and last rows carry the boundary temperature; row i is centred on point i + 1
+			for (int k = 0; k < count; k++)
+			{
+				calculus_vector[k] = (1 - 2 * lambda) * row(1)[k] + lambda * row(2)[k] + lambda * (row(0)[k] + tsurf[k]);
+			}
+			applyStencilRows(rhsStencil, nullptr, row(1), calculus_vector, 1, last, count, count);
+			double *lastRhs = calculus_vector + static_cast<std::size_t>(last) * count;
+			for (int k = 0; k < count; k++)
+			{
+				lastRhs[k] = (1 - 2 * lambda) * row(last - 1)[k] + lambda * row(last - 2)[k] + lambda * (row(last)[k] + tsurf[k]);
+			}
+
+			//! Solve the members of the tile together in place; rows 1..N-1 of the temperatures take the solution
+			em_solver.solve(calculus_vector, count, count);
+			std::copy(calculus_vector, calculus_vector + static_cast<std::size_t>(last + 1) * count, row(1));
+		}
+		scatter(first, count, temperature); });
+}
+
+void EnsembleMethods::run(Scheme scheme, double deltax, double D, double deltat, double t)
+{
+	if (em_members == 0)
+	{
+		throw std::logic_error("load must be called before run");
+	}
+	int numberOfPoint = em_numberOfPoint;
+
+	switch (scheme)
+	{
+	case Richardson:
+	case DufortFrankel:
+	{
+		//! Level 1 is the FTCS step, the single-rod methods return level max(t / deltat - 1, 1)
+		double beta = D * (deltat / (deltax * deltax));
+		int steps = snapshotLevel(t, deltat, 1) - 1;
+		if (scheme == Richardson)
+		{
+			explicitSteps(RichardsonStencil(beta), beta, steps);
+		}
+		else
+		{
+			explicitSteps(DufortFrankelStencil(beta), beta, steps);
+		}
+		break;
+	}
+	case Laasonen:
+	{
+		//! The matrix is shared by all the members: assembled and factorized once
+		double theta = D * (deltat / (deltax * deltax));
+		std::vector<double> lower(numberOfPoint, -theta), diag(numberOfPoint, 1 + 2 * theta), upper(numberOfPoint, -theta);
+		lower[0] = 0;
+		upper[numberOfPoint - 1] = 0;
+		em_solver.factorize(lower, diag, upper);
+		laasonenSteps(theta, snapshotLevel(t, deltat, 0));
+		break;
+	}
+	case CrankNicholson:
+	{
+		double lambda = D * (deltat / (2.0 * deltax * deltax));
+		std::vector<double> lower(numberOfPoint - 1, -lambda), diag(numberOfPoint - 1, 1 + 2 * lambda), upper(numberOfPoint - 1, -lambda);
+		lower[0] = 0;
+		upper[numberOfPoint - 2] = 0;
+		em_solver.factorize(lower, diag, upper);
+		crankNicholsonSteps(lambda, snapshotLevel(t, deltat, 0));
+		break;
+	}
+	}
+}
+
+std::vector<std::vector<double>> EnsembleMethods::solve(Scheme scheme, double deltax, int numberOfPoint, const std::vector<double> &tsurf, double D, double deltat, double t,
+														const std::vector<std::vector<double>> &temperatureInits)
+{
+	load(numberOfPoint, tsurf, temperatureInits);
+	run(scheme, deltax, D, deltat, t);
+	return getMembers();
+}
+
+std::span<const double> EnsembleMethods::getTemperatures() const
+{
+	return std::span<const double>(em_temperature.data(), static_cast<std::size_t>(em_numberOfPoint) * em_members);
+}
+
+std::vector<double> EnsembleMethods::getMember(int member) const
+{
+	if (member < 0 || member >= em_members)
+	{
+		throw std::out_of_range("No such member in the ensemble");
+	}
+	std::vector<double> temperature(em_numberOfPoint);
+	for (int i = 0; i < em_numberOfPoint; i++)
+	{
+		temperature[i] = em_temperature[static_cast<std::size_t>(i) * em_members + member];
+	}
+	return temperature;
+}
+
+std::vector<std::vector<double>> EnsembleMethods::getMembers() const
+{
+	std::vector<std::vector<double>> temperatures(em_members, std::vector<double>(em_numberOfPoint));
+	for (int i = 0; i < em_numberOfPoint; i++)
+	{
+		const double *row = em_temperature.data() + static_cast<std::size_t>(i) * em_members;
+		for (int k = 0; k < em_members; k++)
+		{
+			temperatures[k][i] = row[k];
+		}
+	}
+	return temperatures;
+}
+
+// Get functions
+int EnsembleMethods::getNumberOfPoint() const
+{
+	return em_numberOfPoint;
+}
+
+int EnsembleMethods::getNumberOfMembers() const
+{
+	return em_members;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#ifndef ENSEMBLEMETHODS_H
+#define ENSEMBLEMETHODS_H
+
+#include <vector>
+#include <span>
+#include <memory>
+
+#include "BatchedTridiagonalSolver.h"
+#include "ThreadPool.h"
+
+/**
+ * @class EnsembleMethods
+ * @brief This class advances E independent rods that share the grid, D and deltat, with their own initial profile and tsurf
+ *
+ * The E temperatures are interleaved, entry [point * E + member], so one time step of the whole ensemble is one sweep
+ * of vectorized rows: applyStencilRows for the explicit schemes, BatchedTridiagonalSolver for the implicit ones, the
+ * SIMD lanes running across members. Each member gives exactly the result of the single-rod method.
+ *
+ * The members never exchange data, so the ensemble is cut into tiles of members (a multiple of 8) and each tile runs
+ * the whole time loop before the next one, the threads sharing out the tiles without any barrier. A tile is copied
+ * into contiguous levels of its own (rows of its members only) for the run: the rows of the whole ensemble are E
+ * values apart, which defeats the prefetchers and, when E is a multiple of 512, maps every row to the same cache sets.
+ * The automatic tile width keeps the levels of a tile within TILE_BYTES, so they stay in cache for all the steps.
+ */
+
+class EnsembleMethods
+{
+public:
+	//! Schemes of an ensemble run
+	enum Scheme
+	{
+		Richardson,
+		DufortFrankel,
+		Laasonen,
+		CrankNicholson
+	};
+
+	//! Bytes of the time levels of one tile when its width is automatic (half of a 2 MB L2 cache)
+	static constexpr long TILE_BYTES = 1L << 20;
+
+private:
+	//! Attributes for the number of points and of members of the loaded ensemble
+	int em_numberOfPoint = 0;
+	int em_members = 0;
+	//! Attribute for the temperature at x=0 and x=L of each member
+	std::vector<double> em_tsurf;
+	//! Attribute for the interleaved temperatures, entry [point * E + member]
+	std::vector<double> em_temperature;
+	//! Attribute for the working levels of the tile of each thread (three levels for the explicit schemes, the
+	//! temperature and the right-hand side for Crank-Nicholson), with rows of the members of the tile only
+	std::vector<double> em_tile;
+	//! Attribute for the factorized matrix shared by all the members
+	BatchedTridiagonalSolver em_solver;
+	//! Attribute for the worker threads, kept between calls; null when running on one thread
+	std::shared_ptr<ThreadPool> em_pool;
+	//! Attribute for the number of members per tile, 0 for automatic
+	int em_tileMembers = 0;
+
+	/**
+	 * @brief Runs body(tile, first, count) on every tile of members [first, first + count), the tiles shared out
+	 * between the threads; tile is the working storage of the thread, levels * numberOfPoint * count values.
+	 * @param levels Number of levels a tile works on
+	 */
+	template <class Body>
+	void forEachTile(int levels, const Body &body);
+
+	/**
+	 * @brief Copies the members [first, first + count) of the interleaved temperatures into a tile level (row stride count).
+	 */
+	void gather(int first, int count, double *tile) const;
+
+	/**
+	 * @brief Copies a tile level back into the members [first, first + count) of the interleaved temperatures.
+	 */
+	void scatter(int first, int count, const double *tile);
+
+	/**
+	 * @brief FTCS step, then steps of a three-level scheme on each tile.
+	 * @param update Stencil of the scheme
+	 * @param beta Coefficient D deltat / deltax^2
+	 * @param steps Number of time steps after the FTCS step
+	 */
+	template <class Update>
+	void explicitSteps(const Update &update, double beta, int steps);
+
+	/**
+	 * @brief Laasonen steps on each tile with the factorized (1 + 2 theta, -theta) matrix.
+	 */
+	void laasonenSteps(double theta, int steps);
+
+	/**
+	 * @brief Crank-Nicholson steps on each tile with the factorized (1 + 2 lambda, -lambda) matrix.
+	 */
+	void crankNicholsonSteps(double lambda, int steps);
+
+public:
+	/**
+	 * @brief Selects the number of threads sharing the tiles, (re)starting the worker pool only when it changes.
+	 * @param numberOfThreads Number of threads, 1 (default) runs on the calling thread only
+	 */
+	void setThreads(int numberOfThreads);
+
+	//! Number of threads sharing the tiles
+	int getThreads() const;
+
+	/**
+	 * @brief Selects the number of members per tile.
+	 * @param tileMembers Members per tile, 0 (default) for the widest multiple of 8 whose levels fit in TILE_BYTES
+	 */
+	void setTileMembers(int tileMembers);
+
+	/**
+	 * @brief Number of members per tile of a run on the loaded ensemble.
+	 * @param levels Number of interleaved levels of the scheme (3 explicit, 2 Crank-Nicholson, 1 Laasonen)
+	 */
+	int getTileMembers(int levels) const;
+
+	/**
+	 * @brief Interleaves E initial profiles, sizing the levels once (no allocation when the ensemble does not grow).
+	 * @param numberOfPoint Total number of points to discretize
+	 * @param tsurf Temperature at x=0 and x=L of each member
+	 * @param temperatureInits Initial temperature distribution of each member
+	 */
+	void load(int numberOfPoint, const std::vector<double> &tsurf, const std::vector<std::vector<double>> &temperatureInits);
+
+	/**
+	 * @brief Advances the loaded ensemble, taken as the initial profiles, to the time level the single-rod method returns
+	 * for a final time t (snapshotLevel). The interleaved temperatures are replaced by the results.
+	 * @param scheme Scheme of the run
+	 * @param deltax Grid step
+	 * @param D Coefficient
+	 * @param deltat Time step
+	 * @param t Total simulation time
+	 */
+	void run(Scheme scheme, double deltax, double D, double deltat, double t);
+
+	/**
+	 * @brief Loads the ensemble, runs it and returns the result of each member (see load and run).
+	 */
+	std::vector<std::vector<double>> solve(Scheme scheme, double deltax, int numberOfPoint, const std::vector<double> &tsurf, double D, double deltat, double t,
+										   const std::vector<std::vector<double>> &temperatureInits);
+
+	//! Interleaved temperatures of the ensemble, entry [point * E + member], without copy
+	std::span<const double> getTemperatures() const;
+
+	//! Temperature distribution of one member
+	std::vector<double> getMember(int member) const;
+
+	//! Temperature distribution of every member
+	std::vector<std::vector<double>> getMembers() const;
+
+	//! Get Methods
+	int getNumberOfPoint() const;
+	int getNumberOfMembers() const;
+};
+#endif // ENSEMBLEMETHODS_H
@@ -1,109 +1,573 @@
 #include "ExplicitMethods.h"
-#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <barrier>
+#include <optional>
 
-std::vector<double> ExplicitMethods::richardsonMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, std::vector<double> temperatureInit)
+#include "StencilKernels.h"
+#include "CsvExporter.h"
+#include "Instrumentation.h"
+
+using namespace StencilKernels;
+
+void ExplicitMethods::setTemporalBlocking(int blockSteps, int tileWidth)
 {
+    if (blockSteps < 0 || tileWidth < 1)
+    {
+        throw std::invalid_argument("blockSteps must be non-negative and tileWidth positive");
+    }
+    e_blockSteps = blockSteps;
+    e_tileWidth = tileWidth;
+};
 
-    //! Coefficient
-    double beta = D * (deltat / (deltax * deltax));
+void ExplicitMethods::setSteadyStateDetection(double tolerance, int checkInterval)
+{
+    if (tolerance < 0 || checkInterval < 1)
+    {
+        throw std::invalid_argument("The steady-state tolerance must be non-negative and checkInterval positive");
+    }
+    e_steadyTolerance = tolerance;
+    e_steadyInterval = checkInterval;
+};
 
-    //! Number of time steps
-    int numStep = static_cast<int>(t / deltat);
+bool ExplicitMethods::reachedSteadyState() const
+{
+    return e_steadyReached;
+};
 
-    //! Reset Values
+double ExplicitMethods::getStopTime() const
+{
+    return e_stopTime;
+};
 
-    e_temperatureN_minus_1.clear();
-    e_temperatureN.clear();
-    ;
-    e_temperatureN_plus_1.clear();
-    ;
+void ExplicitMethods::setPrecision(Precision precision)
+{
+    e_precision = precision;
+};
 
-    //! Fill out the initial vector
-    e_temperatureN_minus_1 = temperatureInit;
+Precision ExplicitMethods::getPrecision() const
+{
+    return e_precision;
+};
 
-    //! Use the FTCS method to get the solution at the first time step
-    e_temperatureN.push_back(tsurf);
-    for (int i = 1; i < numberOfPoint - 1; i++)
+void ExplicitMethods::setThreadCount(int numberOfThreads)
+{
+    if (numberOfThreads < 1)
     {
-        e_temperatureN.push_back(e_temperatureN_minus_1[i] + beta * (e_temperatureN_minus_1[i + 1] - 2 * e_temperatureN_minus_1[i] + e_temperatureN_minus_1[i - 1]));
+        throw std::invalid_argument("The number of threads must be at least 1");
     }
-    e_temperatureN.push_back(tsurf);
 
-    //! Richardson Scheme
-    for (int n = 2; n < numStep; n++)
+    if (numberOfThreads == 1)
     {
-        e_temperatureN_plus_1.push_back(tsurf);
-        for (int i = 1; i < numberOfPoint - 1; i++)
-        {
-            e_temperatureN_plus_1.push_back(e_temperatureN_minus_1[i] + beta * (e_temperatureN[i + 1] - 2 * e_temperatureN[i] + e_temperatureN[i - 1]));
-        }
-        e_temperatureN_plus_1.push_back(tsurf);
+        e_pool.reset();
+    }
+    else if (!e_pool || e_pool->size() != numberOfThreads)
+    {
+        e_pool = std::make_shared<ThreadPool>(numberOfThreads);
+    }
+};
 
-        //! Update T_prev and T with the new values
-        e_temperatureN_minus_1 = e_temperatureN;
-        e_temperatureN = e_temperatureN_plus_1;
-        e_temperatureN_plus_1 = {};
+template <class Body>
+void ExplicitMethods::forEachChunk(int numberOfPoint, const Body &body)
+{
+    if (!e_pool)
+    {
+        body(0, 0, numberOfPoint);
+        return;
     }
 
-    //! Return the final temperature vector
-    return e_temperatureN;
+    e_pool->run([&](int thread)
+                {
+        long first, last;
+        e_pool->chunk(numberOfPoint, thread, first, last);
+        body(thread, first, last); });
 };
 
-std::vector<double> ExplicitMethods::dufort_frankelMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, std::vector<double> temperatureInit)
+template <class Compute, class Real>
+void ExplicitMethods::prepareWorkspace(Levels<Real> &levels, int numberOfPoint, const std::vector<double> &temperatureInit, double beta, double tsurf)
 {
+    HEAT_PROFILE_SCOPE("explicit.ftcs_start");
+    if (temperatureInit.size() != static_cast<std::size_t>(numberOfPoint))
+    {
+        throw std::invalid_argument("temperatureInit must have numberOfPoint values");
+    }
 
-    //! Coefficient
-    double beta = D * (deltat / (deltax * deltax));
+    //! resize reuses the existing capacity, so only the first call on a grid allocates; new entries are not written here
+    levels.temperatureN_minus_1.resize(numberOfPoint);
+    levels.temperatureN.resize(numberOfPoint);
+    levels.temperatureN_plus_1.resize(numberOfPoint);
 
-    //! Number of time steps
-    int numStep = static_cast<int>(t / deltat);
+    //! Fill out the initial vector, each thread its own chunk (rounded when the levels are float)
+    forEachChunk(numberOfPoint, [&](int, long first, long last)
+                 { std::copy(temperatureInit.begin() + first, temperatureInit.begin() + last, levels.temperatureN_minus_1.begin() + first); });
 
-    //! Fill out the initial vector
-    e_temperatureN_minus_1 = temperatureInit;
+    //! Use the FTCS method to get the solution at the first time step
+    forEachChunk(numberOfPoint, [&](int, long first, long last)
+                 {
+        //! Empty chunks (more threads than points) leave the boundaries to the chunks that hold them
+        if (first == 0 && last > first)
+        {
+            levels.temperatureN[0] = tsurf;
+        }
+        if (last == numberOfPoint && last > first)
+        {
+            levels.temperatureN[numberOfPoint - 1] = tsurf;
+        }
+        applyStencil1D(BasicFtcsStencil<Compute>(beta), nullptr, levels.temperatureN_minus_1.data(), levels.temperatureN.data(),
+                       std::max(first, 1L), std::min(last, numberOfPoint - 1L)); });
+};
 
-    //! Reset Values
+template <class Real>
+void ExplicitMethods::rotateLevels(Levels<Real> &levels)
+{
+    //! n-1 takes the buffer of n, n takes the buffer of n+1 and the old n-1 buffer is recycled for n+1
+    levels.temperatureN_minus_1.swap(levels.temperatureN);
+    levels.temperatureN.swap(levels.temperatureN_plus_1);
+};
 
-    e_temperatureN_minus_1.clear();
-    e_temperatureN.clear();
-    ;
-    e_temperatureN_plus_1.clear();
-    ;
+template <class Update, class Real>
+int ExplicitMethods::advance(Levels<Real> &levels, const Update &update, int numberOfPoint, double tsurf, int steps, double changeLimit, int level)
+{
+    //! One probe per call, not per step: the threads sweep their chunks without synchronizing on the counters
+    HEAT_PROFILE_SCOPE("explicit.stencil_steps");
+    HEAT_PROFILE_COUNT("explicit.point_updates", static_cast<unsigned long long>(steps) * numberOfPoint);
+    int numberOfThreads = e_pool ? e_pool->size() : 1;
 
-    //! Use the FTCS method to get the solution at the first time step
-    e_temperatureN.push_back(tsurf);
-    for (int i = 1; i < numberOfPoint - 1; i++)
+    //! One lightweight barrier per time step (per block when blocking), no thread creation per step
+    std::optional<std::barrier<>> sync;
+    if (numberOfThreads > 1)
     {
-        e_temperatureN.push_back(e_temperatureN_minus_1[i] + beta * (e_temperatureN_minus_1[i + 1] - 2 * e_temperatureN_minus_1[i] + e_temperatureN_minus_1[i - 1]));
+        sync.emplace(numberOfThreads);
     }
-    e_temperatureN.push_back(tsurf);
 
-    //! Dufort-Frankel Scheme
-    for (int n = 2; n < numStep; n++)
+    //! Steady-state checks: each thread stores the largest change of its points, all of them read the same values after the barrier
+    bool detect = changeLimit > 0;
+    if (detect)
+    {
+        e_changes.assign(2 * numberOfThreads, 0.0);
+    }
+    auto steadyAfter = [&](int check)
+    {
+        const double *changes = e_changes.data() + (check % 2) * numberOfThreads;
+        return *std::max_element(changes, changes + numberOfThreads) <= changeLimit;
+    };
+    //! Steps taken and outcome, only written by thread 0
+    int taken = steps;
+    bool steady = false;
+
+    if (e_blockSteps <= 1)
     {
-        e_temperatureN_plus_1.push_back(tsurf);
-        for (int i = 1; i < numberOfPoint - 1; i++)
+        //! One sweep of the whole grid per time step, each thread on its chunk
+        forEachChunk(numberOfPoint, [&](int thread, long first, long last)
+                     {
+            Real *prev = levels.temperatureN_minus_1.data();
+            Real *curr = levels.temperatureN.data();
+            Real *next = levels.temperatureN_plus_1.data();
+            long interiorFirst = std::max(first, 1L);
+            long interiorLast = std::min(last, numberOfPoint - 1L);
+
+            //! Only a non-empty chunk writes a boundary: with more threads than points, several chunks start at 0
+            bool ownsFirst = first == 0 && last > first;
+            bool ownsLast = last == numberOfPoint && last > first;
+            for (int n = 0; n < steps; n++)
+            {
+                if (ownsFirst)
+                {
+                    next[0] = tsurf;
+                }
+                if (ownsLast)
+                {
+                    next[numberOfPoint - 1] = tsurf;
+                }
+                bool check = detect && (level + n + 1) % e_steadyInterval == 0;
+                int checkIndex = (level + n + 1) / e_steadyInterval;
+                if (check)
+                {
+                    e_changes[(checkIndex % 2) * numberOfThreads + thread] = applyStencil1DMaxChange(update, prev, curr, next, interiorFirst, interiorLast);
+                }
+                else
+                {
+                    applyStencil1D(update, prev, curr, next, interiorFirst, interiorLast);
+                }
+
+                //! Level n+1 must be complete before any thread reads its neighbours
+                if (numberOfThreads > 1)
+                {
+                    sync->arrive_and_wait();
+                }
+
+                //! Update T_prev and T with the new values
+                Real *recycled = prev;
+                prev = curr;
+                curr = next;
+                next = recycled;
+
+                //! Every thread takes the same decision from the same values
+                if (check && steadyAfter(checkIndex))
+                {
+                    if (thread == 0)
+                    {
+                        taken = n + 1;
+                        steady = true;
+                    }
+                    break;
+                }
+            } });
+
+        //! The threads rotated their pointers, rotate the buffers the same way
+        for (int r = 0; r < taken % 3; r++)
         {
-            e_temperatureN_plus_1.push_back(e_temperatureN_minus_1[i] * ((1 - 2 * beta) / (1 + 2 * beta)) + ((2 * beta) / (1 + 2 * beta)) * (e_temperatureN[i + 1] + e_temperatureN[i - 1]));
+            rotateLevels(levels);
+        }
+        e_steadyReached = e_steadyReached || steady;
+        return taken;
+    }
+
+    //! Temporal blocking with overlapped trapezoidal tiles.
+    //! A tile writing points [lo, hi) after T steps loads levels n-1 and n on [lo - T, hi + T):
+    //! the region where both local levels are exact shrinks by one point per step on each side
+    //! (except at the fixed boundaries), so after T steps levels n+T-1 and n+T are exact on [lo, hi).
+    //! The halo is recomputed by neighbouring tiles, which keeps every value bit-for-bit identical.
+    //! Tiles only read the input levels, so they are shared out between the threads.
+    int halo = e_blockSteps;
+    int localSize = std::min(numberOfPoint, e_tileWidth + 2 * halo);
+    int numberOfTiles = (numberOfPoint + e_tileWidth - 1) / e_tileWidth;
+    levels.tile.resize(3 * static_cast<std::size_t>(localSize) * numberOfThreads);
+    levels.blockOutput.resize(numberOfPoint);
+
+    auto body = [&](int thread)
+    {
+        Real *inputPrev = levels.temperatureN_minus_1.data();
+        Real *inputCurr = levels.temperatureN.data();
+        Real *outputPrev = levels.blockOutput.data();
+        Real *outputCurr = levels.temperatureN_plus_1.data();
+        int firstTile = static_cast<long>(numberOfTiles) * thread / numberOfThreads;
+        int lastTile = static_cast<long>(numberOfTiles) * (thread + 1) / numberOfThreads;
+
+        for (int done = 0; done < steps; done += e_blockSteps)
+        {
+            int blockSteps = std::min(e_blockSteps, steps - done);
+            //! Checked at the end of the blocks that pass a multiple of the interval
+            int checkIndex = (level + done + blockSteps) / e_steadyInterval;
+            bool check = detect && checkIndex > (level + done) / e_steadyInterval;
+            double change = 0;
+
+            for (int tile = firstTile; tile < lastTile; tile++)
+            {
+                int lo = tile * e_tileWidth;
+                int hi = std::min(numberOfPoint, lo + e_tileWidth);
+                int a = std::max(0, lo - blockSteps);
+                int b = std::min(numberOfPoint, hi + blockSteps);
+                int width = b - a;
+
+                //! Local levels, indexed from a
+                Real *prev = levels.tile.data() + 3 * static_cast<std::size_t>(localSize) * thread;
+                Real *curr = prev + localSize;
+                Real *next = curr + localSize;
+                std::copy(inputPrev + a, inputPrev + b, prev);
+                std::copy(inputCurr + a, inputCurr + b, curr);
+
+                for (int s = 1; s <= blockSteps; s++)
+                {
+                    //! Exact region of level n+s, in local indices
+                    int first = a == 0 ? 1 : s;
+                    int last = b == numberOfPoint ? width - 1 : width - s;
+                    if (a == 0)
+                    {
+                        next[0] = tsurf;
+                    }
+                    if (b == numberOfPoint)
+                    {
+                        next[width - 1] = tsurf;
+                    }
+                    //! The last step of the block writes exactly the points owned by the tile
+                    if (check && s == blockSteps)
+                    {
+                        change = std::max(change, applyStencil1DMaxChange(update, prev, curr, next, first, last));
+                    }
+                    else
+                    {
+                        applyStencil1D(update, prev, curr, next, first, last);
+                    }
+
+                    Real *recycled = prev;
+                    prev = curr;
+                    curr = next;
+                    next = recycled;
+                }
+
+                //! Levels n+T-1 and n+T of the points owned by the tile
+                std::copy(prev + (lo - a), prev + (hi - a), outputPrev + lo);
+                std::copy(curr + (lo - a), curr + (hi - a), outputCurr + lo);
+            }
+            if (check)
+            {
+                e_changes[(checkIndex % 2) * numberOfThreads + thread] = change;
+            }
+
+            //! Every tile of the block must be written before the next block reads it
+            if (numberOfThreads > 1)
+            {
+                sync->arrive_and_wait();
+            }
+            std::swap(inputPrev, outputPrev);
+            std::swap(inputCurr, outputCurr);
+
+            if (check && steadyAfter(checkIndex))
+            {
+                if (thread == 0)
+                {
+                    taken = done + blockSteps;
+                    steady = true;
+                }
+                break;
+            }
         }
-        e_temperatureN_plus_1.push_back(tsurf);
+    };
 
-        //! Update T_prev and T with the new values
-        e_temperatureN_minus_1 = e_temperatureN;
-        e_temperatureN = e_temperatureN_plus_1;
-        e_temperatureN_plus_1 = {};
+    if (e_pool)
+    {
+        e_pool->run(body);
+    }
+    else
+    {
+        body(0);
     }
 
+    //! The threads swapped input and output once per block, swap the buffers the same way
+    int numberOfBlocks = (taken + e_blockSteps - 1) / e_blockSteps;
+    if (numberOfBlocks % 2 == 1)
+    {
+        levels.temperatureN_minus_1.swap(levels.blockOutput);
+        levels.temperatureN.swap(levels.temperatureN_plus_1);
+    }
+    e_steadyReached = e_steadyReached || steady;
+    return taken;
+};
+
+std::vector<double> ExplicitMethods::richardsonMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit, int numberOfThreads)
+{
+    //! Richardson Scheme after one FTCS step, time steps n = 2 .. numStep - 1: the level of a single output time t
+    std::vector<double> temperature;
+    richardsonMethods(deltax, numberOfPoint, tsurf, tinit, D, deltat, std::vector<double>{t}, temperatureInit, [&](double, std::span<const double> values)
+                      { temperature.assign(values.begin(), values.end()); }, nullptr, numberOfThreads);
+
+    //! Return the final temperature vector
+    return temperature;
+};
+
+std::vector<double> ExplicitMethods::dufort_frankelMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit, int numberOfThreads)
+{
+    //! Dufort-Frankel Scheme after one FTCS step, time steps n = 2 .. numStep - 1: the level of a single output time t
+    std::vector<double> temperature;
+    dufort_frankelMethods(deltax, numberOfPoint, tsurf, tinit, D, deltat, std::vector<double>{t}, temperatureInit, [&](double, std::span<const double> values)
+                          { temperature.assign(values.begin(), values.end()); }, nullptr, numberOfThreads);
+
     //! Return the final temperature vector
-    return e_temperatureN;
+    return temperature;
 }
 
-void ExplicitMethods::saveCSV(std::string e_fileName, std::vector<double> temperature)
+template <template <class> class Stencil, class Body>
+void ExplicitMethods::withPrecision(const Body &body)
 {
-    std::ofstream myfile;
-    myfile.open(e_fileName);
-    for (int i = 0; i < temperature.size(); i++)
+    switch (e_runPrecision)
     {
-        myfile << temperature[i] << "\n";
+    case Precision::Mixed:
+        body(e_floatLevels, Stencil<double>(e_beta));
+        break;
+    case Precision::Float:
+        body(e_floatLevels, Stencil<float>(e_beta));
+        break;
+    default:
+        body(e_levels, Stencil<double>(e_beta));
     }
-    myfile.close();
+};
+
+template <class Body>
+void ExplicitMethods::withLevels(const Body &body)
+{
+    if (e_scheme == Richardson)
+    {
+        withPrecision<BasicRichardsonStencil>(body);
+    }
+    else
+    {
+        withPrecision<BasicDufortFrankelStencil>(body);
+    }
+};
+
+void ExplicitMethods::start(Scheme scheme, double deltax, int numberOfPoint, double tsurf, double D, double deltat, const std::vector<double> &temperatureInit,
+                            const SolverState *state, int numberOfThreads)
+{
+    setThreadCount(numberOfThreads);
+
+    //! No run until the levels are loaded, so that a failed start cannot be stepped
+    e_numberOfPoint = 0;
+    e_scheme = scheme;
+    e_runPrecision = e_precision;
+    e_beta = D * (deltat / (deltax * deltax));
+    e_tsurf = tsurf;
+    e_deltat = deltat;
+
+    bool resume = state && state->step > 0;
+    withLevels([&](auto &levels, const auto &update)
+               {
+        typedef typename std::decay_t<decltype(update)>::Value Compute;
+        if (resume)
+        {
+            //! Resume: levels step-1 and step come from the state
+            if (state->previous.size() != static_cast<std::size_t>(numberOfPoint) || state->current.size() != static_cast<std::size_t>(numberOfPoint))
+            {
+                throw std::invalid_argument("The saved state does not match numberOfPoint");
+            }
+            levels.temperatureN_minus_1.assign(state->previous.begin(), state->previous.end());
+            levels.temperatureN.assign(state->current.begin(), state->current.end());
+            levels.temperatureN_plus_1.resize(numberOfPoint);
+        }
+        else
+        {
+            prepareWorkspace<Compute>(levels, numberOfPoint, temperatureInit, e_beta, tsurf);
+        } });
+
+    e_numberOfPoint = numberOfPoint;
+    e_level = resume ? state->step : 1;
+    e_steadyReached = false;
+    e_stopTime = e_level * deltat;
+};
+
+int ExplicitMethods::step(int steps)
+{
+    if (e_numberOfPoint == 0)
+    {
+        throw std::logic_error("start must be called before step");
+    }
+    if (steps < 0)
+    {
+        throw std::invalid_argument("The number of time steps must be non-negative");
+    }
+    //! Once steady, the temperature of the stop time is kept
+    if (e_steadyReached || steps == 0)
+    {
+        return 0;
+    }
+
+    int taken = 0;
+    withLevels([&](auto &levels, const auto &update)
+               { taken = advance(levels, update, e_numberOfPoint, e_tsurf, steps, e_steadyTolerance * e_deltat, e_level); });
+    e_level += taken;
+    e_stopTime = e_level * e_deltat;
+    return taken;
+};
+
+std::span<const double> ExplicitMethods::current()
+{
+    if (e_runPrecision == Precision::Double)
+    {
+        return std::span<const double>(e_levels.temperatureN.data(), e_numberOfPoint);
+    }
+    e_output.assign(e_floatLevels.temperatureN.begin(), e_floatLevels.temperatureN.end());
+    return std::span<const double>(e_output.data(), e_numberOfPoint);
+};
+
+std::span<const double> ExplicitMethods::previous()
+{
+    if (e_runPrecision == Precision::Double)
+    {
+        return std::span<const double>(e_levels.temperatureN_minus_1.data(), e_numberOfPoint);
+    }
+    e_previousOutput.assign(e_floatLevels.temperatureN_minus_1.begin(), e_floatLevels.temperatureN_minus_1.end());
+    return std::span<const double>(e_previousOutput.data(), e_numberOfPoint);
+};
+
+int ExplicitMethods::getLevel() const
+{
+    return e_level;
+};
+
+void ExplicitMethods::saveState(SolverState &state) const
+{
+    auto save = [&](const auto &levels)
+    {
+        state.step = e_level;
+        state.previous.assign(levels.temperatureN_minus_1.begin(), levels.temperatureN_minus_1.end());
+        state.current.assign(levels.temperatureN.begin(), levels.temperatureN.end());
+    };
+    if (e_runPrecision == Precision::Double)
+    {
+        save(e_levels);
+    }
+    else
+    {
+        save(e_floatLevels);
+    }
+};
+
+void ExplicitMethods::runSnapshots(const std::vector<double> &outputTimes, const SnapshotObserver &observer, SolverState *state)
+{
+    //! Visit the output times in increasing order, each one only advances from the previous one
+    for (int index : snapshotOrder(outputTimes))
+    {
+        int target = snapshotLevel(outputTimes[index], e_deltat, 1);
+        if (target < e_level)
+        {
+            throw std::invalid_argument("Output time " + std::to_string(outputTimes[index]) + " is before the resumed state");
+        }
+        //! Once steady, step does not advance and the later output times get the temperature of the stop time
+        step(target - e_level);
+
+        if (observer)
+        {
+            HEAT_PROFILE_SCOPE("output.observer");
+            observer(outputTimes[index], current());
+        }
+    }
+
+    //! Checkpoint for a later resume
+    if (state)
+    {
+        saveState(*state);
+    }
+};
+
+void ExplicitMethods::richardsonMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                                        const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state, int numberOfThreads)
+{
+    start(Richardson, deltax, numberOfPoint, tsurf, D, deltat, temperatureInit, state, numberOfThreads);
+    runSnapshots(outputTimes, observer, state);
+};
+
+std::vector<std::vector<double>> ExplicitMethods::richardsonMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                                                                    const std::vector<double> &temperatureInit, SolverState *state, int numberOfThreads)
+{
+    std::vector<std::vector<double>> snapshots(outputTimes.size());
+    int next = 0;
+    std::vector<int> order = snapshotOrder(outputTimes);
+
+    richardsonMethods(deltax, numberOfPoint, tsurf, tinit, D, deltat, outputTimes, temperatureInit, [&](double, std::span<const double> temperature)
+                      { snapshots[order[next++]].assign(temperature.begin(), temperature.end()); }, state, numberOfThreads);
+    return snapshots;
+};
+
+void ExplicitMethods::dufort_frankelMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                                            const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state, int numberOfThreads)
+{
+    start(DufortFrankel, deltax, numberOfPoint, tsurf, D, deltat, temperatureInit, state, numberOfThreads);
+    runSnapshots(outputTimes, observer, state);
+};
+
+std::vector<std::vector<double>> ExplicitMethods::dufort_frankelMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                                                                        const std::vector<double> &temperatureInit, SolverState *state, int numberOfThreads)
+{
+    std::vector<std::vector<double>> snapshots(outputTimes.size());
+    int next = 0;
+    std::vector<int> order = snapshotOrder(outputTimes);
+
+    dufort_frankelMethods(deltax, numberOfPoint, tsurf, tinit, D, deltat, outputTimes, temperatureInit, [&](double, std::span<const double> temperature)
+                          { snapshots[order[next++]].assign(temperature.begin(), temperature.end()); }, state, numberOfThreads);
+    return snapshots;
+};
+
+void ExplicitMethods::saveCSV(const std::string &fileName, const std::vector<double> &temperature)
+{
+    CsvExporter::write(fileName, temperature);
 };
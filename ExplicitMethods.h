@@ -5,24 +5,239 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <memory>
+#include <functional>
+#include <span>
+
+#include "DefaultInitAllocator.h"
+#include "ThreadPool.h"
+#include "SolverState.h"
+#include "Precision.h"
 
 /**
  * @class ExplicitMethods
  * @brief This class employs Richarson and Dufort-Frankel explicit schemes to solve the 1D heat equation
  *
+ * The time levels are stored as double, or as float with setPrecision (see Precision.h): the sweeps are bound by
+ * memory traffic, so float levels move half the bytes per step.
  */
 
 class ExplicitMethods
 {
+public:
+    //! Schemes of a run set up by start
+    enum Scheme
+    {
+        Richardson,
+        DufortFrankel
+    };
+
+    //! Storage of one time level; new entries are left uninitialized so that worker threads place them (first touch)
+    template <class Real>
+    using LevelBuffer = std::vector<Real, DefaultInitAllocator<Real>>;
+
 private:
-    //! Attribute for data storage at time step n-1
-    std::vector<double> e_temperatureN_minus_1;
-    //! Attribute for data storage at time step n
-    std::vector<double> e_temperatureN;
-    //! Attribute for data storage at time step n+1
-    std::vector<double> e_temperatureN_plus_1;
+    //! Time levels of the runs that store their values as Real
+    template <class Real>
+    struct Levels
+    {
+        //! Data storage at time step n-1, n and n+1
+        LevelBuffer<Real> temperatureN_minus_1;
+        LevelBuffer<Real> temperatureN;
+        LevelBuffer<Real> temperatureN_plus_1;
+        //! Second output level of a temporal block (the first one reuses level n+1)
+        LevelBuffer<Real> blockOutput;
+        //! Three local time levels of a tile, one set per thread
+        std::vector<Real> tile;
+    };
+
+    //! Attribute for the time levels of the double runs
+    Levels<double> e_levels;
+    //! Attribute for the time levels of the float runs (Precision::Mixed and Precision::Float)
+    Levels<float> e_floatLevels;
+    //! Attribute for a float level widened to double for the observer and the result
+    std::vector<double> e_output;
+    //! Attribute for level n-1 widened to double, see previous()
+    std::vector<double> e_previousOutput;
+    //! Attribute for the storage and arithmetic precision
+    Precision e_precision = Precision::Double;
+    //! Attribute for the worker threads, kept between calls; null when running on one thread
+    std::shared_ptr<ThreadPool> e_pool;
+    //! Attribute for the number of time steps advanced per tile, 0 or 1 disables temporal blocking
+    int e_blockSteps = 0;
+    //! Attribute for the number of grid points written by each tile
+    int e_tileWidth = 4096;
+    //! Attribute for the steady-state tolerance on max |dT/dt|, 0 disables the detection
+    double e_steadyTolerance = 0;
+    //! Attribute for the number of time steps between two convergence checks
+    int e_steadyInterval = 10;
+    //! Attribute for the largest change of each thread at the last two checks, alternating so a slow reader never sees the next check
+    std::vector<double> e_changes;
+    //! Attributes for the outcome of the last run: steady state reached, and time of the returned temperature
+    bool e_steadyReached = false;
+    double e_stopTime = 0;
+    //! Attributes for the run set up by start: scheme, precision of its levels, grid size (0 before the first start),
+    //! coefficient D deltat / deltax^2, boundary temperature, time step and time level of temperatureN
+    Scheme e_scheme = Richardson;
+    Precision e_runPrecision = Precision::Double;
+    int e_numberOfPoint = 0;
+    double e_beta = 0;
+    double e_tsurf = 0;
+    double e_deltat = 0;
+    int e_level = 0;
+
+    /**
+     * @brief Selects the number of threads, (re)starting the worker pool only when it changes.
+     * @param numberOfThreads Number of threads, 1 runs on the calling thread only
+     */
+    void setThreadCount(int numberOfThreads);
+
+    /**
+     * @brief Runs body(thread, first, last) on every thread, with [first, last) the chunk of the grid owned by the thread.
+     * @param numberOfPoint Total number of points to discretize
+     * @param body Work of one thread, called directly (no std::function allocation) on one thread
+     */
+    template <class Body>
+    void forEachChunk(int numberOfPoint, const Body &body);
+
+    /**
+     * @brief Sizes the three time levels once, loads the initial distribution into level n-1 and
+     * computes level n with the FTCS method. Each thread writes its own chunk first (first-touch placement).
+     * Capacity is kept between calls, so a second run on the same grid does not allocate.
+     * @tparam Compute Arithmetic type of the FTCS step
+     * @param levels Time levels of the run
+     * @param numberOfPoint Total number of points to discretize
+     * @param temperatureInit Initial temperature distribution vector
+     * @param beta Coefficient D deltat / deltax^2
+     * @param tsurf Temperature at x=0 and x=L
+     */
+    template <class Compute, class Real>
+    void prepareWorkspace(Levels<Real> &levels, int numberOfPoint, const std::vector<double> &temperatureInit, double beta, double tsurf);
+
+    /**
+     * @brief Rotates the three time levels (n-1 <- n <- n+1) by swapping buffers, without copying data.
+     */
+    template <class Real>
+    static void rotateLevels(Levels<Real> &levels);
+
+    /**
+     * @brief Advances levels n-1 and n by a number of time steps with the selected loop (naive or temporally blocked).
+     * With several threads each one updates its chunk (or its tiles) and waits on one barrier per time step (per block).
+     * When the steady-state detection is on, the sweeps that produce a level multiple of e_steadyInterval (the last sweep
+     * of a block that passes one when blocking) also measure the largest change, and the loop stops once it is at most changeLimit.
+     * @param levels Time levels of the run
+     * @param update Stencil of the scheme (see StencilKernels.h), whose value type is the arithmetic type
+     * @param numberOfPoint Total number of points to discretize
+     * @param tsurf Temperature at x=0 and x=L
+     * @param steps Number of time steps
+     * @param changeLimit Largest change per step of a steady level (e_steadyTolerance * deltat)
+     * @param level Time level of levels.temperatureN, so that a run split into several calls checks the same levels
+     * @return Number of time steps taken, less than steps when the steady state is reached first
+     */
+    template <class Update, class Real>
+    int advance(Levels<Real> &levels, const Update &update, int numberOfPoint, double tsurf, int steps, double changeLimit, int level);
+
+    /**
+     * @brief Calls body(levels, update) with the time levels and the stencil of the started run: Stencil<double> on double
+     * or float levels, or Stencil<float> on float levels, depending on its precision.
+     * @tparam Stencil Stencil template of the scheme (BasicRichardsonStencil or BasicDufortFrankelStencil)
+     */
+    template <template <class> class Stencil, class Body>
+    void withPrecision(const Body &body);
+
+    /**
+     * @brief Calls body(levels, update) with the time levels and the stencil of the scheme of the started run.
+     */
+    template <class Body>
+    void withLevels(const Body &body);
+
+    /**
+     * @brief Advances the started run to every output time (in increasing order) and calls the observer there.
+     * @param outputTimes Times at which the observer is called
+     * @param observer Called with each output time and the temperature at that time
+     * @param state If not null, filled with the final state on return
+     */
+    void runSnapshots(const std::vector<double> &outputTimes, const SnapshotObserver &observer, SolverState *state);
 
 public:
+    /**
+     * @brief Enables temporal blocking: each cache-resident tile of the grid is advanced by several time steps
+     * before moving to the next one. Results are bit-for-bit identical to the time step by time step loop.
+     * @param blockSteps Number of time steps per tile, 0 or 1 disables temporal blocking (default)
+     * @param tileWidth Number of grid points written by each tile
+     */
+    void setTemporalBlocking(int blockSteps, int tileWidth = 4096);
+
+    /**
+     * @brief Enables the steady-state detection: every checkInterval steps, max_i |T_i^{n+1} - T_i^n| / deltat is
+     * computed in the same sweep as the update, and the run stops when it is at most tolerance. The result is then the
+     * temperature at the stop time (getStopTime); later output times of a snapshot run get that same temperature.
+     * @param tolerance Largest rate of change of a steady profile, in temperature units per time unit; 0 disables the detection (default)
+     * @param checkInterval Number of time steps between two checks
+     */
+    void setSteadyStateDetection(double tolerance, int checkInterval = 10);
+
+    /**
+     * @brief Selects how the time levels are stored and updated. With Precision::Mixed the levels are float and every
+     * update is computed in double from the widened values; with Precision::Float both are float. The initial
+     * distribution, the results and the saved states stay double.
+     * @param precision Storage and arithmetic precision, Precision::Double by default
+     */
+    void setPrecision(Precision precision);
+
+    //! Precision of the next runs
+    Precision getPrecision() const;
+
+    //! True when the last run stopped at a steady state
+    bool reachedSteadyState() const;
+    //! Time of the temperature returned by the last run (its final time when no steady state was detected)
+    double getStopTime() const;
+
+    //! Incremental Methods
+    /**
+     * @brief Sets up a run that step then advances: sizes the three time levels (no allocation when the grid does not
+     * grow), loads the initial distribution and computes level 1 with the FTCS method, or loads a saved state.
+     * The precision selected at this call is used until the next start.
+     * @param scheme Scheme of the run
+     * @param deltax grid step
+     * @param numberOfPoint Total number of points to discretize
+     * @param tsurf  Temperature at x=0 and x=L
+     * @param D coefficient
+     * @param deltat time step
+     * @param temperatureInit Initial temperature distribution vector (ignored when resuming)
+     * @param state If not null and state->step > 0, the run starts from it
+     * @param numberOfThreads Number of threads sharing the grid (default 1)
+     */
+    void start(Scheme scheme, double deltax, int numberOfPoint, double tsurf, double D, double deltat, const std::vector<double> &temperatureInit,
+               const SolverState *state = nullptr, int numberOfThreads = 1);
+
+    /**
+     * @brief Advances the started run by a number of time steps on its time levels, without allocating or copying them.
+     * @param steps Number of time steps
+     * @return Number of time steps taken, less than steps once the steady state is reached (then 0 until the next start)
+     */
+    int step(int steps);
+
+    /**
+     * @brief Temperature at the current time level of the started run. With double levels the span points into them;
+     * float levels are first widened into a buffer of the object. Valid until the next step or start.
+     */
+    std::span<const double> current();
+
+    /**
+     * @brief Temperature at the time level before current(), the other level of the three-level schemes, viewed or
+     * widened like current() into a buffer of its own. Valid until the next step or start.
+     */
+    std::span<const double> previous();
+
+    //! Time level of the started run: 1 after a start from the initial distribution (the FTCS step)
+    int getLevel() const;
+
+    /**
+     * @brief Copies the current and previous levels of the started run into state, for a later start from it.
+     */
+    void saveState(SolverState &state) const;
+
     //! Methods
     /**
      * @brief This function applies the Dufort-Frankel scheme to solve 1D heat equation
@@ -34,9 +249,10 @@ public:
      * @param deltat time step
      * @param t  total simulation time
      * @param temperatureInit Initial temperature distribution vector
+     * @param numberOfThreads Number of threads sharing the grid (default 1); the pool is kept for the next calls
      * @return Final temperature distribution at time t
      */
-    std::vector<double> dufort_frankelMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, std::vector<double> temperatureInit);
+    std::vector<double> dufort_frankelMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit, int numberOfThreads = 1);
     /**
      * @brief This function applies the Richarson scheme to solve 1D heat equation
      * @param deltax grid step
@@ -47,17 +263,67 @@ public:
      * @param deltat time step
      * @param t  total simulation time
      * @param temperatureInit Initial temperature distribution vector
+     * @param numberOfThreads Number of threads sharing the grid (default 1); the pool is kept for the next calls
      * @return Final temperature distribution at time t
      */
-    std::vector<double> richardsonMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, std::vector<double> temperatureInit);
+    std::vector<double> richardsonMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit, int numberOfThreads = 1);
+
+    //! Snapshot Methods
+    /**
+     * @brief Dufort-Frankel scheme with several output times computed in a single forward run.
+     * The temperature passed for time t is identical to dufort_frankelMethods(..., t, ...).
+     * @param deltax grid step
+     * @param numberOfPoint Total number of points to discretize
+     * @param tsurf  Temperature at x=0 and x=L
+     * @param tinit Temperature at t=0
+     * @param D coefficient
+     * @param deltat time step
+     * @param outputTimes Times at which the temperature is reported
+     * @param temperatureInit Initial temperature distribution vector
+     * @param observer Called with each output time (in increasing order) and the temperature at that time
+     * @param state If not null, resumes from it when state->step > 0 and receives the final state (checkpoint)
+     * @param numberOfThreads Number of threads sharing the grid (default 1)
+     */
+    void dufort_frankelMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                               const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state = nullptr, int numberOfThreads = 1);
+
+    /**
+     * @brief Same as the observer version, returning one temperature distribution per output time (in the order given).
+     */
+    std::vector<std::vector<double>> dufort_frankelMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                                                           const std::vector<double> &temperatureInit, SolverState *state = nullptr, int numberOfThreads = 1);
+
+    /**
+     * @brief Richardson scheme with several output times computed in a single forward run.
+     * The temperature passed for time t is identical to richardsonMethods(..., t, ...).
+     * @param deltax grid step
+     * @param numberOfPoint Total number of points to discretize
+     * @param tsurf  Temperature at x=0 and x=L
+     * @param tinit Temperature at t=0
+     * @param D coefficient
+     * @param deltat time step
+     * @param outputTimes Times at which the temperature is reported
+     * @param temperatureInit Initial temperature distribution vector
+     * @param observer Called with each output time (in increasing order) and the temperature at that time
+     * @param state If not null, resumes from it when state->step > 0 and receives the final state (checkpoint)
+     * @param numberOfThreads Number of threads sharing the grid (default 1)
+     */
+    void richardsonMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                           const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state = nullptr, int numberOfThreads = 1);
+
+    /**
+     * @brief Same as the observer version, returning one temperature distribution per output time (in the order given).
+     */
+    std::vector<std::vector<double>> richardsonMethods(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                                                       const std::vector<double> &temperatureInit, SolverState *state = nullptr, int numberOfThreads = 1);
 
     //! Write Methods
     /**
-     * @brief Saves the values of the vector to a CSV file.
-     * @param e_fileName Name of the CSV file.
+     * @brief Saves the values of the vector to a CSV file (CsvExporter, full double precision).
+     * @param fileName Name of the CSV file.
      * @param temperature Vector to be filled in the CSV file.
      */
-    void saveCSV(std::string e_fileName, std::vector<double> temperature);
+    void saveCSV(const std::string &fileName, const std::vector<double> &temperature);
 };
 
 #endif // EXPLICITMETHODS_H
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "FastSineTransform.h"
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <algorithm>
+
+#include "Instrumentation.h"
+
+namespace
+{
+	typedef std::complex<double> Complex;
+
+	//! Largest prime factor done directly; a larger one goes through Bluestein's algorithm
+	constexpr int MAX_DIRECT_RADIX = 64;
+
+	//! Product without the NaN/inf recovery of std::complex, which is a library call at -O2
+	inline Complex multiply(Complex a, Complex b)
+	{
+		return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+	}
+
+	//! Radices of the stages of an FFT of length n: the factors 4 first, then 2, then the odd primes
+	std::vector<int> factorize(int n)
+	{
+		std::vector<int> radices;
+		while (n % 4 == 0)
+		{
+			radices.push_back(4);
+			n /= 4;
+		}
+		if (n % 2 == 0)
+		{
+			radices.push_back(2);
+			n /= 2;
+		}
+		for (int p = 3; p * p <= n; p += 2)
+		{
+			while (n % p == 0)
+			{
+				radices.push_back(p);
+				n /= p;
+			}
+		}
+		if (n > 1)
+		{
+			radices.push_back(n);
+		}
+		return radices;
+	}
+
+	//! Complex products of an FFT, a radix-p stage costing about p per point (radices 2 and 4 less)
+	double fftCost(int n, const std::vector<int> &radices)
+	{
+		double cost = 0;
+		for (int radix : radices)
+		{
+			cost += radix == 2 ? 1.0 : radix == 4 ? 2.0 : radix;
+		}
+		return cost * n;
+	}
+
+	//! roots[k] = exp(-2 pi i k / n)
+	std::vector<Complex> unitRoots(int n)
+	{
+		std::vector<Complex> roots(n);
+		for (int k = 0; k < n; k++)
+		{
+			double angle = -2 * std::numbers::pi * k / n;
+			roots[k] = Complex(std::cos(angle), std::sin(angle));
+		}
+		return roots;
+	}
+
+	//! Radix-2 Stockham stage: m butterflies of 'stride' interleaved sequences, twiddles exp(-2 pi i p u / (2 m)) = roots[p u stride]
+	void stage2(const Complex *roots, int m, int stride, const Complex *source, Complex *target)
+	{
+		for (int p = 0; p < m; p++)
+		{
+			const Complex w1 = roots[p * stride];
+			const Complex *in = source + stride * p;
+			Complex *out = target + stride * 2 * p;
+			for (int q = 0; q < stride; q++)
+			{
+				Complex a0 = in[q], a1 = in[q + stride * m];
+				out[q] = a0 + a1;
+				out[q + stride] = multiply(a0 - a1, w1);
+			}
+		}
+	}
+
+	//! Radix-4 Stockham stage
+	void stage4(const Complex *roots, int m, int stride, const Complex *source, Complex *target)
+	{
+		for (int p = 0; p < m; p++)
+		{
+			const Complex w1 = roots[p * stride], w2 = roots[2 * p * stride], w3 = roots[3 * p * stride];
+			const Complex *in = source + stride * p;
+			Complex *out = target + stride * 4 * p;
+			for (int q = 0; q < stride; q++)
+			{
+				Complex a0 = in[q], a1 = in[q + stride * m], a2 = in[q + 2 * stride * m], a3 = in[q + 3 * stride * m];
+				Complex s02 = a0 + a2, d02 = a0 - a2, s13 = a1 + a3, d13 = a1 - a3;
+				//! -i (a1 - a3)
+				Complex rotated(d13.imag(), -d13.real());
+				out[q] = s02 + s13;
+				out[q + stride] = multiply(d02 + rotated, w1);
+				out[q + 2 * stride] = multiply(s02 - s13, w2);
+				out[q + 3 * stride] = multiply(d02 - rotated, w3);
+			}
+		}
+	}
+
+	//! Stage of any other radix, a direct DFT whose roots exp(-2 pi i / radix) are roots[n / radix]
+	void stageDirect(const Complex *roots, int n, int radix, int m, int stride, const Complex *source, Complex *target)
+	{
+		int step = n / radix;
+		Complex a[MAX_DIRECT_RADIX];
+		for (int p = 0; p < m; p++)
+		{
+			const Complex *in = source + stride * p;
+			Complex *out = target + stride * radix * p;
+			for (int q = 0; q < stride; q++)
+			{
+				for (int k = 0; k < radix; k++)
+				{
+					a[k] = in[q + k * stride * m];
+				}
+				for (int u = 0; u < radix; u++)
+				{
+					Complex sum = a[0];
+					int index = 0;
+					for (int k = 1; k < radix; k++)
+					{
+						index += u;
+						if (index >= radix)
+						{
+							index -= radix;
+						}
+						sum += multiply(a[k], roots[index * step]);
+					}
+					out[q + u * stride] = multiply(sum, roots[p * u * stride]);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Forward FFT (exp(-2 pi i j k / n)) by Stockham stages: each stage reads one buffer and writes the other
+	 * in sorted order, so there is no bit reversal. The result is left in data.
+	 */
+	void stockham(const std::vector<int> &radices, const Complex *roots, int n, Complex *data, Complex *work)
+	{
+		Complex *source = data;
+		Complex *target = work;
+		int length = n;
+		int stride = 1;
+		for (int radix : radices)
+		{
+			int m = length / radix;
+			if (radix == 4)
+			{
+				stage4(roots, m, stride, source, target);
+			}
+			else if (radix == 2)
+			{
+				stage2(roots, m, stride, source, target);
+			}
+			else
+			{
+				stageDirect(roots, n, radix, m, stride, source, target);
+			}
+			std::swap(source, target);
+			length = m;
+			stride *= radix;
+		}
+		if (source != data)
+		{
+			std::copy(source, source + n, data);
+		}
+	}
+}
+
+// Constructors
+FastSineTransform::FastSineTransform()
+{
+}
+
+FastSineTransform::FastSineTransform(int size)
+{
+	plan(size);
+}
+
+void FastSineTransform::plan(int size)
+{
+	if (size < 1)
+	{
+		throw std::invalid_argument("A sine transform needs at least one value");
+	}
+	if (size == fst_size)
+	{
+		return;
+	}
+
+	HEAT_PROFILE_SCOPE("sine_transform.plan");
+	fst_size = size;
+	fst_length = size + 1;
+	int n = fst_length;
+	fst_radices = factorize(n);
+	fst_roots = unitRoots(n);
+	fst_halfRoots.resize(n);
+	for (int k = 0; k < n; k++)
+	{
+		double angle = -std::numbers::pi * k / n;
+		fst_halfRoots[k] = Complex(std::cos(angle), std::sin(angle));
+	}
+	fst_data.resize(n);
+	fst_work.resize(n);
+
+	//! Bluestein: a convolution of power-of-two length L >= 2n - 1, two FFTs of length L per transform (the chirp spectrum is planned)
+	int length = 1;
+	while (length < 2 * n - 1)
+	{
+		length *= 2;
+	}
+	std::vector<int> powerRadices = factorize(length);
+	//! The radices are in increasing order after the 4s and 2s, so the last one is the largest
+	if (fst_radices.back() <= MAX_DIRECT_RADIX && fftCost(n, fst_radices) <= 2 * fftCost(length, powerRadices) + 3.0 * length)
+	{
+		fst_bluesteinLength = 0;
+		fst_bluesteinRadices.clear();
+		fst_bluesteinRoots.clear();
+		fst_chirp.clear();
+		fst_chirpSpectrum.clear();
+		fst_convolution.clear();
+		return;
+	}
+
+	fst_bluesteinLength = length;
+	fst_bluesteinRadices = powerRadices;
+	fst_bluesteinRoots = unitRoots(length);
+	fst_chirp.resize(n);
+	for (int j = 0; j < n; j++)
+	{
+		//! j^2 mod 2n keeps the angle small, so the chirp stays accurate for large n
+		long square = static_cast<long>(j) * j % (2L * n);
+		double angle = -std::numbers::pi * square / n;
+		fst_chirp[j] = Complex(std::cos(angle), std::sin(angle));
+	}
+	fst_chirpSpectrum.assign(length, Complex(0, 0));
+	fst_chirpSpectrum[0] = std::conj(fst_chirp[0]);
+	for (int j = 1; j < n; j++)
+	{
+		fst_chirpSpectrum[j] = fst_chirpSpectrum[length - j] = std::conj(fst_chirp[j]);
+	}
+	fst_convolution.resize(length);
+	std::vector<Complex> work(length);
+	stockham(fst_bluesteinRadices, fst_bluesteinRoots.data(), length, fst_chirpSpectrum.data(), work.data());
+	for (Complex &value : fst_chirpSpectrum)
+	{
+		value /= length;
+	}
+	fst_work.resize(length);
+}
+
+void FastSineTransform::fft()
+{
+	int n = fst_length;
+	if (fst_bluesteinLength == 0)
+	{
+		stockham(fst_radices, fst_roots.data(), n, fst_data.data(), fst_work.data());
+		return;
+	}
+
+	//! X_k = c_k sum_j (x_j c_j) conj(c_{k-j}): the sum is a convolution, done with forward FFTs (inverse = conjugate of forward of conjugate)
+	int length = fst_bluesteinLength;
+	for (int j = 0; j < n; j++)
+	{
+		fst_convolution[j] = multiply(fst_data[j], fst_chirp[j]);
+	}
+	std::fill(fst_convolution.begin() + n, fst_convolution.end(), Complex(0, 0));
+	stockham(fst_bluesteinRadices, fst_bluesteinRoots.data(), length, fst_convolution.data(), fst_work.data());
+	for (int k = 0; k < length; k++)
+	{
+		fst_convolution[k] = std::conj(multiply(fst_convolution[k], fst_chirpSpectrum[k]));
+	}
+	stockham(fst_bluesteinRadices, fst_bluesteinRoots.data(), length, fst_convolution.data(), fst_work.data());
+	for (int k = 0; k < n; k++)
+	{
+		fst_data[k] = multiply(std::conj(fst_convolution[k]), fst_chirp[k]);
+	}
+}
+
+void FastSineTransform::transform(std::span<double> values)
+{
+	if (values.size() != static_cast<std::size_t>(fst_size))
+	{
+		throw std::invalid_argument("The sine transform was planned for another size");
+	}
+	HEAT_PROFILE_SCOPE("sine_transform.transform");
+	int n = fst_length;
+
+	//! Odd extension y of length 2n (y_0 = y_n = 0, y_j = x_j, y_{2n-j} = -x_j), packed as z_j = y_{2j} + i y_{2j+1}
+	auto extension = [&](int m)
+	{
+		if (m == 0 || m == n)
+		{
+			return 0.0;
+		}
+		return m < n ? values[m - 1] : -values[2 * n - m - 1];
+	};
+	for (int j = 0; j < n; j++)
+	{
+		fst_data[j] = Complex(extension(2 * j), extension(2 * j + 1));
+	}
+
+	fft();
+
+	//! Y_k = E_k + exp(-i pi k / n) O_k with E_k, O_k the transforms of the even and odd samples; Y_k = -2 i S_k
+	for (int k = 1; k <= fst_size; k++)
+	{
+		Complex z = fst_data[k];
+		Complex mirror = std::conj(fst_data[n - k]);
+		Complex even = 0.5 * (z + mirror);
+		Complex difference = 0.5 * (z - mirror);
+		//! O_k = -i (Z_k - conj(Z_{n-k})) / 2
+		Complex odd(difference.imag(), -difference.real());
+		Complex y = even + multiply(fst_halfRoots[k], odd);
+		values[k - 1] = -0.5 * y.imag();
+	}
+}
+
+// Get functions
+int FastSineTransform::size() const
+{
+	return fst_size;
+}
+
+bool FastSineTransform::usesBluestein() const
+{
+	return fst_bluesteinLength > 0;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef FASTSINETRANSFORM_H
+#define FASTSINETRANSFORM_H
+
+#include <vector>
+#include <complex>
+#include <span>
+
+/**
+ * @class FastSineTransform
+ * @brief This class computes the discrete sine transform DST-I of a fixed size in O(M log M), in place
+ *
+ * S_k = sum_{j=1}^{M} x_j sin(pi j k / (M + 1)), k = 1 .. M. The transform is its own inverse up to the factor
+ * 2 / (M + 1). It diagonalizes the (-1, 2, -1) matrix of size M with zero (Dirichlet) values beyond both ends.
+ *
+ * The odd extension of x (length 2 (M + 1), real) is packed two values per complex number, so one complex FFT of
+ * length n = M + 1 does the whole transform. The FFT is a self-sorting (Stockham) mixed-radix FFT with radices 4
+ * and 2 written out and the other prime factors done directly. When n has a prime factor too large for that,
+ * Bluestein's algorithm turns the FFT into a convolution of power-of-two length. All the twiddles and buffers are
+ * built by plan(), so transform() does not allocate.
+ */
+
+class FastSineTransform
+{
+private:
+	//! Attribute for the size M of the transform
+	int fst_size = 0;
+	//! Attribute for the length n = M + 1 of the complex FFT
+	int fst_length = 0;
+	//! Attributes for the FFT of length n: radices of its stages and the n-th roots of unity exp(-2 pi i k / n)
+	std::vector<int> fst_radices;
+	std::vector<std::complex<double>> fst_roots;
+	//! Attribute for exp(-i pi k / n), which combines the packed halves of the odd extension
+	std::vector<std::complex<double>> fst_halfRoots;
+	//! Attributes for Bluestein's algorithm (unused when fst_bluesteinLength is 0): power-of-two length, its radices
+	//! and roots, the chirp exp(-i pi j^2 / n) and the spectrum of the conjugate chirp divided by the length
+	int fst_bluesteinLength = 0;
+	std::vector<int> fst_bluesteinRadices;
+	std::vector<std::complex<double>> fst_bluesteinRoots;
+	std::vector<std::complex<double>> fst_chirp;
+	std::vector<std::complex<double>> fst_chirpSpectrum;
+	//! Attributes for the work buffers
+	std::vector<std::complex<double>> fst_data;
+	std::vector<std::complex<double>> fst_work;
+	std::vector<std::complex<double>> fst_convolution;
+
+	/**
+	 * @brief Forward complex FFT of length fst_length on fst_data, in place (uses fst_work and the Bluestein buffers).
+	 */
+	void fft();
+
+public:
+	FastSineTransform();
+
+	//! Builds the transform of size M (see plan)
+	explicit FastSineTransform(int size);
+
+	/**
+	 * @brief Precomputes the FFT factorization, twiddles and buffers for transforms of size M.
+	 * Nothing is recomputed when the size does not change.
+	 * @param size Number of values M, at least 1
+	 */
+	void plan(int size);
+
+	/**
+	 * @brief Replaces the M values by their DST-I (not normalized).
+	 * @param values Values x_1 .. x_M on entry, S_1 .. S_M on exit
+	 */
+	void transform(std::span<double> values);
+
+	//! Get Methods
+	int size() const;
+	//! True when the FFT goes through Bluestein's algorithm (M + 1 has a large prime factor)
+	bool usesBluestein() const;
+};
+#endif // FASTSINETRANSFORM_H
@@ -0,0 +1,147 @@
+#include "Grid.h"
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+// Constructor
+Grid::Grid(std::vector<double> positions, std::vector<double> diffusivity) : g_position(std::move(positions)), g_diffusivity(std::move(diffusivity))
+{
+	if (g_position.size() < 3 || g_diffusivity.size() + 1 != g_position.size())
+	{
+		throw std::invalid_argument("A grid needs at least three points and one coefficient per cell");
+	}
+	if (g_position[0] != 0)
+	{
+		throw std::invalid_argument("The first point of a grid must be at x=0");
+	}
+	for (std::size_t i = 0; i + 1 < g_position.size(); i++)
+	{
+		if (!(g_position[i + 1] > g_position[i]) || !(g_diffusivity[i] > 0))
+		{
+			throw std::invalid_argument("The points of a grid must increase and every coefficient must be positive");
+		}
+	}
+}
+
+Grid Grid::uniform(double deltax, int numberOfPoint, double D)
+{
+	std::vector<double> positions(std::max(numberOfPoint, 0));
+	for (int i = 0; i < numberOfPoint; i++)
+	{
+		positions[i] = i * deltax;
+	}
+	return Grid(std::move(positions), std::vector<double>(std::max(numberOfPoint - 1, 0), D));
+}
+
+Grid Grid::stretched(double length, int numberOfPoint, double D, double stretching)
+{
+	if (stretching < 0)
+	{
+		throw std::invalid_argument("The stretching of a grid must be non-negative");
+	}
+	if (stretching == 0)
+	{
+		return uniform(length / (numberOfPoint - 1), numberOfPoint, D);
+	}
+
+	std::vector<double> positions(std::max(numberOfPoint, 0));
+	double scale = std::tanh(stretching);
+	for (int i = 0; i < numberOfPoint; i++)
+	{
+		double xi = 2.0 * i / (numberOfPoint - 1) - 1;
+		positions[i] = 0.5 * length * (1 + std::tanh(stretching * xi) / scale);
+	}
+	//! Exact surfaces and symmetry, whatever the rounding of tanh
+	if (numberOfPoint > 0)
+	{
+		positions[0] = 0;
+		positions[numberOfPoint - 1] = length;
+	}
+	for (int i = 0; i < numberOfPoint / 2; i++)
+	{
+		positions[numberOfPoint - 1 - i] = length - positions[i];
+	}
+	return Grid(std::move(positions), std::vector<double>(std::max(numberOfPoint - 1, 0), D));
+}
+
+void Grid::setLayers(const std::vector<double> &interfaces, const std::vector<double> &diffusivities)
+{
+	if (diffusivities.size() != interfaces.size() + 1 || !std::is_sorted(interfaces.begin(), interfaces.end()))
+	{
+		throw std::invalid_argument("A layered wall needs increasing interfaces and one coefficient per layer");
+	}
+	for (double D : diffusivities)
+	{
+		if (!(D > 0))
+		{
+			throw std::invalid_argument("The coefficient of every layer must be positive");
+		}
+	}
+
+	for (std::size_t i = 0; i < g_diffusivity.size(); i++)
+	{
+		double middle = 0.5 * (g_position[i] + g_position[i + 1]);
+		std::size_t layer = std::upper_bound(interfaces.begin(), interfaces.end(), middle) - interfaces.begin();
+		g_diffusivity[i] = diffusivities[layer];
+	}
+}
+
+void Grid::operatorCoefficients(std::vector<double> &lower, std::vector<double> &upper) const
+{
+	int numberOfPoint = getNumberOfPoint();
+	lower.assign(numberOfPoint, 0.0);
+	upper.assign(numberOfPoint, 0.0);
+	for (int i = 1; i < numberOfPoint - 1; i++)
+	{
+		double left = g_position[i] - g_position[i - 1];
+		double right = g_position[i + 1] - g_position[i];
+		double volume = 0.5 * (left + right);
+		lower[i] = g_diffusivity[i - 1] / (left * volume);
+		upper[i] = g_diffusivity[i] / (right * volume);
+	}
+}
+
+double Grid::explicitTimeStepLimit() const
+{
+	std::vector<double> lower, upper;
+	operatorCoefficients(lower, upper);
+	double largest = 0;
+	for (int i = 1; i < getNumberOfPoint() - 1; i++)
+	{
+		largest = std::max(largest, lower[i] + upper[i]);
+	}
+	return 1 / largest;
+}
+
+// Get functions
+int Grid::getNumberOfPoint() const
+{
+	return g_position.size();
+}
+
+double Grid::getLength() const
+{
+	return g_position.back();
+}
+
+double Grid::getSmallestStep() const
+{
+	double smallest = g_position[1] - g_position[0];
+	for (std::size_t i = 1; i + 1 < g_position.size(); i++)
+	{
+		smallest = std::min(smallest, g_position[i + 1] - g_position[i]);
+	}
+	return smallest;
+}
+
+const std::vector<double> &Grid::getPositions() const
+{
+	return g_position;
+}
+
+const std::vector<double> &Grid::getDiffusivity() const
+{
+	return g_diffusivity;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#ifndef GRID_H
+#define GRID_H
+
+#include <vector>
+
+/**
+ * @class Grid
+ * @brief This class describes a 1D wall discretized on any increasing set of points, with a coefficient D per cell
+ *
+ * Point i is at x_i (x_0 = 0, x_{N-1} = L) and cell i, between x_i and x_{i+1}, has the coefficient D_i, so a
+ * stretched mesh can cluster its points where the gradients are steep (near the surfaces) and a layered wall can
+ * give each layer its own D. The heat equation is discretized by finite volumes: the flux through cell i is
+ * D_i (T_{i+1} - T_i) / (x_{i+1} - x_i) and point i owns half of its two cells, which gives
+ *   dT_i/dt = lower_i T_{i-1} - (lower_i + upper_i) T_i + upper_i T_{i+1}
+ *   lower_i = D_{i-1} / (h_{i-1} V_i), upper_i = D_i / (h_i V_i), h_i = x_{i+1} - x_i, V_i = (h_{i-1} + h_i) / 2
+ * On a uniform grid with one D this is D (T_{i+1} - 2 T_i + T_{i-1}) / deltax^2, the operator of ExplicitMethods and
+ * ImplicitMethods. A layered wall is discretized exactly by its cells when a point lies on each interface.
+ */
+
+class Grid
+{
+private:
+	//! Attribute for the position of each point, increasing from 0
+	std::vector<double> g_position;
+	//! Attribute for the coefficient of each cell [x_i, x_{i+1}]
+	std::vector<double> g_diffusivity;
+
+public:
+	/**
+	 * @brief Builds a grid, throws std::invalid_argument unless the positions start at 0 and increase and every D is positive.
+	 * @param positions Position of each point, at least three
+	 * @param diffusivity Coefficient of each cell, one less than the points
+	 */
+	Grid(std::vector<double> positions, std::vector<double> diffusivity);
+
+	/**
+	 * @brief Uniform grid x_i = i deltax with one coefficient, the grid of ExplicitMethods and ImplicitMethods.
+	 */
+	static Grid uniform(double deltax, int numberOfPoint, double D);
+
+	/**
+	 * @brief Grid clustered towards both surfaces: x_i = L/2 (1 + tanh(s (2 i / (N - 1) - 1)) / tanh(s)).
+	 * The steps grow geometrically from the surfaces to the middle, by a factor of about cosh(s)^2 overall.
+	 * @param length Length L of the wall
+	 * @param numberOfPoint Total number of points
+	 * @param D Coefficient of every cell
+	 * @param stretching s, 0 for a uniform grid
+	 */
+	static Grid stretched(double length, int numberOfPoint, double D, double stretching);
+
+	/**
+	 * @brief Gives each layer of the wall its own coefficient: a cell takes the D of the layer that contains its middle.
+	 * @param interfaces Position of the end of each layer but the last one, increasing
+	 * @param diffusivities Coefficient of each layer, one more than the interfaces
+	 */
+	void setLayers(const std::vector<double> &interfaces, const std::vector<double> &diffusivities);
+
+	/**
+	 * @brief Coefficients of the discrete operator at every point (see the class description); entries 0 and N - 1,
+	 * the surfaces, are 0.
+	 * @param lower Receives lower_i, the coefficient of T_{i-1}
+	 * @param upper Receives upper_i, the coefficient of T_{i+1}
+	 */
+	void operatorCoefficients(std::vector<double> &lower, std::vector<double> &upper) const;
+
+	/**
+	 * @brief Largest stable time step of the FTCS step on this grid, min_i 1 / (lower_i + upper_i)
+	 * (deltax^2 / (2 D) on a uniform grid).
+	 */
+	double explicitTimeStepLimit() const;
+
+	//! Get Methods
+	int getNumberOfPoint() const;
+	double getLength() const;
+	//! Smallest distance between two neighbouring points
+	double getSmallestStep() const;
+	const std::vector<double> &getPositions() const;
+	const std::vector<double> &getDiffusivity() const;
+};
+#endif // GRID_H
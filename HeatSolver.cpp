@@ -0,0 +1,223 @@
+#include "HeatSolver.h"
+
+#include <utility>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+#include <limits>
+
+// Constructor
+HeatSolver::HeatSolver(Scheme scheme, HeatProblem problem, int numberOfThreads) : hs_scheme(scheme), hs_problem(std::move(problem)), hs_numberOfThreads(numberOfThreads)
+{
+	if (!isExplicit())
+	{
+		hs_implicit.setThreads(numberOfThreads);
+	}
+	start(nullptr);
+}
+
+bool HeatSolver::isExplicit() const
+{
+	return hs_scheme == Richardson || hs_scheme == DufortFrankel;
+}
+
+void HeatSolver::start(const SolverState *state)
+{
+	const HeatProblem &p = hs_problem;
+	if (isExplicit())
+	{
+		ExplicitMethods::Scheme scheme = hs_scheme == Richardson ? ExplicitMethods::Richardson : ExplicitMethods::DufortFrankel;
+		hs_explicit.start(scheme, p.deltax, p.numberOfPoint, p.tsurf, p.D, p.deltat, p.temperatureInit, state, hs_numberOfThreads);
+	}
+	else
+	{
+		ImplicitMethods::Scheme scheme = hs_scheme == Laasonen ? ImplicitMethods::Laasonen : ImplicitMethods::CrankNicholson;
+		hs_implicit.start(scheme, p.deltax, p.numberOfPoint, p.tsurf, p.D, p.deltat, p.temperatureInit, state);
+	}
+}
+
+void HeatSolver::reset()
+{
+	start(nullptr);
+}
+
+void HeatSolver::resume(const SolverState &state)
+{
+	start(&state);
+}
+
+void HeatSolver::writeCheckpoint(CheckpointWriter &writer)
+{
+	Precision precision = isExplicit() ? hs_explicit.getPrecision() : hs_implicit.getPrecision();
+	int levels = isExplicit() ? 2 : 1;
+	const HeatProblem &p = hs_problem;
+	CheckpointHeader header = CheckpointWriter::makeHeader(hs_scheme, getLevel(), p.numberOfPoint, levels, static_cast<int>(precision), p.deltax, p.deltat, p.D, p.tsurf);
+	if (isExplicit())
+	{
+		writer.write(header, hs_explicit.current(), hs_explicit.previous());
+	}
+	else
+	{
+		writer.write(header, hs_implicit.current(), {});
+	}
+}
+
+void HeatSolver::restart(const CheckpointReader &checkpoint)
+{
+	const CheckpointHeader &header = checkpoint.getHeader();
+	const HeatProblem &p = hs_problem;
+	if (header.scheme != static_cast<std::uint32_t>(hs_scheme) || header.numberOfPoint != static_cast<std::uint64_t>(p.numberOfPoint) || header.deltax != p.deltax ||
+		header.deltat != p.deltat || header.D != p.D || header.tsurf != p.tsurf)
+	{
+		throw std::invalid_argument("Checkpoint '" + checkpoint.getFileName() + "' was written by another scheme or problem");
+	}
+	if (header.precision > static_cast<std::uint32_t>(Precision::Float) || header.step > std::numeric_limits<int>::max() || (isExplicit() && (header.levels != 2 || header.step < 1)))
+	{
+		throw std::invalid_argument("Checkpoint '" + checkpoint.getFileName() + "' does not hold a state of this scheme");
+	}
+
+	//! Same precision as the interrupted run, so that its float levels come back exactly
+	Precision precision = static_cast<Precision>(header.precision);
+	SolverState state;
+	checkpoint.load(state);
+	startWithPrecision(precision, state);
+}
+
+void HeatSolver::setCheckpointing(CheckpointWriter *writer, int interval)
+{
+	if (writer && interval < 1)
+	{
+		throw std::invalid_argument("The checkpoint interval must be at least 1");
+	}
+	hs_checkpointWriter = writer;
+	hs_checkpointInterval = writer ? interval : 0;
+}
+
+int HeatSolver::stepSolver(int steps)
+{
+	return isExplicit() ? hs_explicit.step(steps) : hs_implicit.step(steps);
+}
+
+int HeatSolver::advance(int steps)
+{
+	if (!hs_checkpointWriter)
+	{
+		return stepSolver(steps);
+	}
+
+	//! Stop at every multiple of the interval: splitting the steps does not change the levels
+	int taken = 0;
+	while (taken < steps)
+	{
+		int chunk = std::min(steps - taken, hs_checkpointInterval - getLevel() % hs_checkpointInterval);
+		int done = stepSolver(chunk);
+		taken += done;
+		if (done > 0 && getLevel() % hs_checkpointInterval == 0)
+		{
+			writeCheckpoint(*hs_checkpointWriter);
+		}
+		if (done < chunk)
+		{
+			break;
+		}
+	}
+	return taken;
+}
+
+int HeatSolver::advanceTo(double t)
+{
+	//! t / deltat is 2.9999999999999996 for t = 0.3 and deltat = 0.1: the tolerance keeps the level of t
+	int target = static_cast<int>(t / hs_problem.deltat + 1e-9);
+	if (target < getLevel())
+	{
+		throw std::invalid_argument("Time " + std::to_string(t) + " is before the current time level");
+	}
+	return advance(target - getLevel());
+}
+
+std::span<const double> HeatSolver::temperature()
+{
+	return isExplicit() ? hs_explicit.current() : hs_implicit.current();
+}
+
+void HeatSolver::saveState(SolverState &state) const
+{
+	if (isExplicit())
+	{
+		hs_explicit.saveState(state);
+	}
+	else
+	{
+		hs_implicit.saveState(state);
+	}
+}
+
+void HeatSolver::setSteadyStateDetection(double tolerance, int checkInterval)
+{
+	hs_explicit.setSteadyStateDetection(tolerance, checkInterval);
+	hs_implicit.setSteadyStateDetection(tolerance, checkInterval);
+}
+
+void HeatSolver::setPrecision(Precision precision)
+{
+	//! The explicit levels change type and the implicit matrix is factorized again: restart from the current level
+	SolverState state;
+	saveState(state);
+	startWithPrecision(precision, state);
+}
+
+void HeatSolver::startWithPrecision(Precision precision, const SolverState &state)
+{
+	//! start may reject the precision (reduced precisions on several implicit threads) after dropping the run: keep it to go back to
+	SolverState running;
+	saveState(running);
+	Precision previous = isExplicit() ? hs_explicit.getPrecision() : hs_implicit.getPrecision();
+	hs_explicit.setPrecision(precision);
+	hs_implicit.setPrecision(precision);
+	try
+	{
+		start(&state);
+	}
+	catch (...)
+	{
+		hs_explicit.setPrecision(previous);
+		hs_implicit.setPrecision(previous);
+		start(&running);
+		throw;
+	}
+}
+
+void HeatSolver::setTemporalBlocking(int blockSteps, int tileWidth)
+{
+	if (!isExplicit())
+	{
+		throw std::invalid_argument("Temporal blocking only applies to the explicit schemes");
+	}
+	hs_explicit.setTemporalBlocking(blockSteps, tileWidth);
+}
+
+// Get functions
+HeatSolver::Scheme HeatSolver::getScheme() const
+{
+	return hs_scheme;
+}
+
+const HeatProblem &HeatSolver::getProblem() const
+{
+	return hs_problem;
+}
+
+int HeatSolver::getLevel() const
+{
+	return isExplicit() ? hs_explicit.getLevel() : hs_implicit.getLevel();
+}
+
+double HeatSolver::getTime() const
+{
+	return getLevel() * hs_problem.deltat;
+}
+
+bool HeatSolver::reachedSteadyState() const
+{
+	return isExplicit() ? hs_explicit.reachedSteadyState() : hs_implicit.reachedSteadyState();
+}
@@ -0,0 +1,196 @@
+#pragma once
+#ifndef HEATSOLVER_H
+#define HEATSOLVER_H
+
+#include <vector>
+#include <span>
+
+#include "ExplicitMethods.h"
+#include "ImplicitMethods.h"
+#include "SolverState.h"
+#include "Precision.h"
+#include "CheckpointWriter.h"
+#include "CheckpointReader.h"
+
+/**
+ * @struct HeatProblem
+ * @brief Description of a 1D heat problem: grid, coefficient, boundary temperature, time step and initial distribution
+ */
+
+struct HeatProblem
+{
+	//! Grid step and total number of points
+	double deltax = 0;
+	int numberOfPoint = 0;
+	//! Temperature at x=0 and x=L
+	double tsurf = 0;
+	//! Coefficient
+	double D = 0;
+	//! Time step
+	double deltat = 0;
+	//! Initial temperature distribution vector
+	std::vector<double> temperatureInit;
+};
+
+/**
+ * @class HeatSolver
+ * @brief This class advances one scheme of ExplicitMethods or ImplicitMethods on a workspace set up once
+ *
+ * The constructor sizes the time levels, loads the initial distribution and, for the implicit schemes, factorizes the
+ * matrix (ExplicitMethods::start, ImplicitMethods::start). advance and advanceTo then only take time steps: no
+ * allocation, no copy of the temperature and no new factorization, however the run is split into calls.
+ * temperature() points into the workspace.
+ *
+ * Time levels are counted from the initial distribution (level 0, time 0); the explicit schemes start at level 1, the
+ * FTCS step. The Methods of ExplicitMethods and ImplicitMethods return for a final time t the level t / deltat - 1
+ * (snapshotLevel), whereas advanceTo(t) reaches level t / deltat.
+ *
+ * writeCheckpoint saves the levels of the run to a file (CheckpointWriter) and restart continues from it, in this
+ * process or in a later one: the run then gives bit-for-bit the results of an uninterrupted one. setCheckpointing
+ * makes advance write a checkpoint every given number of time levels.
+ */
+
+class HeatSolver
+{
+public:
+	//! Time-stepping schemes
+	enum Scheme
+	{
+		Richardson,
+		DufortFrankel,
+		Laasonen,
+		CrankNicholson
+	};
+
+private:
+	//! Attribute for the scheme
+	Scheme hs_scheme;
+	//! Attribute for the problem, kept to restart from the initial distribution
+	HeatProblem hs_problem;
+	//! Attribute for the number of threads sharing the grid (explicit) or the tridiagonal solves (implicit)
+	int hs_numberOfThreads;
+	//! Attributes for the solvers of the explicit and of the implicit schemes, only the one of hs_scheme is started
+	ExplicitMethods hs_explicit;
+	ImplicitMethods hs_implicit;
+	//! Attributes for the periodic checkpoints: writer (not owned, null when disabled) and time levels between two of them
+	CheckpointWriter *hs_checkpointWriter = nullptr;
+	int hs_checkpointInterval = 0;
+
+	//! True for Richardson and Dufort-Frankel
+	bool isExplicit() const;
+
+	//! Takes time steps with the started solver, see advance
+	int stepSolver(int steps);
+
+	/**
+	 * @brief (Re)starts the selected solver from the initial distribution or from a saved state.
+	 * @param state If not null and state->step > 0, the run starts from it
+	 */
+	void start(const SolverState *state);
+
+	/**
+	 * @brief Switches both solvers to a precision and restarts from a state. When start rejects the precision,
+	 * the previous precision and the run in progress are restored before the exception is rethrown.
+	 * @param precision Storage and arithmetic precision
+	 * @param state State to start from (from the initial distribution when state.step is 0)
+	 */
+	void startWithPrecision(Precision precision, const SolverState &state);
+
+public:
+	/**
+	 * @brief Sets up the workspace of a scheme for a problem and loads its initial distribution.
+	 * @param scheme Time-stepping scheme
+	 * @param problem Problem to solve, moved in (pass std::move(problem) to avoid copying the initial distribution)
+	 * @param numberOfThreads Number of threads (default 1), see ExplicitMethods::start and ImplicitMethods::setThreads
+	 */
+	HeatSolver(Scheme scheme, HeatProblem problem, int numberOfThreads = 1);
+
+	/**
+	 * @brief Goes back to the initial distribution, on the same workspace.
+	 */
+	void reset();
+
+	/**
+	 * @brief Continues from a saved state of the same scheme and problem (see saveState).
+	 * @param state State saved by saveState or by a snapshot method of the same scheme
+	 */
+	void resume(const SolverState &state);
+
+	/**
+	 * @brief Writes the current time level (and the previous one for the three-level schemes) to a checkpoint file,
+	 * with the scheme, the precision, the grid and the time step of the run.
+	 * @param writer Checkpoint file, replaced atomically
+	 */
+	void writeCheckpoint(CheckpointWriter &writer);
+
+	/**
+	 * @brief Continues from a checkpoint of the same scheme and problem, in the precision it was written with.
+	 * Throws std::invalid_argument if the scheme, the grid, D, tsurf or the time step differ.
+	 * @param checkpoint Checkpoint written by writeCheckpoint
+	 */
+	void restart(const CheckpointReader &checkpoint);
+
+	/**
+	 * @brief Makes advance and advanceTo write a checkpoint each time they reach a multiple of interval time levels.
+	 * @param writer Checkpoint file, kept by the caller while enabled; nullptr disables the checkpoints
+	 * @param interval Number of time levels between two checkpoints, at least 1
+	 */
+	void setCheckpointing(CheckpointWriter *writer, int interval);
+
+	/**
+	 * @brief Takes a number of time steps.
+	 * @param steps Number of time steps, at least 0
+	 * @return Number of time steps taken, less than steps once the steady state is reached (see setSteadyStateDetection)
+	 */
+	int advance(int steps);
+
+	/**
+	 * @brief Takes time steps up to the last time level at or before t (to rounding: t = 0.3 with deltat = 0.1 is level 3).
+	 * @param t Time to reach, not before getTime()
+	 * @return Number of time steps taken
+	 */
+	int advanceTo(double t);
+
+	/**
+	 * @brief Temperature at the current time level, without copy in double precision.
+	 * The span points into the workspace: it is valid until the next advance, reset or resume.
+	 */
+	std::span<const double> temperature();
+
+	/**
+	 * @brief Copies the current time level (and the previous one for the three-level schemes) into state.
+	 * @param state Receives the state, to pass later to resume or to a snapshot method
+	 */
+	void saveState(SolverState &state) const;
+
+	/**
+	 * @brief Enables the steady-state detection of the scheme (see ExplicitMethods::setSteadyStateDetection and
+	 * ImplicitMethods::setSteadyStateDetection), from the next time step on.
+	 */
+	void setSteadyStateDetection(double tolerance, int checkInterval = 10);
+
+	/**
+	 * @brief Selects the precision of the scheme (see Precision.h). The run goes on from its current time level,
+	 * rounded to float when the new precision stores float levels. If the precision cannot be used with this solver
+	 * (reduced precisions on several implicit threads), std::invalid_argument is thrown and the run is left unchanged.
+	 * @param precision Storage and arithmetic precision
+	 */
+	void setPrecision(Precision precision);
+
+	/**
+	 * @brief Enables temporal blocking of the explicit schemes (see ExplicitMethods::setTemporalBlocking).
+	 * Throws std::invalid_argument for an implicit scheme.
+	 */
+	void setTemporalBlocking(int blockSteps, int tileWidth = 4096);
+
+	//! Get Methods
+	Scheme getScheme() const;
+	const HeatProblem &getProblem() const;
+	//! Current time level, counted from the initial distribution
+	int getLevel() const;
+	//! Time of the current time level, getLevel() * deltat
+	double getTime() const;
+	//! True once the steady-state detection stopped the run
+	bool reachedSteadyState() const;
+};
+#endif // HEATSOLVER_H
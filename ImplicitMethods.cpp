@@ -1,7 +1,16 @@
 #include "ImplicitMethods.h"
-#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-std::vector<double> ImplicitMethods::thomasAlgorithm(std::vector<double> x_n, std::vector<double> lower_diag, std::vector<double> diag, std::vector<double> upper_diag)
+#include "StencilKernels.h"
+#include "CsvExporter.h"
+#include "Instrumentation.h"
+
+using namespace StencilKernels;
+
+std::vector<double> ImplicitMethods::thomasAlgorithm(std::vector<double> x_n, const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag)
 {
 
 	//! The thomasAlgorithm function implements the Thomas algorithm (also known as the Tridiagonal Matrix Algorithm or TDMA)
@@ -16,44 +25,227 @@ std::vector<double> ImplicitMethods::thomasAlgorithm(std::vector<double> x_n, st
 	//! The function first checks that the sizes of x_n, lower_diag, diag, and upper_diag are compatible.
 
 	//! It then proceeds to perform the Thomas algorithm, which consists of a forward sweep and a back substitution.
-	//! In the forward sweep, it computes intermediate values diag_star and x_star, which are used to update x_n.
-	//! In the back substitution, it calculates the final solution for x_n.
+	//! The pivots of the forward sweep are computed by TridiagonalSolver::factorize, then both sweeps run in place on x_n.
 
 	//! The function returns the solution vector x_n, which now contains the solution to the tridiagonal system.
 
 	int size_of_x_n = x_n.size();
 
-	if (diag.size() != size_of_x_n || lower_diag.size() != size_of_x_n || upper_diag.size() != size_of_x_n)
+	if (diag.size() != static_cast<std::size_t>(size_of_x_n) || lower_diag.size() != static_cast<std::size_t>(size_of_x_n) || upper_diag.size() != static_cast<std::size_t>(size_of_x_n))
 	{
 		throw std::invalid_argument("Vectors x_n, diag, lower_diag, and  upper_diag must have the same size");
 	}
 
-	std::vector<double> diag_star(size_of_x_n, 0.0);
-	std::vector<double> x_star(size_of_x_n, 0.0);
+	TridiagonalSolver solver(lower_diag, diag, upper_diag);
+	solver.solve(x_n);
+
+	return x_n;
+};
+
+void ImplicitMethods::assembleDiagonals(int size, double coefficient, std::vector<double> &lower, std::vector<double> &diag, std::vector<double> &upper)
+{
+	//! assign reuses the capacity of the diagonals between calls
+	lower.assign(size, -coefficient);
+	diag.assign(size, 1 + 2 * coefficient);
+	upper.assign(size, -coefficient);
+
+	//! First and last rows have no lower / upper neighbour
+	lower[0] = 0;
+	upper[size - 1] = 0;
+};
+
+void ImplicitMethods::setSpatialOperator(BandedOperator::SpatialOrder order, BandedOperator::Boundary boundary)
+{
+	im_banded.setOperator(order, boundary);
+};
+
+void ImplicitMethods::setLinearSolver(BandedSolver::Backend backend)
+{
+	im_banded.setBackend(backend);
+};
+
+BandedSolver::Backend ImplicitMethods::getLinearSolver() const
+{
+	return im_bandedSolve ? im_banded.getBackend() : BandedSolver::Thomas;
+};
 
-	//! Modify the coefficients in the first row
-	diag_star[0] = upper_diag[0] / diag[0];
-	x_star[0] = x_n[0] / diag[0];
+void ImplicitMethods::setThreads(int numberOfThreads)
+{
+	if (numberOfThreads < 1)
+	{
+		throw std::invalid_argument("The number of threads must be at least 1");
+	}
 
-	//! Forward sweep
-	for (int i = 1; i < size_of_x_n; i++)
+	if (numberOfThreads == 1)
+	{
+		im_parallelSolver.reset();
+	}
+	else if (getThreads() != numberOfThreads)
 	{
-		double m = 1.0 / (diag[i] - lower_diag[i] * diag_star[i - 1]);
-		diag_star[i] = upper_diag[i] * m;
-		x_star[i] = (x_n[i] - lower_diag[i] * x_star[i - 1]) * m;
+		im_parallelSolver = std::make_shared<ParallelTridiagonalSolver>(std::make_shared<ThreadPool>(numberOfThreads));
 	}
+};
 
-	//! Back substitution
-	x_n[size_of_x_n - 1] = x_star[size_of_x_n - 1];
-	for (int i = size_of_x_n - 2; i >= 0; i--)
+void ImplicitMethods::setSteadyStateDetection(double tolerance, int checkInterval)
+{
+	if (tolerance < 0 || checkInterval < 1)
 	{
-		x_n[i] = x_star[i] - diag_star[i] * x_n[i + 1];
+		throw std::invalid_argument("The steady-state tolerance must be non-negative and checkInterval positive");
 	}
+	im_steadyTolerance = tolerance;
+	im_steadyInterval = checkInterval;
+};
 
-	return x_n;
+bool ImplicitMethods::reachedSteadyState() const
+{
+	return im_steadyReached;
+};
+
+double ImplicitMethods::getStopTime() const
+{
+	return im_stopTime;
+};
+
+int ImplicitMethods::getThreads() const
+{
+	return im_parallelSolver ? im_parallelSolver->threads() : 1;
+};
+
+void ImplicitMethods::setPrecision(Precision precision, int refinementSteps)
+{
+	if (refinementSteps < 1)
+	{
+		throw std::invalid_argument("A mixed-precision solve needs at least one refinement step");
+	}
+	im_precision = precision;
+	im_refinementSteps = refinementSteps;
+};
+
+Precision ImplicitMethods::getPrecision() const
+{
+	return im_precision;
+};
+
+void ImplicitMethods::factorizeSystem()
+{
+	HEAT_PROFILE_SCOPE("implicit.factorize");
+	if (im_bandedSolve)
+	{
+		if (im_precision != Precision::Double || im_parallelSolver)
+		{
+			throw std::invalid_argument("The banded solvers (setSpatialOperator, setLinearSolver) solve in double on one thread");
+		}
+		if (!im_bandedOperator)
+		{
+			//! Second-order Dirichlet system with a forced backend
+			im_banded.assemble(im_diagN_minus_1, im_diag, im_diagN_plus_1);
+		}
+		im_banded.factorize();
+	}
+	else if (im_precision != Precision::Double)
+	{
+		if (im_parallelSolver)
+		{
+			throw std::invalid_argument("The reduced precisions use the serial Thomas algorithm, select one thread");
+		}
+		im_floatSolver.factorize(im_diagN_minus_1, im_diag, im_diagN_plus_1);
+		im_matrixNorm = 0;
+		for (std::size_t i = 0; i < im_diag.size(); i++)
+		{
+			im_matrixNorm = std::max(im_matrixNorm, std::abs(im_diagN_minus_1[i]) + std::abs(im_diag[i]) + std::abs(im_diagN_plus_1[i]));
+		}
+	}
+	else if (im_parallelSolver)
+	{
+		im_parallelSolver->factorize(im_diagN_minus_1, im_diag, im_diagN_plus_1);
+	}
+	else
+	{
+		im_solver.factorize(im_diagN_minus_1, im_diag, im_diagN_plus_1);
+	}
 };
 
-std::vector<double> ImplicitMethods::laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, std::vector<double> temperatureInit)
+void ImplicitMethods::solveSystem(std::span<double> x)
+{
+	if (im_bandedSolve)
+	{
+		im_banded.solve(x);
+	}
+	else if (im_precision != Precision::Double)
+	{
+		solveReducedPrecision(x);
+	}
+	else if (im_parallelSolver)
+	{
+		im_parallelSolver->solve(x);
+	}
+	else
+	{
+		im_solver.solve(x);
+	}
+};
+
+void ImplicitMethods::solveReducedPrecision(std::span<double> x)
+{
+	HEAT_PROFILE_SCOPE("implicit.reduced_precision_solve");
+	int size = x.size();
+	if (im_precision == Precision::Mixed)
+	{
+		im_refinedRhs.assign(x.begin(), x.end());
+	}
+
+	//! First solution, entirely in float
+	im_floatCorrection.assign(x.begin(), x.end());
+	im_floatSolver.solve(im_floatCorrection);
+	std::copy(im_floatCorrection.begin(), im_floatCorrection.end(), x.begin());
+	if (im_precision != Precision::Mixed)
+	{
+		return;
+	}
+
+	//! Iterative refinement: the residual is computed in double, only the correction is solved in float
+	const double *lower = im_diagN_minus_1.data();
+	const double *diag = im_diag.data();
+	const double *upper = im_diagN_plus_1.data();
+	const double *b = im_refinedRhs.data();
+	for (int refinement = 0;; refinement++)
+	{
+		double residual = 0;
+		double largest = 0;
+		for (int i = 0; i < size; i++)
+		{
+			double product = diag[i] * x[i];
+			if (i > 0)
+			{
+				product += lower[i] * x[i - 1];
+			}
+			if (i < size - 1)
+			{
+				product += upper[i] * x[i + 1];
+			}
+			double r = b[i] - product;
+			im_floatCorrection[i] = r;
+			residual = std::max(residual, std::abs(r));
+			largest = std::max(largest, std::abs(x[i]));
+		}
+
+		//! Converged when the residual is at the rounding level of A x, the backward error of a double solve
+		//! (the test of LAPACK dsgesv, without its sqrt(n) factor since a row only has three terms)
+		if (residual <= 4 * std::numeric_limits<double>::epsilon() * im_matrixNorm * largest || refinement == im_refinementSteps)
+		{
+			break;
+		}
+
+		HEAT_PROFILE_COUNT("implicit.refinement_steps", 1);
+		im_floatSolver.solve(im_floatCorrection);
+		for (int i = 0; i < size; i++)
+		{
+			x[i] += im_floatCorrection[i];
+		}
+	}
+};
+
+std::vector<double> ImplicitMethods::laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit)
 {
 	//! This function, laasonenMethod, implements the Laasonen implicit method for solving a 1D heat conduction problem.
 	//! It calculates the temperature distribution at discrete points in a rod over time, using implicit finite-difference equations.
@@ -71,126 +263,449 @@ std::vector<double> ImplicitMethods::laasonenMethod(double deltax, int numberOfP
 	//! The method starts by initializing the diagonals and the initial temperature distribution.
 
 	//! It then performs time-stepping using the Laasonen implicit scheme.
-	//! At each time step, it updates the boundary conditions, applies the implicit method using the Thomas algorithm,
-	//! and proceeds to the next time step.
+	//! The matrix does not change in time, so it is factorized once; at each time step the boundary conditions
+	//! are added and the system is solved in place on the temperature vector.
 
 	//! Finally, it returns the temperature distribution at the end of the simulation.
 
-	//! Define theta constant and the number time of time step
-	double theta = D * (deltat / (deltax * deltax));
-	int numStep = static_cast<int>(t / deltat);
+	//! Fill out the initial vector, the three diagonals, and factorize the matrix once
+	start(Laasonen, deltax, numberOfPoint, tsurf, D, deltat, temperatureInit);
+
+	//! numStep - 1 time steps, the level of a single output time t
+	step(snapshotLevel(t, deltat, 0));
+
+	return im_temperatureL;
+};
+
+int ImplicitMethods::laasonenSteps(double theta, double tsurf, int numberOfPoint, int steps, double changeLimit, int level)
+{
+	HEAT_PROFILE_COUNT("laasonen.steps", steps);
+	for (int step = 0; step < steps; step++)
+	{
+		//! A check step solves a copy, so the previous level is still there when the solution is copied back
+		bool check = changeLimit > 0 && (level + step + 1) % im_steadyInterval == 0;
+		std::vector<double> &x = check ? im_rhs : im_temperatureL;
+		if (check)
+		{
+			im_rhs.assign(im_temperatureL.begin(), im_temperatureL.end());
+		}
+
+		//! Add boundary conditions for each time-step
+		{
+			HEAT_PROFILE_SCOPE("laasonen.boundary");
+			x[0] += theta * tsurf;				   // Left boundary Condition
+			x[numberOfPoint - 1] += theta * tsurf; // Right Boundary Condition
+		}
+		solveSystem(x);
+
+		if (check && copyMaxChange(im_rhs.data(), im_temperatureL.data(), numberOfPoint) <= changeLimit)
+		{
+			im_steadyReached = true;
+			return step + 1;
+		}
+	}
+	return steps;
+};
+
+std::vector<double> ImplicitMethods::crankNicholsonMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit)
+{
+	//! Fill out the initial vector, size the intermediary vector and factorize the tridiagonal matrix once
+	start(CrankNicholson, deltax, numberOfPoint, tsurf, D, deltat, temperatureInit);
+
+	//! Perform the Crank-Nicholson method
+	step(snapshotLevel(t, deltat, 0));
+
+	return im_temperatureCN;
+}
+
+void ImplicitMethods::assembleCrankNicholsonRhs(const std::vector<double> &temperatureLevel, double lambda, double tsurf, int numberOfPoint)
+{
+	HEAT_PROFILE_SCOPE("crank_nicholson.rhs_assembly");
+	double *calculus_vector = im_rhs.data();
+	const double *temperature = temperatureLevel.data();
+
+	//! First and last rows carry the boundary temperature
+	calculus_vector[0] = (1 - 2 * lambda) * temperature[1] + lambda * temperature[2] + lambda * (temperature[0] + tsurf);
+	//! Row i is centred on point i + 1
+	applyStencil1D(CrankNicolsonRhsStencil(lambda), nullptr, temperature + 1, calculus_vector, 1, numberOfPoint - 2);
+	int last = numberOfPoint - 2;
+	calculus_vector[last] = (1 - 2 * lambda) * temperature[last - 1] + lambda * temperature[last - 2] + lambda * (temperature[last] + tsurf);
+};
 
-	// clear the diagonal in case of an other call of this method without initialisation
-	im_diagN_minus_1.clear();
-	im_diag.clear();
-	im_diagN_plus_1.clear();
+int ImplicitMethods::crankNicholsonSteps(double lambda, double tsurf, int numberOfPoint, int steps, double changeLimit, int level)
+{
+	HEAT_PROFILE_COUNT("crank_nicholson.steps", steps);
+	for (int step = 0; step < steps; step++)
+	{
+		assembleCrankNicholsonRhs(im_temperatureCN, lambda, tsurf, numberOfPoint);
 
-	//! Fill out the initial vector
-	im_temperatureL = temperatureInit;
+		//! Use the Thomas algorithm to solve the tridiagonal system in place
+		solveSystem(im_rhs);
 
-	//! Fill out the three diagonals
+		//! Update the 'temperatureInit' vector for the next time step, measuring the change on check steps
+		double change = std::numeric_limits<double>::infinity();
+		{
+			HEAT_PROFILE_SCOPE("crank_nicholson.copy_back");
+			if (changeLimit > 0 && (level + step + 1) % im_steadyInterval == 0)
+			{
+				change = copyMaxChange(im_rhs.data(), im_temperatureCN.data() + 1, im_rhs.size());
+			}
+			else
+			{
+				std::copy(im_rhs.begin(), im_rhs.end(), im_temperatureCN.begin() + 1);
+			}
+		}
+		if (change <= changeLimit)
+		{
+			im_steadyReached = true;
+			return step + 1;
+		}
+	}
+	return steps;
+};
 
-	im_diagN_minus_1.push_back(0);
-	im_diag.push_back(1 + (2 * theta));
-	im_diagN_plus_1.push_back(-theta);
+void ImplicitMethods::start(Scheme scheme, double deltax, int numberOfPoint, double tsurf, double D, double deltat, const std::vector<double> &temperatureInit,
+							const SolverState *state)
+{
+	//! No run until the system is factorized, so that a failed start cannot be stepped
+	im_numberOfPoint = 0;
+	std::vector<double> &temperature = scheme == Laasonen ? im_temperatureL : im_temperatureCN;
+	bool resume = state && state->step > 0;
+	if (resume)
+	{
+		//! Resume: the two-level schemes only need the current level
+		if (state->current.size() != static_cast<std::size_t>(numberOfPoint))
+		{
+			throw std::invalid_argument("The saved state does not match numberOfPoint");
+		}
+		temperature.assign(state->current.begin(), state->current.end());
+	}
+	else
+	{
+		if (temperatureInit.size() != static_cast<std::size_t>(numberOfPoint))
+		{
+			throw std::invalid_argument("temperatureInit must have numberOfPoint values");
+		}
+		temperature.assign(temperatureInit.begin(), temperatureInit.end());
+	}
 
-	for (int i = 1; i < numberOfPoint - 1; i++)
+	//! Laasonen solves for all the points, Crank-Nicholson for points 1 .. N - 1 through im_rhs; with another operator,
+	//! both solve for all the points
+	im_bandedOperator = im_banded.changesOperator();
+	im_bandedSolve = im_banded.changesSolver();
+	if (im_bandedOperator)
+	{
+		im_coefficient = scheme == Laasonen ? D * (deltat / (deltax * deltax)) : D * (deltat / (2.0 * deltax * deltax));
+		im_banded.assemble(numberOfPoint, im_coefficient, tsurf, scheme == CrankNicholson);
+	}
+	else if (scheme == Laasonen)
+	{
+		im_coefficient = D * (deltat / (deltax * deltax));
+		assembleDiagonals(numberOfPoint, im_coefficient, im_diagN_minus_1, im_diag, im_diagN_plus_1);
+	}
+	else
 	{
-		im_diagN_minus_1.push_back(-theta);
-		im_diag.push_back(1 + (2 * theta));
-		im_diagN_plus_1.push_back(-theta);
+		im_coefficient = D * (deltat / (2.0 * deltax * deltax));
+		im_rhs.resize(numberOfPoint - 1);
+		assembleDiagonals(numberOfPoint - 1, im_coefficient, im_diagN_minus_1, im_diag, im_diagN_plus_1);
 	}
-	im_diagN_minus_1.push_back(-theta);
-	im_diag.push_back(1 + (2 * theta));
-	im_diagN_plus_1.push_back(0);
+	factorizeSystem();
+
+	im_scheme = scheme;
+	im_tsurf = tsurf;
+	im_deltat = deltat;
+	im_numberOfPoint = numberOfPoint;
+	im_level = resume ? state->step : 0;
+	im_steadyReached = false;
+	im_stopTime = im_level * deltat;
+};
 
-	//! resset of x_n at each time step
-	for (int step = 1; step < numStep; step++)
+int ImplicitMethods::step(int steps)
+{
+	if (im_numberOfPoint == 0)
 	{
-		//! Add boundary conditions for each time-step
-		im_temperatureL[0] += theta * tsurf;				 // Left boundary Condition
-		im_temperatureL[numberOfPoint - 1] += theta * tsurf; // Right Boundary Condition
-		im_temperatureL = ImplicitMethods::thomasAlgorithm(im_temperatureL, im_diagN_minus_1, im_diag, im_diagN_plus_1);
+		throw std::logic_error("start must be called before step");
+	}
+	if (steps < 0)
+	{
+		throw std::invalid_argument("The number of time steps must be non-negative");
+	}
+	//! Once steady, the temperature of the stop time is kept
+	if (im_steadyReached || steps == 0)
+	{
+		return 0;
 	}
 
-	return im_temperatureL;
+	double changeLimit = im_steadyTolerance * im_deltat;
+	int taken = 0;
+	if (im_bandedOperator)
+	{
+		std::vector<double> &temperature = im_scheme == Laasonen ? im_temperatureL : im_temperatureCN;
+		taken = im_banded.step(temperature, steps, changeLimit, im_level, im_steadyInterval, im_steadyReached);
+	}
+	else
+	{
+		taken = im_scheme == Laasonen ? laasonenSteps(im_coefficient, im_tsurf, im_numberOfPoint, steps, changeLimit, im_level)
+									  : crankNicholsonSteps(im_coefficient, im_tsurf, im_numberOfPoint, steps, changeLimit, im_level);
+	}
+	im_level += taken;
+	im_stopTime = im_level * im_deltat;
+	return taken;
 };
 
-std::vector<double> ImplicitMethods::crankNicholsonMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, std::vector<double> temperatureInit)
+std::span<const double> ImplicitMethods::current() const
 {
-	//! Define theta constant and the number of time steps
-	double lambda = D * (deltat / (2.0 * deltax * deltax));
-	int numStep = static_cast<int>(t / deltat);
+	const std::vector<double> &temperature = im_scheme == Laasonen ? im_temperatureL : im_temperatureCN;
+	return std::span<const double>(temperature.data(), im_numberOfPoint);
+};
 
-	//! Fill out the initial vector
-	im_temperatureCN = temperatureInit;
+int ImplicitMethods::getLevel() const
+{
+	return im_level;
+};
 
-	//! Create intermediary vector for calculations
-	std::vector<double> calculus_vector;
+void ImplicitMethods::saveState(SolverState &state) const
+{
+	std::span<const double> temperature = current();
+	state.step = im_level;
+	state.previous.clear();
+	state.current.assign(temperature.begin(), temperature.end());
+};
 
-	//! Clear the diagonal in case of another call to this method without initialization
-	im_diagN_minus_1.clear();
-	im_diag.clear();
-	im_diagN_plus_1.clear();
+void ImplicitMethods::runSnapshots(const std::vector<double> &outputTimes, const SnapshotObserver &observer, SolverState *state)
+{
+	//! Visit the output times in increasing order, each one only advances from the previous one
+	for (int index : snapshotOrder(outputTimes))
+	{
+		int target = snapshotLevel(outputTimes[index], im_deltat, 0);
+		if (target < im_level)
+		{
+			throw std::invalid_argument("Output time " + std::to_string(outputTimes[index]) + " is before the resumed state");
+		}
+		//! Once steady, step does not advance and the later output times get the temperature of the stop time
+		step(target - im_level);
 
-	//! Set up the tridiagonal matrix diagonals
-	im_diagN_minus_1.push_back(0);
-	im_diag.push_back(1 + 2 * lambda);
-	im_diagN_plus_1.push_back(-lambda);
+		if (observer)
+		{
+			HEAT_PROFILE_SCOPE("output.observer");
+			observer(outputTimes[index], current());
+		}
+	}
 
-	for (int i = 1; i < numberOfPoint - 2; i++)
+	//! Checkpoint for a later resume
+	if (state)
 	{
-		im_diagN_minus_1.push_back(-lambda);
-		im_diag.push_back(1 + 2 * lambda);
-		im_diagN_plus_1.push_back(-lambda);
+		saveState(*state);
 	}
+};
 
-	im_diagN_minus_1.push_back(-lambda);
-	im_diag.push_back(1 + 2 * lambda);
-	im_diagN_plus_1.push_back(0);
+void ImplicitMethods::laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+									 const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state)
+{
+	start(Laasonen, deltax, numberOfPoint, tsurf, D, deltat, temperatureInit, state);
+	runSnapshots(outputTimes, observer, state);
+};
 
-	//! Perform the Crank-Nicholson method
-	for (int step = 1; step < numStep; step++)
+std::vector<std::vector<double>> ImplicitMethods::laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+																 const std::vector<double> &temperatureInit, SolverState *state)
+{
+	std::vector<std::vector<double>> snapshots(outputTimes.size());
+	std::vector<int> order = snapshotOrder(outputTimes);
+	int next = 0;
+	laasonenMethod(deltax, numberOfPoint, tsurf, tinit, D, deltat, outputTimes, temperatureInit, [&](double, std::span<const double> temperature)
+				   { snapshots[order[next++]].assign(temperature.begin(), temperature.end()); }, state);
+	return snapshots;
+};
+
+void ImplicitMethods::crankNicholsonMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+										   const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state)
+{
+	start(CrankNicholson, deltax, numberOfPoint, tsurf, D, deltat, temperatureInit, state);
+	runSnapshots(outputTimes, observer, state);
+};
+
+std::vector<std::vector<double>> ImplicitMethods::crankNicholsonMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+																	   const std::vector<double> &temperatureInit, SolverState *state)
+{
+	std::vector<std::vector<double>> snapshots(outputTimes.size());
+	std::vector<int> order = snapshotOrder(outputTimes);
+	int next = 0;
+	crankNicholsonMethod(deltax, numberOfPoint, tsurf, tinit, D, deltat, outputTimes, temperatureInit, [&](double, std::span<const double> temperature)
+						 { snapshots[order[next++]].assign(temperature.begin(), temperature.end()); }, state);
+	return snapshots;
+};
+
+namespace
+{
+	//! Step sizes are deltat * 2^level with level in [ADAPTIVE_MIN_LEVEL, ADAPTIVE_MAX_LEVEL]
+	constexpr int ADAPTIVE_MIN_LEVEL = -30;
+	constexpr int ADAPTIVE_MAX_LEVEL = 20;
+}
+
+const TridiagonalSolver &ImplicitMethods::levelSolver(int level, int size, double coefficient)
+{
+	auto found = im_levelSolvers.find(level);
+	if (found == im_levelSolvers.end())
+	{
+		//! A step size is factorized the first time it is used, then reused whenever the run comes back to it
+		assembleDiagonals(size, coefficient, im_adaptiveLower, im_adaptiveDiag, im_adaptiveUpper);
+		found = im_levelSolvers.emplace(level, TridiagonalSolver(im_adaptiveLower, im_adaptiveDiag, im_adaptiveUpper)).first;
+	}
+	return found->second;
+};
+
+template <class Step>
+void ImplicitMethods::integrateAdaptive(std::vector<double> &temperature, int size, double coefficientPerDeltat, int order, double deltat, double t, double tolerance,
+										AdaptiveReport *report, const Step &step)
+{
+	if (!(tolerance > 0))
 	{
-		for (int i = 0; i < numberOfPoint - 1; i++)
+		throw std::invalid_argument("The tolerance of the adaptive time stepping must be positive");
+	}
+
+	//! Same final time as the fixed-deltat method, which takes numStep - 1 steps
+	int fixedSteps = std::max(0, static_cast<int>(t / deltat) - 1);
+
+	//! Time is counted in units of the smallest step, so that every step lands exactly and the run ends where the fixed-deltat run ends
+	const int shift = -ADAPTIVE_MIN_LEVEL;
+	long long end = static_cast<long long>(fixedSteps) << shift;
+	long long position = 0;
+
+	AdaptiveReport local;
+	local.fixedSteps = fixedSteps;
+	local.endTime = fixedSteps * deltat;
+	local.minDeltat = std::numeric_limits<double>::infinity();
+
+	//! Step doubling: the difference between one step and two half steps is (2^order - 1) times the local error of the half steps
+	double errorScale = 1.0 / ((1 << order) - 1);
+
+	im_levelSolvers.clear();
+	int level = 0;
+	while (position < end)
+	{
+		//! Largest step of the current level that does not pass the end
+		while (level > ADAPTIVE_MIN_LEVEL && (1LL << (level + shift)) > end - position)
 		{
-			if (i == 0)
-			{
-				calculus_vector.push_back((1 - 2 * lambda) * im_temperatureCN[i + 1] + lambda * im_temperatureCN[i + 2] + lambda * (im_temperatureCN[i] + tsurf));
-			}
-			else if (i == numberOfPoint - 2)
-			{
-				calculus_vector.push_back((1 - 2 * lambda) * im_temperatureCN[i - 1] + lambda * im_temperatureCN[i - 2] + lambda * (im_temperatureCN[i] + tsurf));
-			}
-			else
+			level--;
+		}
+		double levelDeltat = std::ldexp(deltat, level);
+
+		im_adaptiveFull = temperature;
+		step(im_adaptiveFull, coefficientPerDeltat * levelDeltat, levelSolver(level, size, coefficientPerDeltat * levelDeltat));
+		const TridiagonalSolver &halfSolver = levelSolver(level - 1, size, coefficientPerDeltat * levelDeltat / 2);
+		im_adaptiveHalf = temperature;
+		step(im_adaptiveHalf, coefficientPerDeltat * levelDeltat / 2, halfSolver);
+		step(im_adaptiveHalf, coefficientPerDeltat * levelDeltat / 2, halfSolver);
+		local.solves += 3;
+
+		double error = 0;
+		for (std::size_t i = 0; i < temperature.size(); i++)
+		{
+			error = std::max(error, std::abs(im_adaptiveHalf[i] - im_adaptiveFull[i]));
+		}
+		error *= errorScale;
+
+		if (error <= tolerance)
+		{
+			//! Keep the more accurate two half steps
+			temperature.swap(im_adaptiveHalf);
+			position += 1LL << (level + shift);
+			local.steps++;
+			local.minDeltat = std::min(local.minDeltat, levelDeltat);
+			local.maxDeltat = std::max(local.maxDeltat, levelDeltat);
+
+			//! Double the step when the error predicted for it (error grows as deltat^(order + 1)) is still within the tolerance, with a safety factor
+			if (level < ADAPTIVE_MAX_LEVEL && 0.9 * std::pow(tolerance / error, 1.0 / (order + 1)) >= 2.0)
 			{
-				calculus_vector.push_back(lambda * im_temperatureCN[i] + (1 - 2 * lambda) * im_temperatureCN[i + 1] + lambda * im_temperatureCN[i + 2]);
+				level++;
 			}
 		}
-
-		//! Use the Thomas algorithm to solve the tridiagonal system
-		calculus_vector = ImplicitMethods::thomasAlgorithm(calculus_vector, im_diagN_minus_1, im_diag, im_diagN_plus_1);
-
-		//! Update the 'temperatureInit' vector for the next time step
-		for (int j = 0; j < calculus_vector.size(); j++)
+		else
 		{
-			im_temperatureCN[j + 1] = calculus_vector[j];
+			local.rejectedSteps++;
+			if (level == ADAPTIVE_MIN_LEVEL)
+			{
+				throw std::runtime_error("Adaptive time stepping: the tolerance cannot be met with deltat / 2^" + std::to_string(shift));
+			}
+			level--;
 		}
+	}
 
-		//! Clear the intermediary vector for the next iteration
-		calculus_vector.clear();
+	local.factorizations = im_levelSolvers.size();
+	if (local.steps == 0)
+	{
+		local.minDeltat = 0;
+	}
+	if (report)
+	{
+		*report = local;
 	}
+};
 
-	return im_temperatureCN;
-}
+std::vector<double> ImplicitMethods::laasonenMethodAdaptive(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit,
+															double tolerance, AdaptiveReport *report)
+{
+	if (temperatureInit.size() != static_cast<std::size_t>(numberOfPoint))
+	{
+		throw std::invalid_argument("temperatureInit must have numberOfPoint values");
+	}
+	im_adaptiveTemperature = temperatureInit;
+
+	//! theta = D deltat / deltax^2 for each step size
+	integrateAdaptive(im_adaptiveTemperature, numberOfPoint, D / (deltax * deltax), 1, deltat, t, tolerance, report,
+					  [&](std::vector<double> &temperature, double theta, const TridiagonalSolver &solver)
+					  {
+						  temperature[0] += theta * tsurf;
+						  temperature[numberOfPoint - 1] += theta * tsurf;
+						  solver.solve(temperature);
+					  });
+	return im_adaptiveTemperature;
+};
 
-void ImplicitMethods::saveCSV(std::string e_fileName, std::vector<double> temperature)
+std::vector<double> ImplicitMethods::crankNicholsonMethodAdaptive(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit,
+																  double tolerance, AdaptiveReport *report)
 {
-	std::ofstream myfile;
-	myfile.open(e_fileName);
-	for (int i = 0; i < temperature.size(); i++)
+	if (temperatureInit.size() != static_cast<std::size_t>(numberOfPoint))
 	{
-		myfile << temperature[i] << "\n";
+		throw std::invalid_argument("temperatureInit must have numberOfPoint values");
 	}
-	myfile.close();
-};
\ No newline at end of file
+	im_adaptiveTemperature = temperatureInit;
+
+	//! Unknowns are the points 1 to numberOfPoint - 2 and both ends keep their temperature. The last row of crankNicholsonMethod
+	//! is centred on point numberOfPoint - 3 whatever deltat, so its solution has no limit as deltat decreases and step doubling
+	//! cannot estimate its error; here the last row is centred on point numberOfPoint - 2 like the other rows.
+	int size = numberOfPoint - 2;
+	im_adaptiveRhs.resize(size);
+
+	//! lambda = D deltat / (2 deltax^2) for each step size
+	integrateAdaptive(im_adaptiveTemperature, size, D / (2.0 * deltax * deltax), 2, deltat, t, tolerance, report,
+					  [&](std::vector<double> &temperature, double lambda, const TridiagonalSolver &solver)
+					  {
+						  const double *level = temperature.data();
+						  double *rhs = im_adaptiveRhs.data();
+						  int last = size - 1;
+						  rhs[0] = (1 - 2 * lambda) * level[1] + lambda * level[2] + lambda * (level[0] + tsurf);
+						  applyStencil1D(CrankNicolsonRhsStencil(lambda), nullptr, level + 1, rhs, 1, last);
+						  rhs[last] = (1 - 2 * lambda) * level[last + 1] + lambda * level[last] + lambda * (level[last + 2] + tsurf);
+						  solver.solve(im_adaptiveRhs);
+						  std::copy(im_adaptiveRhs.begin(), im_adaptiveRhs.end(), temperature.begin() + 1);
+					  });
+	return im_adaptiveTemperature;
+};
+
+std::vector<std::vector<double>> ImplicitMethods::laasonenMethodBatch(double deltax, int numberOfPoint, const std::vector<double> &tsurf, double D, double deltat, double t, const std::vector<std::vector<double>> &temperatureInits)
+{
+	//! Same scheme as laasonenMethod, with the K members interleaved so that one pair of sweeps advances all of them
+	return im_ensemble.solve(EnsembleMethods::Laasonen, deltax, numberOfPoint, tsurf, D, deltat, t, temperatureInits);
+};
+
+std::vector<std::vector<double>> ImplicitMethods::crankNicholsonMethodBatch(double deltax, int numberOfPoint, const std::vector<double> &tsurf, double D, double deltat, double t, const std::vector<std::vector<double>> &temperatureInits)
+{
+	//! Same scheme as crankNicholsonMethod, with the K members interleaved
+	return im_ensemble.solve(EnsembleMethods::CrankNicholson, deltax, numberOfPoint, tsurf, D, deltat, t, temperatureInits);
+};
+
+void ImplicitMethods::saveCSV(const std::string &fileName, const std::vector<double> &temperature)
+{
+	CsvExporter::write(fileName, temperature);
+};
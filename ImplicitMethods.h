@@ -5,15 +5,52 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <memory>
+#include <span>
+#include <map>
+
+#include "TridiagonalSolver.h"
+#include "BandedOperator.h"
+#include "EnsembleMethods.h"
+#include "ParallelTridiagonalSolver.h"
+#include "SolverState.h"
+#include "Precision.h"
 
 /**
  * @class ImplicitMethods
- * @brief This class employs Laasonen and Cranck-Nicholson explicit schemes to solve the 1D heat equation
+ * @brief This class employs Laasonen and Crank-Nicholson implicit schemes to solve the 1D heat equation
  *
  */
 
 class ImplicitMethods
 {
+public:
+    //! Schemes of a run set up by start
+    enum Scheme
+    {
+        Laasonen,
+        CrankNicholson
+    };
+
+    //! Work done by an adaptive run and by the fixed-deltat run it replaces
+    struct AdaptiveReport
+    {
+        //! Accepted and rejected steps
+        int steps = 0;
+        int rejectedSteps = 0;
+        //! Tridiagonal solves (three per tried step: one full step and two half steps)
+        long solves = 0;
+        //! Distinct step sizes factorized
+        int factorizations = 0;
+        //! Steps, and solves, of the fixed-deltat method
+        int fixedSteps = 0;
+        //! Smallest and largest accepted step
+        double minDeltat = 0;
+        double maxDeltat = 0;
+        //! Final time reached
+        double endTime = 0;
+    };
+
 private:
     //! Attribute for data storage for lower diagonal coefficient
     std::vector<double> im_diagN_minus_1;
@@ -25,11 +62,224 @@ private:
     std::vector<double> im_temperatureL;
     //! Attribute for storing Crank-Nicholson resulting temperature data.
     std::vector<double> im_temperatureCN;
+    //! Attribute for storing the Crank-Nicholson right-hand side, sized once per call
+    std::vector<double> im_rhs;
+    //! Attribute for the factorized tridiagonal matrix, reused at every time step
+    TridiagonalSolver im_solver;
+    //! Attribute for the partitioned Thomas solver, only set when more than one thread is selected
+    std::shared_ptr<ParallelTridiagonalSolver> im_parallelSolver;
+    //! Attribute for the precision of the solves of laasonenMethod and crankNicholsonMethod
+    Precision im_precision = Precision::Double;
+    //! Attribute for the largest number of refinement steps of a Precision::Mixed solve
+    int im_refinementSteps = 8;
+    //! Attribute for the float factorization of the reduced precisions, and the infinity norm of the matrix
+    BasicTridiagonalSolver<float> im_floatSolver;
+    double im_matrixNorm = 0;
+    //! Attribute for the right-hand side of a refined solve
+    std::vector<double> im_refinedRhs;
+    //! Attribute for the float right-hand side, then correction, of a reduced-precision solve
+    std::vector<float> im_floatCorrection;
+    //! Attribute for the interleaved storage and batched solves of the batch methods
+    EnsembleMethods im_ensemble;
+    //! Attribute for the factorizations of each step size of an adaptive run, keyed by level (deltat * 2^level)
+    std::map<int, TridiagonalSolver> im_levelSolvers;
+    //! Attributes for the one-step and two-half-steps trial solutions of an adaptive step
+    std::vector<double> im_adaptiveFull;
+    std::vector<double> im_adaptiveHalf;
+    //! Attributes for the temperature, the Crank-Nicholson right-hand side and the diagonals of an adaptive run, apart
+    //! from those of the run set up by start
+    std::vector<double> im_adaptiveTemperature;
+    std::vector<double> im_adaptiveRhs;
+    std::vector<double> im_adaptiveLower;
+    std::vector<double> im_adaptiveDiag;
+    std::vector<double> im_adaptiveUpper;
+    //! Attribute for the steady-state tolerance on max |dT/dt|, 0 disables the detection
+    double im_steadyTolerance = 0;
+    //! Attribute for the number of time steps between two convergence checks
+    int im_steadyInterval = 10;
+    //! Attributes for the outcome of the last run: steady state reached, and time of the returned temperature
+    bool im_steadyReached = false;
+    double im_stopTime = 0;
+    //! Attributes for the run set up by start: scheme, grid size (0 before the first start), off-diagonal coefficient
+    //! (theta or lambda), boundary temperature, time step and time level of the temperature
+    Scheme im_scheme = Laasonen;
+    int im_numberOfPoint = 0;
+    double im_coefficient = 0;
+    double im_tsurf = 0;
+    double im_deltat = 0;
+    int im_level = 0;
+    //! Attribute for the spatial operator and the linear-solver backend of setSpatialOperator and setLinearSolver
+    BandedOperator im_banded;
+    //! Attributes for the run set up by start: im_banded takes the steps (another operator than the second-order
+    //! Dirichlet one), and im_banded solves the systems instead of the tridiagonal solvers
+    bool im_bandedOperator = false;
+    bool im_bandedSolve = false;
+
+    /**
+     * @brief Fills the three diagonals of the (1 + 2c, -c) matrix shared by Laasonen and Crank-Nicholson.
+     * @param size Number of unknowns of the system
+     * @param coefficient Off-diagonal coefficient c (theta for Laasonen, lambda for Crank-Nicholson)
+     * @param lower Lower diagonal
+     * @param diag Diagonal
+     * @param upper Upper diagonal
+     */
+    void assembleDiagonals(int size, double coefficient, std::vector<double> &lower, std::vector<double> &diag, std::vector<double> &upper);
+
+    /**
+     * @brief Factorizes the assembled diagonals with the selected solver (serial or partitioned Thomas, or the banded
+     * backend when one is in use).
+     */
+    void factorizeSystem();
+
+    /**
+     * @brief Solves the factorized system in place with the selected solver.
+     * @param x Right-hand side / solution
+     */
+    void solveSystem(std::span<double> x);
+
+    /**
+     * @brief Solves the assembled system with the float factorization. With Precision::Mixed, the solution is then
+     * refined in double: r = b - A x with the double diagonals, A d = r solved in float, x += d, until |r| is at the
+     * rounding level of |A| |x| or after im_refinementSteps corrections.
+     * @param x Right-hand side / solution
+     */
+    void solveReducedPrecision(std::span<double> x);
+
+    /**
+     * @brief Takes Laasonen time steps on im_temperatureL with the factorized (1 + 2 theta, -theta) matrix.
+     * When changeLimit > 0, the steps that produce a level multiple of im_steadyInterval are solved in im_rhs and copied
+     * back while measuring the largest change, and the loop stops once it is at most changeLimit.
+     * @param theta Coefficient D deltat / deltax^2
+     * @param tsurf Temperature at x=0 and x=L
+     * @param numberOfPoint Total number of points to discretize
+     * @param steps Number of time steps
+     * @param changeLimit Largest change per step of a steady level (im_steadyTolerance * deltat), 0 for no detection
+     * @param level Time level of im_temperatureL, so that a run split into several calls checks the same levels
+     * @return Number of time steps taken
+     */
+    int laasonenSteps(double theta, double tsurf, int numberOfPoint, int steps, double changeLimit, int level);
+
+    /**
+     * @brief Takes Crank-Nicholson time steps on im_temperatureCN with the factorized (1 + 2 lambda, -lambda) matrix.
+     * When changeLimit > 0, the copy of the solution measures the largest change on the steps that produce a level multiple
+     * of im_steadyInterval, and the loop stops once it is at most changeLimit.
+     * @param lambda Coefficient D deltat / (2 deltax^2)
+     * @param tsurf Temperature at x=0 and x=L
+     * @param numberOfPoint Total number of points to discretize
+     * @param steps Number of time steps
+     * @param changeLimit Largest change per step of a steady level (im_steadyTolerance * deltat), 0 for no detection
+     * @param level Time level of im_temperatureCN, so that a run split into several calls checks the same levels
+     * @return Number of time steps taken
+     */
+    int crankNicholsonSteps(double lambda, double tsurf, int numberOfPoint, int steps, double changeLimit, int level);
+
+    /**
+     * @brief Fills im_rhs with the Crank-Nicholson right-hand side of a temperature level (N - 1 rows for points 1 .. N - 1).
+     * @param temperatureLevel Temperature at the current time level
+     * @param lambda Coefficient D deltat / (2 deltax^2)
+     * @param tsurf Temperature at x=0 and x=L
+     * @param numberOfPoint Total number of points to discretize
+     */
+    void assembleCrankNicholsonRhs(const std::vector<double> &temperatureLevel, double lambda, double tsurf, int numberOfPoint);
+
+    /**
+     * @brief Factorized (1 + 2c, -c) matrix of a step size deltat * 2^level, factorized on first use.
+     * @param level Step size level
+     * @param size Number of unknowns of the system
+     * @param coefficient Off-diagonal coefficient c for this step size
+     */
+    const TridiagonalSolver &levelSolver(int level, int size, double coefficient);
+
+    /**
+     * @brief Adaptive time loop shared by the two implicit schemes (step doubling, step sizes deltat * 2^level).
+     * @param temperature Temperature advanced in place from t=0 to the final time of the fixed-deltat method
+     * @param size Number of unknowns of the system
+     * @param coefficientPerDeltat Off-diagonal coefficient divided by the step size
+     * @param order Order in time of the scheme (1 for Laasonen, 2 for Crank-Nicholson)
+     * @param deltat Initial step size, also the step of the fixed-deltat method the run is compared with
+     * @param t Total simulation time
+     * @param tolerance Largest accepted local error estimate per step, in temperature units
+     * @param report If not null, receives the step counts
+     * @param step Callable (temperature, coefficient, solver) taking one step
+     */
+    template <class Step>
+    void integrateAdaptive(std::vector<double> &temperature, int size, double coefficientPerDeltat, int order, double deltat, double t, double tolerance,
+                           AdaptiveReport *report, const Step &step);
+
+    /**
+     * @brief Advances the started run to every output time (in increasing order) and calls the observer there.
+     * @param outputTimes Times at which the observer is called
+     * @param observer Called with each output time and the temperature at that time
+     * @param state If not null, filled with the final state on return
+     */
+    void runSnapshots(const std::vector<double> &outputTimes, const SnapshotObserver &observer, SolverState *state);
 
 public:
+    /**
+     * @brief Selects the tridiagonal solver used by laasonenMethod and crankNicholsonMethod.
+     * @param numberOfThreads 1 (default) keeps the serial Thomas algorithm, more threads use the partitioned Thomas algorithm
+     */
+    void setThreads(int numberOfThreads);
+
+    //! Number of threads used by the tridiagonal solves
+    int getThreads() const;
+
+    /**
+     * @brief Selects the precision of the solves of laasonenMethod and crankNicholsonMethod (single time and snapshots).
+     * Precision::Mixed solves with a float factorization and refines the solution in double (iterative refinement),
+     * which keeps the result at double accuracy; Precision::Float stops after the float solve. The temperature is
+     * always stored as double. The reduced precisions use the serial Thomas algorithm (setThreads(1)); the adaptive
+     * and batch methods always solve in double.
+     * @param precision Precision of the solves, Precision::Double by default
+     * @param refinementSteps Largest number of refinement steps of a Precision::Mixed solve
+     */
+    void setPrecision(Precision precision, int refinementSteps = 8);
+
+    //! Precision of the solves of the next runs
+    Precision getPrecision() const;
+
+    /**
+     * @brief Selects the spatial operator of the runs set up by start (single time, snapshots and incremental runs).
+     * Any other operator than the second-order Dirichlet one (default) solves for all the points of the rod with
+     * tsurf just outside both ends, the layout of laasonenMethod, for both schemes: the fourth-order stencil gives
+     * five-band systems (next to each end, the point outside the boundary is the odd reflection 2 tsurf - T), and the
+     * periodic rod cyclic ones (see BandedOperator). Those systems go through BandedSolver, in double on one thread.
+     * The adaptive and batch methods keep the second-order Dirichlet operator.
+     * @param order Approximation of d2T/dx2
+     * @param boundary Boundary conditions
+     */
+    void setSpatialOperator(BandedOperator::SpatialOrder order, BandedOperator::Boundary boundary);
+
+    /**
+     * @brief Selects the backend of the banded systems. Automatic (default) chooses it from the structure of the
+     * matrix: Thomas, CyclicThomas (periodic second order), Pentadiagonal (fourth order) or Multigrid (periodic fourth
+     * order). Forcing a backend also routes the second-order Dirichlet systems through BandedSolver, which then
+     * solves in double on one thread.
+     * @param backend Backend of BandedSolver
+     */
+    void setLinearSolver(BandedSolver::Backend backend);
+
+    //! Backend of the started run (Thomas for the serial and partitioned tridiagonal solvers)
+    BandedSolver::Backend getLinearSolver() const;
+
+    /**
+     * @brief Enables the steady-state detection of laasonenMethod and crankNicholsonMethod: every checkInterval steps,
+     * max_i |T_i^{n+1} - T_i^n| / deltat is measured while the solution is copied, and the run stops when it is at most
+     * tolerance. The result is then the temperature at the stop time (getStopTime); later output times of a snapshot
+     * run get that same temperature. The adaptive and batch methods do not use it.
+     * @param tolerance Largest rate of change of a steady profile, in temperature units per time unit; 0 disables the detection (default)
+     * @param checkInterval Number of time steps between two checks
+     */
+    void setSteadyStateDetection(double tolerance, int checkInterval = 10);
+
+    //! True when the last run stopped at a steady state
+    bool reachedSteadyState() const;
+    //! Time of the temperature returned by the last run (its final time when no steady state was detected)
+    double getStopTime() const;
 
     /**
      * @brief This function applies the thomas algorithm to solve tridiagonal system equation
+     * One-shot convenience wrapper around TridiagonalSolver; time loops should factorize once and call TridiagonalSolver::solve.
      * @param  x_n Right part matrix of the system
      * @param lower_diag Lower diagonal of the tridiagonal matrix
      * @param diag Diagonal of the tridiagonal matrix
@@ -37,11 +287,50 @@ public:
      * @return The solution vector of the systeme
     */
     // Thomas algorithm resolution: takes a vector T^{n} and return the vector T^{n+1}
-    std::vector<double> thomasAlgorithm(std::vector<double> x_n, std::vector<double> lower_diag, std::vector<double> diag, std::vector<double> upper_diag);
+    std::vector<double> thomasAlgorithm(std::vector<double> x_n, const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag);
+
+    //! Incremental Methods
+    /**
+     * @brief Sets up a run that step then advances: loads the initial distribution (or a saved state), assembles the
+     * matrix and factorizes it once with the selected threads and precision. The vectors keep their capacity, so a
+     * new start on the same grid does not allocate. The adaptive methods have their own buffers and the batch methods
+     * go through EnsembleMethods, so neither changes the started run.
+     * @param scheme Scheme of the run
+     * @param deltax Grid step.
+     * @param numberOfPoint Total number of points to discretize.
+     * @param tsurf  Temperature at x=0 and x=L
+     * @param D Coefficient.
+     * @param deltat Time step.
+     * @param temperatureInit Initial temperature distribution vector (ignored when resuming).
+     * @param state If not null and state->step > 0, the run starts from it.
+     */
+    void start(Scheme scheme, double deltax, int numberOfPoint, double tsurf, double D, double deltat, const std::vector<double> &temperatureInit,
+               const SolverState *state = nullptr);
+
+    /**
+     * @brief Advances the started run by a number of time steps in place, with the factorization of start.
+     * @param steps Number of time steps
+     * @return Number of time steps taken, less than steps once the steady state is reached (then 0 until the next start)
+     */
+    int step(int steps);
+
+    /**
+     * @brief Temperature at the current time level of the started run; the span points into the solver workspace and
+     * is valid until the next step or start.
+     */
+    std::span<const double> current() const;
+
+    //! Time level of the started run (0 after a start from the initial distribution)
+    int getLevel() const;
+
+    /**
+     * @brief Copies the current level of the started run into state, for a later start from it.
+     */
+    void saveState(SolverState &state) const;
 
     //! Methods
     /**
-     * @brief This function utilizes the Dufort-Frankel scheme to solve the 1D heat equation using the Thomas algorithm.
+     * @brief This function utilizes the Laasonen scheme to solve the 1D heat equation using the Thomas algorithm.
      * @param deltax Grid step.
      * @param numberOfPoint Total number of points to discretize.
      * @param tsurf  Temperature at x=0 and x=L
@@ -53,11 +342,11 @@ public:
      * @return The final temperature distribution at time t.
      */
 
-    std::vector<double> laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, std::vector<double> temperatureInit);
+    std::vector<double> laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit);
 
     //! Methods
     /**
-     * @brief This function utilizes the Crank-Nichoslon scheme to solve the 1D heat equation using the Thomas algorithm.
+     * @brief This function utilizes the Crank-Nicholson scheme to solve the 1D heat equation using the Thomas algorithm.
      * @param deltax Grid step.
      * @param numberOfPoint Total number of points to discretize.
      * @param tsurf  Temperature at x=0 and x=L
@@ -68,15 +357,131 @@ public:
      * @param temperatureInit Initial temperature distribution vector.
      * @return The final temperature distribution at time t.
      */
-    std::vector<double> crankNicholsonMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, std::vector<double> temperatureInit);
+    std::vector<double> crankNicholsonMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit);
+
+    //! Snapshot Methods
+    /**
+     * @brief Laasonen scheme with several output times computed in a single forward run.
+     * The temperature passed for time t is identical to laasonenMethod(..., t, ...).
+     * @param deltax Grid step.
+     * @param numberOfPoint Total number of points to discretize.
+     * @param tsurf  Temperature at x=0 and x=L
+     * @param tinit Temperature at t=0
+     * @param D Coefficient.
+     * @param deltat Time step.
+     * @param outputTimes Times at which the temperature is reported.
+     * @param temperatureInit Initial temperature distribution vector.
+     * @param observer Called with each output time (in increasing order) and the temperature at that time.
+     * @param state If not null, resumes from it when state->step > 0 and receives the final state (checkpoint).
+     */
+    void laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                        const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state = nullptr);
+
+    /**
+     * @brief Same as the observer version, returning one temperature distribution per output time (in the order given).
+     */
+    std::vector<std::vector<double>> laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                                                    const std::vector<double> &temperatureInit, SolverState *state = nullptr);
+
+    /**
+     * @brief Crank-Nicholson scheme with several output times computed in a single forward run.
+     * The temperature passed for time t is identical to crankNicholsonMethod(..., t, ...).
+     * @param deltax Grid step.
+     * @param numberOfPoint Total number of points to discretize.
+     * @param tsurf  Temperature at x=0 and x=L
+     * @param tinit Temperature at t=0
+     * @param D Coefficient.
+     * @param deltat Time step.
+     * @param outputTimes Times at which the temperature is reported.
+     * @param temperatureInit Initial temperature distribution vector.
+     * @param observer Called with each output time (in increasing order) and the temperature at that time.
+     * @param state If not null, resumes from it when state->step > 0 and receives the final state (checkpoint).
+     */
+    void crankNicholsonMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                              const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state = nullptr);
+
+    /**
+     * @brief Same as the observer version, returning one temperature distribution per output time (in the order given).
+     */
+    std::vector<std::vector<double>> crankNicholsonMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+                                                          const std::vector<double> &temperatureInit, SolverState *state = nullptr);
+
+    //! Adaptive Methods
+    /**
+     * @brief Laasonen scheme with a step size controlled by step doubling: each step is compared with two half steps,
+     * rejected and halved when the local error estimate exceeds the tolerance, doubled when it is well below.
+     * Step sizes are deltat * 2^k (k from -30 to 20), so each size is factorized once and the run ends exactly at the
+     * final time of laasonenMethod, (t / deltat - 1) deltat.
+     * @param deltax Grid step.
+     * @param numberOfPoint Total number of points to discretize.
+     * @param tsurf  Temperature at x=0 and x=L
+     * @param tinit Temperature at t=0
+     * @param D Coefficient.
+     * @param deltat Initial time step.
+     * @param t Total simulation time.
+     * @param temperatureInit Initial temperature distribution vector.
+     * @param tolerance Largest accepted local error estimate per step, in temperature units.
+     * @param report If not null, receives the numbers of steps, solves and factorizations, and those of the fixed-deltat run.
+     * @return The final temperature distribution.
+     */
+    std::vector<double> laasonenMethodAdaptive(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit,
+                                               double tolerance, AdaptiveReport *report = nullptr);
+
+    /**
+     * @brief Crank-Nicholson scheme with a step size controlled by step doubling, see laasonenMethodAdaptive.
+     * Both end points keep their initial temperature. The last row of crankNicholsonMethod is centred on the third
+     * point from the end, which step doubling cannot control, so the result differs from it near x=L.
+     * @param deltax Grid step.
+     * @param numberOfPoint Total number of points to discretize.
+     * @param tsurf  Temperature at x=0 and x=L
+     * @param tinit Temperature at t=0
+     * @param D Coefficient.
+     * @param deltat Initial time step.
+     * @param t Total simulation time.
+     * @param temperatureInit Initial temperature distribution vector.
+     * @param tolerance Largest accepted local error estimate per step, in temperature units.
+     * @param report If not null, receives the numbers of steps, solves and factorizations, and those of the fixed-deltat run.
+     * @return The final temperature distribution.
+     */
+    std::vector<double> crankNicholsonMethodAdaptive(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit,
+                                                     double tolerance, AdaptiveReport *report = nullptr);
+
+    //! Batch Methods
+    /**
+     * @brief Applies the Laasonen scheme to K independent initial profiles that share the grid, D and dt.
+     * The K systems are solved together by EnsembleMethods; each result is identical to laasonenMethod.
+     * @param deltax Grid step.
+     * @param numberOfPoint Total number of points to discretize.
+     * @param tsurf Temperature at x=0 and x=L, one value per member.
+     * @param D Coefficient.
+     * @param deltat Time step.
+     * @param t Total simulation time.
+     * @param temperatureInits Initial temperature distribution vector of each member.
+     * @return The final temperature distribution at time t of each member.
+     */
+    std::vector<std::vector<double>> laasonenMethodBatch(double deltax, int numberOfPoint, const std::vector<double> &tsurf, double D, double deltat, double t, const std::vector<std::vector<double>> &temperatureInits);
+
+    /**
+     * @brief Applies the Crank-Nicholson scheme to K independent initial profiles that share the grid, D and dt.
+     * The K systems are solved together by EnsembleMethods; each result is identical to crankNicholsonMethod.
+     * @param deltax Grid step.
+     * @param numberOfPoint Total number of points to discretize.
+     * @param tsurf Temperature at x=0 and x=L, one value per member.
+     * @param D Coefficient.
+     * @param deltat Time step.
+     * @param t Total simulation time.
+     * @param temperatureInits Initial temperature distribution vector of each member.
+     * @return The final temperature distribution at time t of each member.
+     */
+    std::vector<std::vector<double>> crankNicholsonMethodBatch(double deltax, int numberOfPoint, const std::vector<double> &tsurf, double D, double deltat, double t, const std::vector<std::vector<double>> &temperatureInits);
 
     //! Write Methods
 
     /**
-     * @brief Saves the values of the vector to a CSV file.
-     * @param im_fileName Name of the CSV file.
+     * @brief Saves the values of the vector to a CSV file (CsvExporter, full double precision).
+     * @param fileName Name of the CSV file.
      * @param temperature Vector to be filled in the CSV file.
      */
-    void saveCSV(std::string im_fileName, std::vector<double> temperature);
+    void saveCSV(const std::string &fileName, const std::vector<double> &temperature);
 };
 #endif // IMPLICITMETHODS_H
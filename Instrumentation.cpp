@@ -0,0 +1,207 @@
+#include "Instrumentation.h"
+
+#ifdef HEAT_PROFILE
+
+#include <mutex>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Instrumentation
+{
+	thread_local ThreadCounters *t_counters = nullptr;
+
+	namespace
+	{
+		//! Hardware events read for the whole process when HEAT_PROFILE_PERF is set
+		struct HardwareEvent
+		{
+			const char *name;
+			unsigned int type;
+			unsigned long long config;
+			int descriptor;
+		};
+
+		//! Registry shared by all the threads; only touched when a probe or a thread is first seen, and at exit
+		struct Registry
+		{
+			std::mutex mutex;
+			const char *names[MAX_PROBES];
+			int probes = 0;
+			std::vector<ThreadCounters *> threads;
+			//! Tick and clock at start, to convert ticks to seconds
+			unsigned long long startTicks;
+			std::chrono::steady_clock::time_point startTime;
+			std::vector<HardwareEvent> events;
+		};
+
+		//! Opens the process-wide counters (inherited by the threads created later); failures are reported, not fatal
+		void openHardwareEvents(Registry &state)
+		{
+			const char *enabled = std::getenv("HEAT_PROFILE_PERF");
+			if (!enabled || std::strcmp(enabled, "0") == 0)
+			{
+				return;
+			}
+			state.events = {{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1},
+							{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1},
+							{"cache_references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, -1},
+							{"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1},
+							{"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -1}};
+			for (HardwareEvent &event : state.events)
+			{
+				perf_event_attr attributes;
+				std::memset(&attributes, 0, sizeof(attributes));
+				attributes.size = sizeof(attributes);
+				attributes.type = event.type;
+				attributes.config = event.config;
+				attributes.inherit = 1;
+				attributes.exclude_kernel = 1;
+				attributes.exclude_hv = 1;
+				event.descriptor = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+			}
+		}
+
+		Registry &registry()
+		{
+			//! Never destroyed, so probes and the exit handler can use it during static destruction
+			static Registry *instance = []
+			{
+				Registry *created = new Registry;
+				created->startTicks = ticks();
+				created->startTime = std::chrono::steady_clock::now();
+				openHardwareEvents(*created);
+				std::atexit(dump);
+				return created;
+			}();
+			return *instance;
+		}
+
+		//! Starts the clock and the hardware counters before main, so that every thread is counted
+		const bool s_started = (registry(), true);
+
+		//! Sum of one probe over all the threads, the time of each thread scaled from its sampled calls to all its calls
+		void total(const Registry &state, int probe, unsigned long long &calls, double &ticksTotal, unsigned long long &amount)
+		{
+			calls = amount = 0;
+			ticksTotal = 0;
+			for (const ThreadCounters *counters : state.threads)
+			{
+				calls += counters->calls[probe];
+				amount += counters->amounts[probe];
+				if (counters->timedCalls[probe] > 0)
+				{
+					ticksTotal += static_cast<double>(counters->ticks[probe]) * counters->calls[probe] / counters->timedCalls[probe];
+				}
+			}
+		}
+	}
+
+	int registerProbe(const char *name)
+	{
+		Registry &state = registry();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		for (int probe = 0; probe < state.probes; probe++)
+		{
+			if (std::strcmp(state.names[probe], name) == 0)
+			{
+				return probe;
+			}
+		}
+		if (state.probes == MAX_PROBES)
+		{
+			std::fprintf(stderr, "Instrumentation: more than %d probes, '%s' is merged into '%s'\n", MAX_PROBES, name, state.names[MAX_PROBES - 1]);
+			return MAX_PROBES - 1;
+		}
+		state.names[state.probes] = name;
+		return state.probes++;
+	}
+
+	ThreadCounters *createThreadCounters()
+	{
+		//! Kept after the thread exits so that its counts are in the summary
+		ThreadCounters *counters = new ThreadCounters;
+		std::memset(counters, 0, sizeof(ThreadCounters));
+		Registry &state = registry();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		state.threads.push_back(counters);
+		return counters;
+	}
+
+	void dump()
+	{
+		Registry &state = registry();
+		std::lock_guard<std::mutex> lock(state.mutex);
+
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - state.startTime).count();
+		unsigned long long elapsedTicks = ticks() - state.startTicks;
+		double secondsPerTick = elapsedTicks > 0 ? elapsed / elapsedTicks : 0.0;
+
+		//! Probes sorted by total time, counters (no time) last
+		std::vector<int> order(state.probes);
+		for (int probe = 0; probe < state.probes; probe++)
+		{
+			order[probe] = probe;
+		}
+		std::vector<unsigned long long> calls(state.probes), amounts(state.probes);
+		std::vector<double> probeTicks(state.probes);
+		for (int probe = 0; probe < state.probes; probe++)
+		{
+			total(state, probe, calls[probe], probeTicks[probe], amounts[probe]);
+		}
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+						 { return probeTicks[a] > probeTicks[b]; });
+
+		std::fprintf(stderr, "\n%-32s %14s %14s %12s %16s\n", "probe", "calls", "seconds", "us/call", "count");
+		for (int probe : order)
+		{
+			double seconds = probeTicks[probe] * secondsPerTick;
+			double perCall = calls[probe] > 0 ? 1e6 * seconds / calls[probe] : 0.0;
+			std::fprintf(stderr, "%-32s %14llu %14.6f %12.3f %16llu\n", state.names[probe], calls[probe], seconds, perCall, amounts[probe]);
+		}
+
+		std::vector<long long> eventValues(state.events.size(), -1);
+		for (std::size_t e = 0; e < state.events.size(); e++)
+		{
+			long long value;
+			if (state.events[e].descriptor >= 0 && read(state.events[e].descriptor, &value, sizeof(value)) == sizeof(value))
+			{
+				eventValues[e] = value;
+			}
+			std::fprintf(stderr, "%-32s %s\n", state.events[e].name, eventValues[e] >= 0 ? std::to_string(eventValues[e]).c_str() : "unavailable");
+		}
+		std::fprintf(stderr, "%-32s %14.6f s over %zu threads\n", "wall time", elapsed, state.threads.size());
+
+		const char *fileName = std::getenv("HEAT_PROFILE_OUTPUT");
+		std::string output = fileName ? fileName : "heat_profile.json";
+		std::FILE *file = std::fopen(output.c_str(), "w");
+		if (!file)
+		{
+			std::fprintf(stderr, "Instrumentation: cannot write %s\n", output.c_str());
+			return;
+		}
+		std::fprintf(file, "{\n  \"wall_seconds\": %.9f,\n  \"threads\": %zu,\n  \"probes\": [", elapsed, state.threads.size());
+		for (std::size_t k = 0; k < order.size(); k++)
+		{
+			int probe = order[k];
+			std::fprintf(file, "%s\n    {\"name\": \"%s\", \"calls\": %llu, \"seconds\": %.9f, \"count\": %llu}", k ? "," : "",
+						 state.names[probe], calls[probe], probeTicks[probe] * secondsPerTick, amounts[probe]);
+		}
+		std::fprintf(file, "\n  ],\n  \"hardware\": {");
+		for (std::size_t e = 0; e < state.events.size(); e++)
+		{
+			std::fprintf(file, "%s\"%s\": %s", e ? ", " : "", state.events[e].name, eventValues[e] >= 0 ? std::to_string(eventValues[e]).c_str() : "null");
+		}
+		std::fprintf(file, "}\n}\n");
+		std::fclose(file);
+	}
+}
+
+#endif // HEAT_PROFILE
@@ -0,0 +1,364 @@
+#include "MultiDimensionalMethods.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "SolverState.h"
+#include "Instrumentation.h"
+
+using namespace StencilKernels;
+
+void MultiDimensionalMethods::setThreads(int numberOfThreads)
+{
+	if (numberOfThreads < 1)
+	{
+		throw std::invalid_argument("The number of threads must be at least 1");
+	}
+
+	if (numberOfThreads == 1)
+	{
+		md_pool.reset();
+	}
+	else if (getThreads() != numberOfThreads)
+	{
+		md_pool = std::make_shared<ThreadPool>(numberOfThreads);
+	}
+}
+
+int MultiDimensionalMethods::getThreads() const
+{
+	return md_pool ? md_pool->size() : 1;
+}
+
+long MultiDimensionalMethods::strideZ() const
+{
+	return md_nz == 1 ? 0 : static_cast<long>(md_nx) * md_ny;
+}
+
+template <class Body>
+void MultiDimensionalMethods::forEachShare(long count, const Body &body)
+{
+	if (md_pool)
+	{
+		md_pool->run([&](int thread)
+					 {
+			long first, last;
+			md_pool->chunk(count, thread, first, last);
+			body(thread, first, last); });
+	}
+	else
+	{
+		body(0, 0L, count);
+	}
+}
+
+void MultiDimensionalMethods::setup(Scheme scheme, double deltax, int nx, int ny, int nz, double D, double deltat)
+{
+	HEAT_PROFILE_SCOPE("multidimensional.setup");
+	if (nx < 3 || ny < 3 || (nz != 1 && nz < 3))
+	{
+		throw std::invalid_argument("A plate or a block needs at least three points along each axis (nz = 1 for a plate)");
+	}
+	if (scheme == PeacemanRachford && nz != 1)
+	{
+		throw std::invalid_argument("Peaceman-Rachford is only stable on a plate (nz = 1), use Douglas on a block");
+	}
+	if (!(deltat > 0) || !(deltax > 0))
+	{
+		throw std::invalid_argument("The grid step and the time step must be positive");
+	}
+
+	md_scheme = scheme;
+	md_nx = nx;
+	md_ny = ny;
+	md_nz = nz;
+	md_deltat = deltat;
+	md_beta = D * (deltat / (deltax * deltax));
+
+	if (scheme == PeacemanRachford || scheme == Douglas)
+	{
+		//! Interior points of each line, the surfaces moved to the right-hand side
+		auto factorize = [&](BatchedTridiagonalSolver &solver, int numberOfPoint)
+		{
+			int interior = numberOfPoint - 2;
+			std::vector<double> lower(interior, -md_beta / 2), diag(interior, 1 + md_beta), upper(interior, -md_beta / 2);
+			lower[0] = 0;
+			upper[interior - 1] = 0;
+			solver.factorize(lower, diag, upper);
+		};
+		factorize(md_solverX, nx);
+		factorize(md_solverY, ny);
+		if (nz > 1)
+		{
+			factorize(md_solverZ, nz);
+		}
+	}
+
+	std::size_t size = static_cast<std::size_t>(nx) * ny * nz;
+	md_temperature.resize(size);
+	md_work.resize(size);
+	md_second.resize(size);
+}
+
+void MultiDimensionalMethods::applyInterior(const CrossStencil &stencil, const double *prev, const double *curr, double *out)
+{
+	int rowsPerPlane = md_ny - 2;
+	long planes = md_nz == 1 ? 1 : md_nz - 2;
+	//! The z neighbours are only read when they carry a weight
+	long neighbourZ = stencil.weightZ != 0 ? strideZ() : 0;
+	forEachShare(planes * rowsPerPlane, [&](int, long first, long last)
+				 {
+		for (long row = first; row < last; row++)
+		{
+			long k = md_nz == 1 ? 0 : 1 + row / rowsPerPlane;
+			long offset = (k * md_ny + 1 + row % rowsPerPlane) * md_nx + 1;
+			applyCrossStencil(stencil, prev ? prev + offset : nullptr, curr + offset, out + offset, md_nx - 2, md_nx, neighbourZ);
+		} });
+}
+
+void MultiDimensionalMethods::solveLinesX(double *field, double tsurf)
+{
+	HEAT_PROFILE_SCOPE("multidimensional.lines_x");
+	int interior = md_nx - 2;
+	int rowsPerPlane = md_ny - 2;
+	long planes = md_nz == 1 ? 1 : md_nz - 2;
+	double boundary = md_beta / 2 * tsurf;
+	md_tiles.resize(static_cast<std::size_t>(interior) * TILE_LINES * getThreads());
+	forEachShare(planes * rowsPerPlane, [&](int thread, long first, long last)
+				 {
+		double *tile = md_tiles.data() + static_cast<std::size_t>(interior) * TILE_LINES * thread;
+		double *rows[TILE_LINES];
+		for (long row = first; row < last; row += TILE_LINES)
+		{
+			int lines = std::min<long>(TILE_LINES, last - row);
+			for (int l = 0; l < lines; l++)
+			{
+				long k = md_nz == 1 ? 0 : 1 + (row + l) / rowsPerPlane;
+				rows[l] = field + (k * md_ny + 1 + (row + l) % rowsPerPlane) * md_nx + 1;
+			}
+
+			//! Transpose the lines into the tile (point i of line l at i * lines + l), solve them together, transpose back
+			for (int i = 0; i < interior; i++)
+			{
+				for (int l = 0; l < lines; l++)
+				{
+					tile[i * lines + l] = rows[l][i];
+				}
+			}
+			for (int l = 0; l < lines; l++)
+			{
+				tile[l] += boundary;
+				tile[(interior - 1) * lines + l] += boundary;
+			}
+			md_solverX.solve(tile, lines, lines);
+			for (int i = 0; i < interior; i++)
+			{
+				for (int l = 0; l < lines; l++)
+				{
+					rows[l][i] = tile[i * lines + l];
+				}
+			}
+		} });
+}
+
+void MultiDimensionalMethods::solveLinesY(double *field, double tsurf)
+{
+	HEAT_PROFILE_SCOPE("multidimensional.lines_y");
+	int columns = md_nx - 2;
+	long planes = md_nz == 1 ? 1 : md_nz - 2;
+	double boundary = md_beta / 2 * tsurf;
+	//! The lines along y of a plane are interleaved with stride nx: each share of columns is one strided solve per plane
+	forEachShare(planes * columns, [&](int, long first, long last)
+				 {
+		while (first < last)
+		{
+			long k = md_nz == 1 ? 0 : 1 + first / columns;
+			int column = first % columns;
+			int count = std::min<long>(columns - column, last - first);
+			double *base = field + (k * md_ny + 1) * md_nx + 1 + column;
+			double *lastRow = base + static_cast<long>(md_ny - 3) * md_nx;
+			for (int l = 0; l < count; l++)
+			{
+				base[l] += boundary;
+				lastRow[l] += boundary;
+			}
+			md_solverY.solve(base, md_nx, count);
+			first += count;
+		} });
+}
+
+void MultiDimensionalMethods::solveLinesZ(double *field, double tsurf)
+{
+	HEAT_PROFILE_SCOPE("multidimensional.lines_z");
+	int columns = md_nx - 2;
+	long plane = strideZ();
+	double boundary = md_beta / 2 * tsurf;
+	//! The lines along z are interleaved with stride nx * ny: one strided solve per share of each row
+	forEachShare(static_cast<long>(md_ny - 2) * columns, [&](int, long first, long last)
+				 {
+		while (first < last)
+		{
+			long j = 1 + first / columns;
+			int column = first % columns;
+			int count = std::min<long>(columns - column, last - first);
+			double *base = field + plane + j * md_nx + 1 + column;
+			double *lastPlane = base + (md_nz - 3) * plane;
+			for (int l = 0; l < count; l++)
+			{
+				base[l] += boundary;
+				lastPlane[l] += boundary;
+			}
+			md_solverZ.solve(base, plane, count);
+			first += count;
+		} });
+}
+
+void MultiDimensionalMethods::explicitSteps(int steps)
+{
+	HEAT_PROFILE_SCOPE("multidimensional.explicit_steps");
+	int dimensions = md_nz == 1 ? 2 : 3;
+	double beta = md_beta;
+	CrossStencil ftcs{0, 1 - 2 * dimensions * beta, beta, beta, beta};
+	CrossStencil update;
+	if (md_scheme == Richardson)
+	{
+		update = CrossStencil{1, -2 * dimensions * beta, beta, beta, beta};
+	}
+	else
+	{
+		//! T^{n+1} (1 + 2 d beta) = T^{n-1} (1 - 2 d beta) + 2 beta (sum of the 2 d neighbours)
+		double neighbour = 2 * beta / (1 + 2 * dimensions * beta);
+		update = CrossStencil{(1 - 2 * dimensions * beta) / (1 + 2 * dimensions * beta), 0, neighbour, neighbour, neighbour};
+	}
+
+	//! md_second is level n-1, md_temperature level n, md_work level n+1
+	for (int step = 0; step <= steps; step++)
+	{
+		if (step == 0)
+		{
+			applyInterior(ftcs, nullptr, md_temperature.data(), md_work.data());
+		}
+		else
+		{
+			applyInterior(update, md_second.data(), md_temperature.data(), md_work.data());
+		}
+		std::swap(md_second, md_temperature);
+		std::swap(md_temperature, md_work);
+	}
+}
+
+void MultiDimensionalMethods::adiSteps(double tsurf, int steps)
+{
+	HEAT_PROFILE_SCOPE("multidimensional.adi_steps");
+	double beta = md_beta;
+	bool block = md_nz > 1;
+	for (int step = 0; step < steps; step++)
+	{
+		if (md_scheme == PeacemanRachford)
+		{
+			applyInterior(CrossStencil{0, 1 - beta, 0, beta / 2, 0}, nullptr, md_temperature.data(), md_work.data());
+			solveLinesX(md_work.data(), tsurf);
+			applyInterior(CrossStencil{0, 1 - beta, beta / 2, 0, 0}, nullptr, md_work.data(), md_second.data());
+			solveLinesY(md_second.data(), tsurf);
+			std::swap(md_temperature, md_second);
+		}
+		else
+		{
+			//! T1, then T2 = T1 - beta/2 d_yy T^n and T^{n+1} = T2 - beta/2 d_zz T^n, each followed by its line solves
+			applyInterior(CrossStencil{0, 1 - beta - 2 * beta * (block ? 2 : 1), beta / 2, beta, beta}, nullptr, md_temperature.data(), md_work.data());
+			solveLinesX(md_work.data(), tsurf);
+			applyInterior(CrossStencil{1, beta, 0, -beta / 2, 0}, md_work.data(), md_temperature.data(), md_second.data());
+			solveLinesY(md_second.data(), tsurf);
+			if (block)
+			{
+				applyInterior(CrossStencil{1, beta, 0, 0, -beta / 2}, md_second.data(), md_temperature.data(), md_work.data());
+				solveLinesZ(md_work.data(), tsurf);
+				std::swap(md_temperature, md_work);
+			}
+			else
+			{
+				std::swap(md_temperature, md_second);
+			}
+		}
+	}
+}
+
+std::span<const double> MultiDimensionalMethods::run(double tsurf, double t, const std::vector<double> &temperatureInit)
+{
+	if (md_nx == 0)
+	{
+		throw std::logic_error("setup must be called before run");
+	}
+	if (temperatureInit.size() != md_temperature.size())
+	{
+		throw std::invalid_argument("The initial field must have nx * ny * nz values");
+	}
+	HEAT_PROFILE_SCOPE("multidimensional.run");
+
+	//! The surfaces of every field stay at tsurf: the sweeps only write interior points
+	std::fill(md_work.begin(), md_work.end(), tsurf);
+	std::fill(md_second.begin(), md_second.end(), tsurf);
+	md_temperature = initialField(md_nx, md_ny, md_nz, tsurf, tsurf);
+	for (int k = md_nz == 1 ? 0 : 1; k < (md_nz == 1 ? 1 : md_nz - 1); k++)
+	{
+		for (int j = 1; j < md_ny - 1; j++)
+		{
+			std::size_t offset = (static_cast<std::size_t>(k) * md_ny + j) * md_nx;
+			std::copy(temperatureInit.begin() + offset + 1, temperatureInit.begin() + offset + md_nx - 1, md_temperature.begin() + offset + 1);
+		}
+	}
+
+	if (md_scheme == Richardson || md_scheme == DufortFrankel)
+	{
+		//! Level 1 is the FTCS step
+		md_level = snapshotLevel(t, md_deltat, 1);
+		explicitSteps(md_level - 1);
+	}
+	else
+	{
+		md_level = snapshotLevel(t, md_deltat, 0);
+		adiSteps(tsurf, md_level);
+	}
+	HEAT_PROFILE_COUNT("multidimensional.point_updates", static_cast<unsigned long long>(md_level) * md_temperature.size());
+	return md_temperature;
+}
+
+std::vector<double> MultiDimensionalMethods::solve(Scheme scheme, double deltax, int nx, int ny, int nz, double tsurf, double D, double deltat, double t,
+												   const std::vector<double> &temperatureInit)
+{
+	setup(scheme, deltax, nx, ny, nz, D, deltat);
+	std::span<const double> temperature = run(tsurf, t, temperatureInit);
+	return std::vector<double>(temperature.begin(), temperature.end());
+}
+
+std::vector<double> MultiDimensionalMethods::initialField(int nx, int ny, int nz, double tsurf, double tinit)
+{
+	std::vector<double> temperature(static_cast<std::size_t>(nx) * ny * nz, tinit);
+	for (int k = 0; k < nz; k++)
+	{
+		for (int j = 0; j < ny; j++)
+		{
+			for (int i = 0; i < nx; i++)
+			{
+				bool face = i == 0 || i == nx - 1 || j == 0 || j == ny - 1 || (nz > 1 && (k == 0 || k == nz - 1));
+				if (face)
+				{
+					temperature[(static_cast<std::size_t>(k) * ny + j) * nx + i] = tsurf;
+				}
+			}
+		}
+	}
+	return temperature;
+}
+
+// Get functions
+int MultiDimensionalMethods::getLevel() const
+{
+	return md_level;
+}
+
+double MultiDimensionalMethods::getTime() const
+{
+	return md_level * md_deltat;
+}
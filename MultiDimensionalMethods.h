@@ -0,0 +1,151 @@
+#pragma once
+#ifndef MULTIDIMENSIONALMETHODS_H
+#define MULTIDIMENSIONALMETHODS_H
+
+#include <vector>
+#include <span>
+#include <memory>
+
+#include "BatchedTridiagonalSolver.h"
+#include "ThreadPool.h"
+#include "StencilKernels.h"
+
+/**
+ * @class MultiDimensionalMethods
+ * @brief This class solves the heat equation on a plate (2D) or a block (3D) with ADI splitting, and with the explicit
+ * Richardson and Dufort-Frankel schemes for comparison
+ *
+ * The grid is uniform with the same deltax along every axis, nx * ny * nz points stored x fastest (entry
+ * (k * ny + j) * nx + i, nz = 1 for a plate), every face held at tsurf. With beta = D deltat / deltax^2:
+ * - Peaceman-Rachford (2D only): (I - beta/2 d_xx) T* = (I + beta/2 d_yy) T^n, (I - beta/2 d_yy) T^{n+1} = (I + beta/2 d_xx) T*
+ * - Douglas (2D and 3D): (I - beta/2 d_xx) T1 = (I + beta/2 d_xx + beta d_yy + beta d_zz) T^n, then
+ *   (I - beta/2 d_yy) T2 = T1 - beta/2 d_yy T^n and (I - beta/2 d_zz) T^{n+1} = T2 - beta/2 d_zz T^n
+ * Both are second order and unconditionally stable. Each right-hand side is one StencilKernels::applyCrossStencil
+ * sweep, and each direction is one batch of line solves with BatchedTridiagonalSolver (the batched Thomas algorithm),
+ * vectorized across lines:
+ * - along y and z the lines are already interleaved (row stride nx, plane stride nx * ny): strided solves in place;
+ * - along x the lines are contiguous: tiles of TILE_LINES lines are transposed into a buffer of the thread, solved
+ *   interleaved and transposed back, each tile staying in cache.
+ * The rows and the lines are shared out between the threads, with one barrier per sweep.
+ *
+ * The explicit schemes are those of ExplicitMethods with the sum of the second differences along every axis. The
+ * time levels follow the 1D methods: level snapshotLevel(t, deltat, 1) for the explicit schemes (after the FTCS
+ * step) and snapshotLevel(t, deltat, 0) for ADI.
+ */
+
+class MultiDimensionalMethods
+{
+public:
+	//! Schemes of a run
+	enum Scheme
+	{
+		Richardson,
+		DufortFrankel,
+		PeacemanRachford,
+		Douglas
+	};
+
+	//! Lines along x transposed and solved together (four cache lines of each point, the tile within L1/L2)
+	static constexpr int TILE_LINES = 32;
+
+private:
+	//! Attributes for the scheme, the points along each axis (0 before setup) and the time step
+	Scheme md_scheme = Douglas;
+	int md_nx = 0;
+	int md_ny = 0;
+	int md_nz = 0;
+	double md_deltat = 0;
+	//! Attribute for beta = D deltat / deltax^2
+	double md_beta = 0;
+	//! Attributes for the factorized (1 + beta, -beta/2) matrices of the interior points of the lines along x, y and z
+	BatchedTridiagonalSolver md_solverX;
+	BatchedTridiagonalSolver md_solverY;
+	BatchedTridiagonalSolver md_solverZ;
+	//! Attributes for the time levels and the work fields, surfaces included
+	std::vector<double> md_temperature;
+	std::vector<double> md_work;
+	std::vector<double> md_second;
+	//! Attribute for the tiles of lines along x, one per thread
+	std::vector<double> md_tiles;
+	//! Attribute for the worker threads, kept between calls; null when running on one thread
+	std::shared_ptr<ThreadPool> md_pool;
+	//! Attribute for the time level of md_temperature after the last run
+	int md_level = 0;
+
+	//! Distance between two neighbours along z, 0 on a plate
+	long strideZ() const;
+
+	/**
+	 * @brief Runs body(thread, first, last) on every thread, [first, last) its share of count items, with one barrier at the end.
+	 */
+	template <class Body>
+	void forEachShare(long count, const Body &body);
+
+	/**
+	 * @brief Applies a cross stencil to every interior point: out = stencil(prev, curr).
+	 * @param prev Level n-1 of the stencil, nullptr when it does not use one
+	 */
+	void applyInterior(const StencilKernels::CrossStencil &stencil, const double *prev, const double *curr, double *out);
+
+	//! Solves (I - beta/2 d_xx) on every interior line along x of field, in place, the surfaces at tsurf
+	void solveLinesX(double *field, double tsurf);
+	//! Same along y
+	void solveLinesY(double *field, double tsurf);
+	//! Same along z
+	void solveLinesZ(double *field, double tsurf);
+
+	//! FTCS step, then steps of the explicit scheme
+	void explicitSteps(int steps);
+	//! ADI time steps of the set up scheme
+	void adiSteps(double tsurf, int steps);
+
+public:
+	/**
+	 * @brief Selects the number of threads, (re)starting the worker pool only when it changes.
+	 * @param numberOfThreads Number of threads, 1 (default) runs on the calling thread only
+	 */
+	void setThreads(int numberOfThreads);
+
+	//! Number of threads sharing the sweeps
+	int getThreads() const;
+
+	/**
+	 * @brief Sizes the fields and, for ADI, factorizes the line matrices. The storage is reused when the grid does not grow.
+	 * @param scheme Scheme of the next runs (Peaceman-Rachford needs nz = 1)
+	 * @param deltax Grid step along every axis
+	 * @param nx Number of points along x, at least 3
+	 * @param ny Number of points along y, at least 3
+	 * @param nz Number of points along z, 1 for a plate or at least 3
+	 * @param D Coefficient
+	 * @param deltat Time step
+	 */
+	void setup(Scheme scheme, double deltax, int nx, int ny, int nz, double D, double deltat);
+
+	/**
+	 * @brief Advances an initial field with the set up scheme to the level of time t (see the class description).
+	 * @param tsurf Temperature of every face
+	 * @param t Total simulation time
+	 * @param temperatureInit Initial field, nx * ny * nz values (its surfaces are replaced by tsurf)
+	 * @return Field at the returned level, without copy; valid until the next run or setup
+	 */
+	std::span<const double> run(double tsurf, double t, const std::vector<double> &temperatureInit);
+
+	/**
+	 * @brief Sets up a scheme and runs it (see setup and run).
+	 * @return Final field
+	 */
+	std::vector<double> solve(Scheme scheme, double deltax, int nx, int ny, int nz, double tsurf, double D, double deltat, double t,
+							  const std::vector<double> &temperatureInit);
+
+	/**
+	 * @brief Field at tinit inside with every face at tsurf, the initial distribution of the wall problem on a plate or a block.
+	 */
+	static std::vector<double> initialField(int nx, int ny, int nz, double tsurf, double tinit);
+
+	//! Get Methods
+	//! Time level of the last run
+	int getLevel() const;
+	//! Time of the last run's result, getLevel() * deltat
+	double getTime() const;
+};
+#endif // MULTIDIMENSIONALMETHODS_H
@@ -0,0 +1,188 @@
+#include "NonUniformMethods.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "SolverState.h"
+#include "Instrumentation.h"
+
+using namespace StencilKernels;
+
+void NonUniformMethods::setup(Scheme scheme, const Grid &grid, double deltat)
+{
+	HEAT_PROFILE_SCOPE("nonuniform.setup");
+	if (!(deltat > 0))
+	{
+		throw std::invalid_argument("The time step must be positive");
+	}
+	int numberOfPoint = grid.getNumberOfPoint();
+	std::vector<double> lower, upper;
+	grid.operatorCoefficients(lower, upper);
+
+	//! Five contiguous arrays: previous, lower, upper of the scheme, then lower, upper of FTCS (see VariableStencil)
+	nu_coefficients.assign(5 * static_cast<std::size_t>(numberOfPoint), 0.0);
+	double *block[5];
+	for (int k = 0; k < 5; k++)
+	{
+		block[k] = nu_coefficients.data() + static_cast<std::size_t>(k) * numberOfPoint;
+	}
+	VariableStencil::Form form = scheme == Richardson ? VariableStencil::AddPrevious : scheme == DufortFrankel ? VariableStencil::ScalePrevious : VariableStencil::Centre;
+	nu_update = VariableStencil{form, block[0], block[1], block[2]};
+	nu_ftcs = VariableStencil{VariableStencil::Centre, nullptr, block[3], block[4]};
+
+	for (int i = 1; i < numberOfPoint - 1; i++)
+	{
+		//! deltat * lower_i and deltat * upper_i: beta on a uniform grid
+		double a = deltat * lower[i];
+		double c = deltat * upper[i];
+		switch (scheme)
+		{
+		case Richardson:
+			block[1][i] = a;
+			block[2][i] = c;
+			break;
+		case DufortFrankel:
+			//! T_i^{n+1} (1 + a + c) = T_i^{n-1} (1 - a - c) + 2 a T_{i-1}^n + 2 c T_{i+1}^n
+			block[0][i] = (1 - (a + c)) / (1 + (a + c));
+			block[1][i] = 2 * a / (1 + (a + c));
+			block[2][i] = 2 * c / (1 + (a + c));
+			break;
+		case CrankNicholson:
+			block[1][i] = a / 2;
+			block[2][i] = c / 2;
+			break;
+		case Laasonen:
+			break;
+		}
+		block[3][i] = a;
+		block[4][i] = c;
+	}
+
+	//! The implicit matrices act on the interior points 1 .. N-2, the surfaces move to the right-hand side
+	if (scheme == Laasonen || scheme == CrankNicholson)
+	{
+		double weight = scheme == Laasonen ? deltat : deltat / 2;
+		int interior = numberOfPoint - 2;
+		std::vector<double> lowerDiag(interior), diag(interior), upperDiag(interior);
+		for (int i = 1; i < numberOfPoint - 1; i++)
+		{
+			lowerDiag[i - 1] = -weight * lower[i];
+			diag[i - 1] = 1 + weight * (lower[i] + upper[i]);
+			upperDiag[i - 1] = -weight * upper[i];
+		}
+		lowerDiag[0] = 0;
+		upperDiag[interior - 1] = 0;
+		nu_solver.factorize(lowerDiag, diag, upperDiag);
+		nu_boundaryFirst = weight * lower[1];
+		nu_boundaryLast = weight * upper[numberOfPoint - 2];
+	}
+
+	nu_scheme = scheme;
+	nu_numberOfPoint = numberOfPoint;
+	nu_deltat = deltat;
+	nu_previous.resize(numberOfPoint);
+	nu_current.resize(numberOfPoint);
+	nu_next.resize(numberOfPoint);
+}
+
+void NonUniformMethods::explicitSteps(double tsurf, int steps)
+{
+	int last = nu_numberOfPoint - 1;
+	for (int step = 0; step <= steps; step++)
+	{
+		applyVariableStencil1D(step == 0 ? nu_ftcs : nu_update, nu_previous.data(), nu_current.data(), nu_next.data(), 1, last);
+		nu_next[0] = tsurf;
+		nu_next[last] = tsurf;
+		std::swap(nu_previous, nu_current);
+		std::swap(nu_current, nu_next);
+	}
+}
+
+void NonUniformMethods::laasonenSteps(double tsurf, int steps)
+{
+	int interior = nu_numberOfPoint - 2;
+	std::span<double> unknowns(nu_current.data() + 1, interior);
+	for (int step = 0; step < steps; step++)
+	{
+		//! Add boundary conditions, then solve in place
+		unknowns[0] += nu_boundaryFirst * tsurf;
+		unknowns[interior - 1] += nu_boundaryLast * tsurf;
+		nu_solver.solve(unknowns);
+	}
+}
+
+void NonUniformMethods::crankNicholsonSteps(double tsurf, int steps)
+{
+	int interior = nu_numberOfPoint - 2;
+	for (int step = 0; step < steps; step++)
+	{
+		//! Explicit half on every interior point (the surfaces of level n included), then the implicit half of the surfaces
+		applyVariableStencil1D(nu_update, nullptr, nu_current.data(), nu_next.data(), 1, nu_numberOfPoint - 1);
+		nu_next[1] += nu_boundaryFirst * tsurf;
+		nu_next[interior] += nu_boundaryLast * tsurf;
+		nu_solver.solve(std::span<double>(nu_next.data() + 1, interior));
+		nu_next[0] = tsurf;
+		nu_next[interior + 1] = tsurf;
+		std::swap(nu_current, nu_next);
+	}
+}
+
+std::span<const double> NonUniformMethods::run(double tsurf, double t, const std::vector<double> &temperatureInit)
+{
+	if (nu_numberOfPoint == 0)
+	{
+		throw std::logic_error("setup must be called before run");
+	}
+	if (temperatureInit.size() != static_cast<std::size_t>(nu_numberOfPoint))
+	{
+		throw std::invalid_argument("The initial distribution must have one value per point of the grid");
+	}
+	HEAT_PROFILE_SCOPE("nonuniform.run");
+	std::copy(temperatureInit.begin(), temperatureInit.end(), nu_current.begin());
+	nu_current[0] = tsurf;
+	nu_current[nu_numberOfPoint - 1] = tsurf;
+
+	switch (nu_scheme)
+	{
+	case Richardson:
+	case DufortFrankel:
+		//! Level 1 is the FTCS step
+		nu_level = snapshotLevel(t, nu_deltat, 1);
+		explicitSteps(tsurf, nu_level - 1);
+		break;
+	case Laasonen:
+		nu_level = snapshotLevel(t, nu_deltat, 0);
+		laasonenSteps(tsurf, nu_level);
+		break;
+	case CrankNicholson:
+		nu_level = snapshotLevel(t, nu_deltat, 0);
+		crankNicholsonSteps(tsurf, nu_level);
+		break;
+	}
+	HEAT_PROFILE_COUNT("nonuniform.point_updates", static_cast<unsigned long long>(nu_level) * nu_numberOfPoint);
+	return nu_current;
+}
+
+std::vector<double> NonUniformMethods::solve(Scheme scheme, const Grid &grid, double tsurf, double deltat, double t, const std::vector<double> &temperatureInit)
+{
+	setup(scheme, grid, deltat);
+	std::span<const double> temperature = run(tsurf, t, temperatureInit);
+	return std::vector<double>(temperature.begin(), temperature.end());
+}
+
+// Get functions
+int NonUniformMethods::getNumberOfPoint() const
+{
+	return nu_numberOfPoint;
+}
+
+int NonUniformMethods::getLevel() const
+{
+	return nu_level;
+}
+
+double NonUniformMethods::getTime() const
+{
+	return nu_level * nu_deltat;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#ifndef NONUNIFORMMETHODS_H
+#define NONUNIFORMMETHODS_H
+
+#include <vector>
+#include <span>
+
+#include "Grid.h"
+#include "TridiagonalSolver.h"
+#include "StencilKernels.h"
+
+/**
+ * @class NonUniformMethods
+ * @brief This class runs the four schemes on a Grid: stretched points and a coefficient per cell
+ *
+ * Each scheme is the one of ExplicitMethods or ImplicitMethods with the operator of Grid in place of
+ * D (T_{i+1} - 2 T_i + T_{i-1}) / deltax^2. setup computes the per-point coefficients of the scheme once, as
+ * contiguous arrays read by StencilKernels::applyVariableStencil1D (vectorized like the uniform stencils), and
+ * factorizes the matrix of an implicit scheme; run then only takes time steps.
+ *
+ * Both surfaces are the first and last points, held at tsurf, and the implicit schemes solve for the interior points.
+ * On a uniform grid with one D, Richardson and Dufort-Frankel therefore give the results of ExplicitMethods within
+ * round-off, but Laasonen and Crank-Nicholson do not match ImplicitMethods, which solves for all the points with
+ * tsurf one step outside them: the two boundary treatments differ by O(deltax) near the surfaces.
+ *
+ * The time levels follow the single-time methods: a run to time t returns level snapshotLevel(t, deltat, 1) for the
+ * explicit schemes (after the FTCS step) and snapshotLevel(t, deltat, 0) for the implicit ones (see getTime).
+ */
+
+class NonUniformMethods
+{
+public:
+	//! Schemes of a run
+	enum Scheme
+	{
+		Richardson,
+		DufortFrankel,
+		Laasonen,
+		CrankNicholson
+	};
+
+private:
+	//! Attributes for the scheme, the number of points and the time step of the coefficients, 0 points before setup
+	Scheme nu_scheme = Richardson;
+	int nu_numberOfPoint = 0;
+	double nu_deltat = 0;
+	//! Attribute for the coefficient arrays, numberOfPoint values each: previous, lower and upper of the explicit scheme
+	//! or of the Crank-Nicholson right-hand side, then lower and upper of the FTCS step
+	std::vector<double> nu_coefficients;
+	//! Attributes for the update of the scheme and of the FTCS starter step, pointing into nu_coefficients
+	StencilKernels::VariableStencil nu_update;
+	StencilKernels::VariableStencil nu_ftcs;
+	//! Attribute for the factorized matrix of an implicit scheme, on the interior points
+	TridiagonalSolver nu_solver;
+	//! Attributes for the weights of tsurf in the first and last interior equations of an implicit scheme
+	double nu_boundaryFirst = 0;
+	double nu_boundaryLast = 0;
+	//! Attributes for the time levels n-1, n and n+1 (n+1 holds the right-hand side of Crank-Nicholson)
+	std::vector<double> nu_previous;
+	std::vector<double> nu_current;
+	std::vector<double> nu_next;
+	//! Attribute for the time level of nu_current after the last run
+	int nu_level = 0;
+
+	//! Steps of the three-level explicit schemes: the FTCS step, then steps updates
+	void explicitSteps(double tsurf, int steps);
+	//! Laasonen time steps, solved in place on the interior points
+	void laasonenSteps(double tsurf, int steps);
+	//! Crank-Nicholson time steps: right-hand side with nu_update, then a solve on the interior points
+	void crankNicholsonSteps(double tsurf, int steps);
+
+public:
+	/**
+	 * @brief Computes the per-point coefficients of a scheme on a grid and, for an implicit scheme, factorizes its
+	 * matrix. The storage is reused when the grid does not grow.
+	 * @param scheme Scheme of the next runs
+	 * @param grid Points and coefficients of the wall
+	 * @param deltat Time step
+	 */
+	void setup(Scheme scheme, const Grid &grid, double deltat);
+
+	/**
+	 * @brief Advances an initial distribution with the set up scheme to the level of time t (see the class description).
+	 * @param tsurf Temperature at x=0 and x=L
+	 * @param t Total simulation time
+	 * @param temperatureInit Initial temperature distribution, one value per point of the grid
+	 * @return Temperature at the returned level, without copy; valid until the next run or setup
+	 */
+	std::span<const double> run(double tsurf, double t, const std::vector<double> &temperatureInit);
+
+	/**
+	 * @brief Sets up a scheme and runs it (see setup and run).
+	 * @return Final temperature distribution
+	 */
+	std::vector<double> solve(Scheme scheme, const Grid &grid, double tsurf, double deltat, double t, const std::vector<double> &temperatureInit);
+
+	//! Get Methods
+	int getNumberOfPoint() const;
+	//! Time level of the last run
+	int getLevel() const;
+	//! Time of the last run's result, getLevel() * deltat
+	double getTime() const;
+};
+#endif // NONUNIFORMMETHODS_H
@@ -0,0 +1,174 @@
+#include "ParallelTridiagonalSolver.h"
+#include <stdexcept>
+#include <algorithm>
+
+#include "Instrumentation.h"
+
+// Constructor
+ParallelTridiagonalSolver::ParallelTridiagonalSolver(std::shared_ptr<ThreadPool> pool)
+	: pts_pool(pool), pts_size(0)
+{
+	if (!pts_pool)
+	{
+		throw std::invalid_argument("ParallelTridiagonalSolver needs a thread pool");
+	}
+}
+
+int ParallelTridiagonalSolver::interiorFirst(int p) const
+{
+	return pts_partitionStart[p];
+}
+
+int ParallelTridiagonalSolver::interiorLast(int p) const
+{
+	//! Every partition but the last one gives its last row to the interface system
+	return p == partitions() - 1 ? pts_size : pts_partitionStart[p + 1] - 1;
+}
+
+void ParallelTridiagonalSolver::factorize(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag)
+{
+	int size = diag.size();
+
+	if (size == 0 || lower_diag.size() != static_cast<std::size_t>(size) || upper_diag.size() != static_cast<std::size_t>(size))
+	{
+		throw std::invalid_argument("Vectors diag, lower_diag, and  upper_diag must have the same non-zero size");
+	}
+
+	//! Each partition needs at least one interior row and one interface row
+	int numberOfPartitions = std::max(1, std::min(pts_pool->size(), size / 2));
+
+	pts_size = size;
+	pts_partitionStart.resize(numberOfPartitions + 1);
+	for (int p = 0; p <= numberOfPartitions; p++)
+	{
+		pts_partitionStart[p] = static_cast<long>(size) * p / numberOfPartitions;
+	}
+	pts_local.resize(numberOfPartitions);
+	pts_alpha.assign(size, 0.0);
+	pts_beta.assign(size, 0.0);
+
+	//! Local factorizations and spikes, one partition per thread
+	pts_pool->run([&](int p)
+				  {
+		if (p >= numberOfPartitions)
+		{
+			return;
+		}
+		int first = interiorFirst(p);
+		int last = interiorLast(p);
+
+		std::vector<double> lower(lower_diag.begin() + first, lower_diag.begin() + last);
+		std::vector<double> middle(diag.begin() + first, diag.begin() + last);
+		std::vector<double> upper(upper_diag.begin() + first, upper_diag.begin() + last);
+		pts_local[p].factorize(lower, middle, upper);
+
+		std::span<double> alpha(pts_alpha.data() + first, last - first);
+		std::span<double> beta(pts_beta.data() + first, last - first);
+
+		//! Coupling to L_{p-1} through the lower coefficient of the first interior row
+		if (p > 0)
+		{
+			alpha[0] = -lower_diag[first];
+			pts_local[p].solve(alpha);
+		}
+		//! Coupling to L_p through the upper coefficient of the last interior row
+		if (p < numberOfPartitions - 1)
+		{
+			beta[last - first - 1] = -upper_diag[last - 1];
+			pts_local[p].solve(beta);
+		} });
+
+	//! Interface system on L_0 .. L_{P-2}, row q is the last row of partition q
+	int interfaceSize = numberOfPartitions - 1;
+	pts_interfaceValues.resize(interfaceSize);
+	pts_interfaceLower.resize(interfaceSize);
+	pts_interfaceUpper.resize(interfaceSize);
+	if (interfaceSize > 0)
+	{
+		std::vector<double> lower(interfaceSize), middle(interfaceSize), upper(interfaceSize);
+		for (int q = 0; q < interfaceSize; q++)
+		{
+			int row = pts_partitionStart[q + 1] - 1;
+			pts_interfaceLower[q] = lower_diag[row];
+			pts_interfaceUpper[q] = upper_diag[row];
+			lower[q] = lower_diag[row] * pts_alpha[row - 1];
+			middle[q] = diag[row] + lower_diag[row] * pts_beta[row - 1] + upper_diag[row] * pts_alpha[row + 1];
+			upper[q] = upper_diag[row] * pts_beta[row + 1];
+		}
+		pts_interface.factorize(lower, middle, upper);
+	}
+}
+
+void ParallelTridiagonalSolver::solve(std::span<double> x)
+{
+	if (x.size() != static_cast<std::size_t>(pts_size))
+	{
+		throw std::invalid_argument("Right-hand side must have the size of the factorized matrix");
+	}
+
+	int numberOfPartitions = partitions();
+
+	//! Phase 1: local solves, x_i = y_i on the interior rows
+	HEAT_PROFILE_COUNT("parallel_thomas.solves", 1);
+	pts_pool->run([&](int p)
+				  {
+		if (p < numberOfPartitions)
+		{
+			pts_local[p].solve(x.subspan(interiorFirst(p), interiorLast(p) - interiorFirst(p)));
+		} });
+
+	if (numberOfPartitions == 1)
+	{
+		return;
+	}
+
+	//! Phase 2: interface values L_p from the interface rows
+	int interfaceSize = numberOfPartitions - 1;
+	{
+		HEAT_PROFILE_SCOPE("parallel_thomas.interface");
+		for (int q = 0; q < interfaceSize; q++)
+		{
+			int row = pts_partitionStart[q + 1] - 1;
+			pts_interfaceValues[q] = x[row] - pts_interfaceLower[q] * x[row - 1] - pts_interfaceUpper[q] * x[row + 1];
+		}
+		pts_interface.solve(pts_interfaceValues);
+	}
+
+	//! Phase 3: x_i = y_i + alpha_i L_{p-1} + beta_i L_p
+	pts_pool->run([&](int p)
+				  {
+		if (p >= numberOfPartitions)
+		{
+			return;
+		}
+		HEAT_PROFILE_SCOPE("parallel_thomas.spike_update");
+		double left = p > 0 ? pts_interfaceValues[p - 1] : 0.0;
+		double right = p < interfaceSize ? pts_interfaceValues[p] : 0.0;
+		const double *alpha = pts_alpha.data();
+		const double *beta = pts_beta.data();
+		int last = interiorLast(p);
+		for (int i = interiorFirst(p); i < last; i++)
+		{
+			x[i] = x[i] + alpha[i] * left + beta[i] * right;
+		}
+		if (p < interfaceSize)
+		{
+			x[last] = right;
+		} });
+}
+
+// Get functions
+int ParallelTridiagonalSolver::size() const
+{
+	return pts_size;
+}
+
+int ParallelTridiagonalSolver::partitions() const
+{
+	return pts_local.size();
+}
+
+int ParallelTridiagonalSolver::threads() const
+{
+	return pts_pool->size();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef PARALLELTRIDIAGONALSOLVER_H
+#define PARALLELTRIDIAGONALSOLVER_H
+
+#include <vector>
+#include <span>
+#include <memory>
+
+#include "TridiagonalSolver.h"
+#include "ThreadPool.h"
+
+/**
+ * @class ParallelTridiagonalSolver
+ * @brief This class solves a tridiagonal system with the partitioned Thomas algorithm on a thread pool
+ *
+ * The rows are split into one partition per thread. The last row of each partition (except the last one)
+ * is an interface unknown L_p; the other rows of partition p are written x_i = y_i + alpha_i L_{p-1} + beta_i L_p,
+ * where y solves the local system and the spikes alpha and beta are precomputed by factorize(). A solve is
+ * then a parallel local Thomas solve, a serial Thomas solve of the (P-1) interface system, and a parallel update.
+ * Results match TridiagonalSolver within round-off.
+ */
+
+class ParallelTridiagonalSolver
+{
+private:
+	//! Attribute for the threads, one partition per thread
+	std::shared_ptr<ThreadPool> pts_pool;
+	//! Attribute for the number of rows N
+	int pts_size;
+	//! Attribute for the first row of each partition (P + 1 entries, the last one is N)
+	std::vector<int> pts_partitionStart;
+	//! Attribute for the factorized interior rows of each partition
+	std::vector<TridiagonalSolver> pts_local;
+	//! Attribute for the left spike alpha of each row (coefficient of L_{p-1})
+	std::vector<double> pts_alpha;
+	//! Attribute for the right spike beta of each row (coefficient of L_p)
+	std::vector<double> pts_beta;
+	//! Attribute for the lower and upper diagonal coefficients of the interface rows
+	std::vector<double> pts_interfaceLower;
+	std::vector<double> pts_interfaceUpper;
+	//! Attribute for the factorized interface system
+	TridiagonalSolver pts_interface;
+	//! Attribute for the interface right-hand side / solution
+	std::vector<double> pts_interfaceValues;
+
+	//! Interior rows of partition p: [first, last)
+	int interiorFirst(int p) const;
+	int interiorLast(int p) const;
+
+public:
+	/**
+	 * @brief Builds a solver that runs on the given pool.
+	 * @param pool Threads used by factorize() and solve(); the number of partitions is pool->size()
+	 */
+	explicit ParallelTridiagonalSolver(std::shared_ptr<ThreadPool> pool);
+
+	/**
+	 * @brief Splits the matrix in partitions, factorizes them and precomputes the spikes and the interface system.
+	 * Partitions are merged when the matrix is too small to give every thread two rows.
+	 * @param lower_diag Lower diagonal of the tridiagonal matrix
+	 * @param diag Diagonal of the tridiagonal matrix
+	 * @param upper_diag Upper diagonal of the tridiagonal matrix
+	 */
+	void factorize(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag);
+
+	/**
+	 * @brief Solves the system in place: x holds the right-hand side on entry and the solution on exit.
+	 * @param x Right-hand side / solution, of the factorized size
+	 */
+	void solve(std::span<double> x);
+
+	//! Get Methods
+	int size() const;
+	int partitions() const;
+	int threads() const;
+};
+#endif // PARALLELTRIDIAGONALSOLVER_H
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef PRECISION_H
+#define PRECISION_H
+
+/**
+ * @enum Precision
+ * @brief Storage and arithmetic precision of a time-stepping run
+ *
+ * - Double: double storage and arithmetic (default, the reference results).
+ * - Mixed: the explicit schemes store their levels as float and compute each update in double; the implicit schemes
+ *   solve with a float factorization and refine the solution in double, so it keeps double accuracy.
+ * - Float: float storage and arithmetic for the explicit schemes, a float solve without refinement for the implicit ones.
+ * Inputs, outputs and saved states stay double whatever the precision.
+ */
+enum class Precision
+{
+	Double,
+	Mixed,
+	Float
+};
+
+//! Name of a precision as written in a scenario file ("double", "mixed" or "float")
+inline const char *precisionName(Precision precision)
+{
+	switch (precision)
+	{
+	case Precision::Mixed:
+		return "mixed";
+	case Precision::Float:
+		return "float";
+	default:
+		return "double";
+	}
+}
+#endif // PRECISION_H
@@ -0,0 +1,612 @@
+#include "ScenarioRunner.h"
+#include "Initializer.h"
+#include "ExplicitMethods.h"
+#include "ImplicitMethods.h"
+#include "HeatSolver.h"
+#include "SpectralMethods.h"
+#include "ThreadPool.h"
+#include "SolverState.h"
+#include "SnapshotWriter.h"
+#include "CsvExporter.h"
+#include "AnalyticalSolution.h"
+#include "Instrumentation.h"
+
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+
+namespace
+{
+	//! One line of the validation statistics
+	std::string formatNorms(const std::string &label, const AnalyticalSolution::ErrorNorms &norms)
+	{
+		std::ostringstream line;
+		line << label << " error vs analytical: L1 " << norms.l1 << ", L2 " << norms.l2 << ", Linf " << norms.linf;
+		return line.str();
+	}
+
+	//! HeatSolver scheme of a time-stepping scenario (the spectral scenarios do not step)
+	HeatSolver::Scheme heatSolverScheme(ScenarioRunner::Scheme scheme)
+	{
+		switch (scheme)
+		{
+		case ScenarioRunner::Richardson:
+			return HeatSolver::Richardson;
+		case ScenarioRunner::DufortFrankel:
+			return HeatSolver::DufortFrankel;
+		case ScenarioRunner::Laasonen:
+			return HeatSolver::Laasonen;
+		case ScenarioRunner::CrankNicholson:
+			return HeatSolver::CrankNicholson;
+		default:
+			throw std::invalid_argument("Scheme " + ScenarioRunner::schemeName(scheme) + " does not step in time");
+		}
+	}
+}
+
+// Constructor
+ScenarioRunner::ScenarioRunner(double deltax, int numberOfPoint, double tsurf, double tinit, double D)
+	: sr_deltax(deltax), sr_numberOfPoint(numberOfPoint), sr_tsurf(tsurf), sr_tinit(tinit), sr_D(D), sr_threads(ThreadPool::hardwareThreads())
+{
+}
+
+std::string ScenarioRunner::schemeName(Scheme scheme)
+{
+	switch (scheme)
+	{
+	case Richardson:
+		return "richardson";
+	case DufortFrankel:
+		return "dufort_frankel";
+	case Laasonen:
+		return "laasonen";
+	case CrankNicholson:
+		return "crank_nicholson";
+	case Spectral:
+		return "spectral";
+	default:
+		return "laasonen_spectral";
+	}
+}
+
+ScenarioRunner::Scheme ScenarioRunner::parseScheme(const std::string &name)
+{
+	for (Scheme scheme : {Richardson, DufortFrankel, Laasonen, CrankNicholson, Spectral, LaasonenSpectral})
+	{
+		if (schemeName(scheme) == name)
+		{
+			return scheme;
+		}
+	}
+	throw std::invalid_argument("Unknown scheme '" + name + "'");
+}
+
+void ScenarioRunner::loadFile(const std::string &fileName)
+{
+	std::ifstream file(fileName);
+	if (!file)
+	{
+		throw std::runtime_error("Cannot open scenario file '" + fileName + "'");
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		line = line.substr(0, line.find('#'));
+
+		std::istringstream fields(line);
+		std::string key;
+		if (!(fields >> key))
+		{
+			continue;
+		}
+
+		bool valid;
+		if (key == "job")
+		{
+			std::string scheme;
+			Scenario scenario;
+			valid = static_cast<bool>(fields >> scheme >> scenario.deltat >> scenario.t >> scenario.outputFile);
+			if (valid)
+			{
+				scenario.scheme = parseScheme(scheme);
+				addScenario(scenario);
+			}
+		}
+		else if (key == "series")
+		{
+			std::string scheme;
+			std::string precision = "float64";
+			Scenario scenario;
+			valid = static_cast<bool>(fields >> scheme >> scenario.deltat >> scenario.interval >> scenario.t >> scenario.outputFile);
+			if (valid && !(fields >> precision))
+			{
+				precision = "float64";
+			}
+			valid = valid && scenario.interval > 0 && (precision == "float64" || precision == "float32");
+			if (valid)
+			{
+				scenario.scheme = parseScheme(scheme);
+				scenario.singlePrecision = precision == "float32";
+				addScenario(scenario);
+			}
+		}
+		else if (key == "adaptive")
+		{
+			std::string scheme;
+			Scenario scenario;
+			valid = static_cast<bool>(fields >> scheme >> scenario.deltat >> scenario.tolerance >> scenario.t >> scenario.outputFile) && scenario.tolerance > 0;
+			if (valid)
+			{
+				scenario.scheme = parseScheme(scheme);
+				valid = scenario.scheme == Laasonen || scenario.scheme == CrankNicholson;
+			}
+			if (valid)
+			{
+				addScenario(scenario);
+			}
+		}
+		else if (key == "steady")
+		{
+			valid = static_cast<bool>(fields >> sr_steadyTolerance) && sr_steadyTolerance >= 0;
+			if (valid && !(fields >> sr_steadyInterval))
+			{
+				sr_steadyInterval = 10;
+			}
+			valid = valid && sr_steadyInterval > 0;
+		}
+		else if (key == "validate")
+		{
+			sr_validate = true;
+			valid = true;
+		}
+		else if (key == "checkpoint")
+		{
+			valid = static_cast<bool>(fields >> sr_checkpointInterval) && sr_checkpointInterval > 0;
+		}
+		else if (key == "precision")
+		{
+			std::string name;
+			valid = static_cast<bool>(fields >> name);
+			for (Precision precision : {Precision::Double, Precision::Mixed, Precision::Float})
+			{
+				if (valid && name == precisionName(precision))
+				{
+					sr_precision = precision;
+					name.clear();
+				}
+			}
+			valid = valid && name.empty();
+		}
+		else if (key == "deltax")
+		{
+			valid = static_cast<bool>(fields >> sr_deltax);
+		}
+		else if (key == "points")
+		{
+			valid = static_cast<bool>(fields >> sr_numberOfPoint);
+		}
+		else if (key == "tsurf")
+		{
+			valid = static_cast<bool>(fields >> sr_tsurf);
+		}
+		else if (key == "tinit")
+		{
+			valid = static_cast<bool>(fields >> sr_tinit);
+		}
+		else if (key == "D")
+		{
+			valid = static_cast<bool>(fields >> sr_D);
+		}
+		else if (key == "threads")
+		{
+			int threads;
+			valid = static_cast<bool>(fields >> threads);
+			if (valid)
+			{
+				setThreads(threads);
+			}
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			throw std::invalid_argument(fileName + ":" + std::to_string(lineNumber) + ": cannot read '" + line + "'");
+		}
+	}
+}
+
+void ScenarioRunner::addScenario(const Scenario &scenario)
+{
+	sr_scenarios.push_back(scenario);
+}
+
+void ScenarioRunner::setThreads(int numberOfThreads)
+{
+	if (numberOfThreads < 1)
+	{
+		throw std::invalid_argument("The number of threads must be at least 1");
+	}
+	sr_threads = numberOfThreads;
+}
+
+std::vector<std::vector<int>> ScenarioRunner::groupScenarios() const
+{
+	std::vector<std::vector<int>> groups;
+	for (int job = 0; job < static_cast<int>(sr_scenarios.size()); job++)
+	{
+		const Scenario &scenario = sr_scenarios[job];
+		auto group = std::find_if(groups.begin(), groups.end(), [&](const std::vector<int> &members)
+								  {
+			const Scenario &first = sr_scenarios[members.front()];
+			return first.interval == 0 && first.tolerance == 0 && first.scheme == scenario.scheme && first.deltat == scenario.deltat; });
+		if (scenario.interval > 0 || scenario.tolerance > 0 || group == groups.end())
+		{
+			groups.push_back({job});
+		}
+		else
+		{
+			group->push_back(job);
+		}
+	}
+	return groups;
+}
+
+std::string ScenarioRunner::runGroup(const std::vector<int> &jobs) const
+{
+	HEAT_PROFILE_SCOPE("scenario.run");
+	//! Private solver state for this run only
+	const Scenario &first = sr_scenarios[jobs.front()];
+	Initializer values = Initializer(first.deltat, first.t);
+	std::vector<double> temperatureInit = values.getT_values(sr_numberOfPoint, sr_tsurf, sr_tinit);
+	std::unique_ptr<AnalyticalSolution> analytical;
+	if (sr_validate)
+	{
+		analytical = std::make_unique<AnalyticalSolution>(sr_D, sr_tsurf, sr_tinit);
+	}
+
+	if (first.tolerance > 0)
+	{
+		ImplicitMethods::AdaptiveReport report;
+		std::vector<double> temperature = first.scheme == Laasonen
+											  ? ImplicitMethods().laasonenMethodAdaptive(sr_deltax, sr_numberOfPoint, sr_tsurf, sr_tinit, sr_D, values.getDeltat(), first.t, temperatureInit, first.tolerance, &report)
+											  : ImplicitMethods().crankNicholsonMethodAdaptive(sr_deltax, sr_numberOfPoint, sr_tsurf, sr_tinit, sr_D, values.getDeltat(), first.t, temperatureInit, first.tolerance, &report);
+		CsvExporter::write(first.outputFile, temperature);
+
+		std::ostringstream statistics;
+		statistics << report.steps << " steps (" << report.rejectedSteps << " rejected), " << report.solves << " solves, "
+				   << report.factorizations << " factorizations, deltat in [" << report.minDeltat << ", " << report.maxDeltat << "]; fixed deltat: "
+				   << report.fixedSteps << " steps and solves";
+		if (analytical)
+		{
+			statistics << "\n" << formatNorms("t=" + std::to_string(report.endTime), analytical->errorNorms(sr_deltax, temperature, report.endTime));
+		}
+		return statistics.str();
+	}
+
+	std::vector<double> outputTimes;
+	SnapshotObserver write;
+	std::unique_ptr<SnapshotWriter> series;
+	std::vector<int> order;
+	int next = 0;
+	//! Errors against the analytical solution, at the time level the solver actually returns for an output time
+	int firstLevel = first.scheme == Richardson || first.scheme == DufortFrankel ? 1 : 0;
+	std::vector<std::string> validation;
+	AnalyticalSolution::ErrorNorms worst;
+	auto validate = [&](double t, std::span<const double> temperature)
+	{
+		double levelTime = snapshotLevel(t, values.getDeltat(), firstLevel) * values.getDeltat();
+		AnalyticalSolution::ErrorNorms norms = analytical->errorNorms(sr_deltax, temperature, levelTime);
+		if (first.interval > 0)
+		{
+			worst.l1 = std::max(worst.l1, norms.l1);
+			worst.l2 = std::max(worst.l2, norms.l2);
+			worst.linf = std::max(worst.linf, norms.linf);
+		}
+		else
+		{
+			validation.push_back(formatNorms("t=" + std::to_string(t), norms));
+		}
+	};
+	if (first.interval > 0)
+	{
+		//! Series: one frame every interval, streamed to the binary file while the solver keeps stepping
+		int frames = static_cast<int>(std::floor(first.t / first.interval + 1e-9));
+		for (int frame = 1; frame <= frames; frame++)
+		{
+			outputTimes.push_back(frame * first.interval);
+		}
+		series = std::make_unique<SnapshotWriter>(first.outputFile, SnapshotWriter::makeHeader(schemeName(first.scheme), sr_numberOfPoint, sr_deltax, first.deltat, sr_D, sr_tsurf, sr_tinit, first.singlePrecision));
+		write = [&](double t, std::span<const double> temperature)
+		{
+			series->write(t, temperature);
+			if (analytical)
+			{
+				validate(t, temperature);
+			}
+		};
+	}
+	else
+	{
+		for (int job : jobs)
+		{
+			outputTimes.push_back(sr_scenarios[job].t);
+		}
+
+		//! One forward integration, every output time is written as soon as it is reached
+		order = snapshotOrder(outputTimes);
+		write = [&](double t, std::span<const double> temperature)
+		{
+			CsvExporter::write(sr_scenarios[jobs[order[next++]]].outputFile, temperature);
+			if (analytical)
+			{
+				validate(t, temperature);
+			}
+		};
+	}
+
+	bool steady;
+	double stopTime;
+	if (sr_checkpointInterval > 0 && first.interval == 0 && first.scheme != Spectral && first.scheme != LaasonenSpectral)
+	{
+		//! Same levels as the snapshot methods below, on a HeatSolver that saves its state every sr_checkpointInterval levels
+		HeatSolver solver(heatSolverScheme(first.scheme), HeatProblem{sr_deltax, sr_numberOfPoint, sr_tsurf, sr_D, values.getDeltat(), temperatureInit});
+		solver.setSteadyStateDetection(sr_steadyTolerance, sr_steadyInterval);
+		solver.setPrecision(sr_precision);
+		std::string checkpointFile = first.outputFile + ".checkpoint";
+		if (std::filesystem::exists(checkpointFile))
+		{
+			solver.restart(CheckpointReader(checkpointFile));
+			validation.push_back("resumed from " + checkpointFile + " at step " + std::to_string(solver.getLevel()));
+		}
+		CheckpointWriter checkpoint(checkpointFile);
+		solver.setCheckpointing(&checkpoint, sr_checkpointInterval);
+
+		for (int index : order)
+		{
+			int target = snapshotLevel(outputTimes[index], values.getDeltat(), firstLevel);
+			if (target < solver.getLevel())
+			{
+				//! Written before the checkpoint
+				next++;
+				continue;
+			}
+			solver.advance(target - solver.getLevel());
+			write(outputTimes[index], solver.temperature());
+		}
+		//! A completed run starts over next time
+		std::filesystem::remove(checkpointFile);
+		steady = solver.reachedSteadyState();
+		stopTime = solver.getTime();
+		validation.push_back(std::to_string(checkpoint.getCheckpoints()) + " checkpoints written");
+	}
+	else
+	{
+		ExplicitMethods explicitMethods;
+		ImplicitMethods implicitMethods;
+		explicitMethods.setSteadyStateDetection(sr_steadyTolerance, sr_steadyInterval);
+		implicitMethods.setSteadyStateDetection(sr_steadyTolerance, sr_steadyInterval);
+		explicitMethods.setPrecision(sr_precision);
+		implicitMethods.setPrecision(sr_precision);
+		switch (first.scheme)
+		{
+		case Richardson:
+		case DufortFrankel:
+			if (first.scheme == Richardson)
+			{
+				explicitMethods.richardsonMethods(sr_deltax, sr_numberOfPoint, sr_tsurf, sr_tinit, sr_D, values.getDeltat(), outputTimes, temperatureInit, write);
+			}
+			else
+			{
+				explicitMethods.dufort_frankelMethods(sr_deltax, sr_numberOfPoint, sr_tsurf, sr_tinit, sr_D, values.getDeltat(), outputTimes, temperatureInit, write);
+			}
+			steady = explicitMethods.reachedSteadyState();
+			stopTime = explicitMethods.getStopTime();
+			break;
+		case Spectral:
+		case LaasonenSpectral:
+			//! No time stepping, so no steady-state detection either
+			if (first.scheme == Spectral)
+			{
+				SpectralMethods().exponentialMethod(sr_deltax, sr_numberOfPoint, sr_tsurf, sr_tinit, sr_D, values.getDeltat(), outputTimes, temperatureInit, write);
+			}
+			else
+			{
+				SpectralMethods().laasonenMethod(sr_deltax, sr_numberOfPoint, sr_tsurf, sr_tinit, sr_D, values.getDeltat(), outputTimes, temperatureInit, write);
+			}
+			steady = false;
+			stopTime = 0;
+			break;
+		default:
+			if (first.scheme == Laasonen)
+			{
+				implicitMethods.laasonenMethod(sr_deltax, sr_numberOfPoint, sr_tsurf, sr_tinit, sr_D, values.getDeltat(), outputTimes, temperatureInit, write);
+			}
+			else
+			{
+				implicitMethods.crankNicholsonMethod(sr_deltax, sr_numberOfPoint, sr_tsurf, sr_tinit, sr_D, values.getDeltat(), outputTimes, temperatureInit, write);
+			}
+			steady = implicitMethods.reachedSteadyState();
+			stopTime = implicitMethods.getStopTime();
+			break;
+		}
+
+	}
+	if (series)
+	{
+		series->close();
+	}
+	if (analytical && first.interval > 0)
+	{
+		validation.push_back(formatNorms("largest", worst));
+	}
+	if (steady)
+	{
+		validation.insert(validation.begin(), "steady state at t=" + std::to_string(stopTime));
+	}
+	std::string statistics;
+	for (const std::string &line : validation)
+	{
+		statistics += (statistics.empty() ? "" : "\n") + line;
+	}
+	return statistics;
+}
+
+void ScenarioRunner::run()
+{
+	//! Jobs with the same scheme and time step share one integration
+	std::vector<std::vector<int>> groups = groupScenarios();
+	int numberOfGroups = groups.size();
+	int numberOfThreads = std::max(1, std::min(sr_threads, numberOfGroups));
+
+	//! Longest runs first (cost ~ number of time steps up to the last output time, implicit steps weighted for the Thomas sweeps;
+	//! a spectral run costs about one transform per output, some 40 point updates per point)
+	std::vector<double> cost(numberOfGroups, 0.0);
+	for (int group = 0; group < numberOfGroups; group++)
+	{
+		for (int job : groups[group])
+		{
+			const Scenario &scenario = sr_scenarios[job];
+			if (scenario.scheme == Spectral || scenario.scheme == LaasonenSpectral)
+			{
+				cost[group] += 40.0 * sr_numberOfPoint;
+				continue;
+			}
+			double weight = scenario.scheme == Laasonen || scenario.scheme == CrankNicholson ? 4.0 : 1.0;
+			cost[group] = std::max(cost[group], weight * (scenario.t / scenario.deltat) * sr_numberOfPoint);
+		}
+	}
+	std::vector<int> order(numberOfGroups);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+					 { return cost[a] > cost[b]; });
+
+	//! One queue per thread, dealt round-robin; the owner takes from the front, thieves from the back
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<int> groups;
+	};
+	std::vector<WorkQueue> queues(numberOfThreads);
+	for (int rank = 0; rank < numberOfGroups; rank++)
+	{
+		queues[rank % numberOfThreads].groups.push_back(order[rank]);
+	}
+
+	std::vector<double> seconds(numberOfGroups, 0.0);
+	std::vector<std::string> errors(numberOfGroups);
+	std::vector<std::string> statistics(numberOfGroups);
+
+	auto start = std::chrono::steady_clock::now();
+	ThreadPool pool(numberOfThreads);
+	pool.run([&](int thread)
+			 {
+		while (true)
+		{
+			int group = -1;
+			for (int offset = 0; offset < numberOfThreads && group < 0; offset++)
+			{
+				WorkQueue &queue = queues[(thread + offset) % numberOfThreads];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (!queue.groups.empty())
+				{
+					if (offset == 0)
+					{
+						group = queue.groups.front();
+						queue.groups.pop_front();
+					}
+					else
+					{
+						group = queue.groups.back();
+						queue.groups.pop_back();
+					}
+				}
+			}
+
+			//! No run is added while running, so empty queues everywhere means the work is done
+			if (group < 0)
+			{
+				return;
+			}
+
+			auto groupStart = std::chrono::steady_clock::now();
+			try
+			{
+				statistics[group] = runGroup(groups[group]);
+			}
+			catch (const std::exception &error)
+			{
+				errors[group] = error.what();
+			}
+			seconds[group] = std::chrono::duration<double>(std::chrono::steady_clock::now() - groupStart).count();
+		} });
+	double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	double longest = 0;
+	for (int group = 0; group < numberOfGroups; group++)
+	{
+		const Scenario &first = sr_scenarios[groups[group].front()];
+		std::cout << schemeName(first.scheme) << "\tdeltat=" << first.deltat << "\t";
+		if (first.interval > 0)
+		{
+			std::cout << "series every " << first.interval << (first.singlePrecision ? " (float32)" : " (float64)");
+		}
+		else if (first.tolerance > 0)
+		{
+			std::cout << "adaptive, tolerance " << first.tolerance;
+		}
+		else
+		{
+			std::cout << groups[group].size() << " outputs";
+		}
+		std::cout << "\t" << seconds[group] << " s";
+		if (!errors[group].empty())
+		{
+			std::cout << "\tFAILED: " << errors[group];
+		}
+		std::cout << std::endl;
+		std::istringstream lines(statistics[group]);
+		for (std::string line; std::getline(lines, line);)
+		{
+			std::cout << "\t" << line << std::endl;
+		}
+		for (int job : groups[group])
+		{
+			std::cout << "\tt=" << sr_scenarios[job].t << "\t" << sr_scenarios[job].outputFile << std::endl;
+		}
+		longest = std::max(longest, seconds[group]);
+	}
+	std::cout << sr_scenarios.size() << " jobs in " << numberOfGroups << " runs on " << numberOfThreads << " threads: " << wallTime << " s wall time, longest run " << longest << " s" << std::endl;
+
+	for (int group = 0; group < numberOfGroups; group++)
+	{
+		if (!errors[group].empty())
+		{
+			throw std::runtime_error("Run of '" + sr_scenarios[groups[group].front()].outputFile + "' failed: " + errors[group]);
+		}
+	}
+}
+
+// Get functions
+const std::vector<ScenarioRunner::Scenario> &ScenarioRunner::getScenarios() const
+{
+	return sr_scenarios;
+}
+
+int ScenarioRunner::getNumberOfPoint() const
+{
+	return sr_numberOfPoint;
+}
@@ -0,0 +1,149 @@
+#pragma once
+#ifndef SCENARIORUNNER_H
+#define SCENARIORUNNER_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "Precision.h"
+
+/**
+ * @class ScenarioRunner
+ * @brief This class reads a list of simulations from a configuration file and runs them concurrently
+ *
+ * Jobs with the same scheme and time step are grouped into one run that integrates once up to the last
+ * output time and writes each job's file as it passes its time. Every run builds its own ExplicitMethods /
+ * ImplicitMethods object, so no solver state is shared between threads. Runs are sorted by cost (number of
+ * point updates) and dealt to per-thread queues; a thread whose queue is empty steals from the others, so the
+ * wall time approaches the one of the longest run.
+ *
+ * Configuration file format (one entry per line, '#' starts a comment):
+ *   deltax 0.05            grid step
+ *   points 621             number of points
+ *   tsurf 149              temperature at x=0 and x=L
+ *   tinit 38               initial temperature
+ *   D 93                   diffusion coefficient
+ *   threads 4              number of worker threads (default: hardware threads)
+ *   steady 1e-3 [10]       stop each run once max |dT/dt| <= 1e-3, checked every 10 steps (default: off); the
+ *                          outputs after the stop time get the steady temperature
+ *   validate               print the L1, L2 and Linf errors of every output against the analytical solution
+ *                          (AnalyticalSolution), at the time level of the output; for a series, the largest over its frames
+ *   precision mixed        precision of the explicit and implicit runs: double (default), mixed or float (Precision.h)
+ *   checkpoint 100000      write the state of every time-stepping run of jobs to <first output>.checkpoint each 100000
+ *                          time levels (HeatSolver, CheckpointWriter); a run whose checkpoint file exists continues
+ *                          from it, and the file is removed once the run completes (default: off)
+ *   job <scheme> <deltat> <t> <output.csv>
+ *   series <scheme> <deltat> <interval> <t> <output.snap> [float32|float64]
+ *   adaptive <scheme> <deltat> <tolerance> <t> <output.csv>
+ * with <scheme> one of richardson, dufort_frankel, laasonen, crank_nicholson, spectral (exact in time) and
+ * laasonen_spectral (the laasonen result without time stepping), the last two computed by SpectralMethods. A series writes the temperature
+ * every <interval> up to <t> into one binary snapshot file (SnapshotWriter, float64 by default). An adaptive job
+ * (laasonen or crank_nicholson) starts with <deltat> and adjusts the step to the local error <tolerance>; its line in
+ * the summary gives the steps and solves against the fixed-deltat run.
+ */
+
+class ScenarioRunner
+{
+public:
+	//! Schemes a job can use
+	enum Scheme
+	{
+		Richardson,
+		DufortFrankel,
+		Laasonen,
+		CrankNicholson,
+		Spectral,
+		LaasonenSpectral
+	};
+
+	//! One simulation and the file its final temperature (or its time series) is written to
+	struct Scenario
+	{
+		Scheme scheme;
+		double deltat;
+		double t;
+		std::string outputFile;
+		//! Time between two frames of a series, 0 for a single CSV output
+		double interval = 0;
+		//! Series stored as float32 instead of float64
+		bool singlePrecision = false;
+		//! Local error tolerance of an adaptive job, 0 for a fixed deltat
+		double tolerance = 0;
+	};
+
+private:
+	//! Grid and physical parameters shared by all the jobs
+	double sr_deltax;
+	int sr_numberOfPoint;
+	double sr_tsurf;
+	double sr_tinit;
+	double sr_D;
+	//! Number of worker threads
+	int sr_threads;
+	//! Steady-state detection of every run (tolerance on max |dT/dt|, 0 disables it) and interval between checks
+	double sr_steadyTolerance = 0;
+	int sr_steadyInterval = 10;
+	//! Compare every output with the analytical solution
+	bool sr_validate = false;
+	//! Storage and arithmetic precision of the time-stepping runs
+	Precision sr_precision = Precision::Double;
+	//! Time levels between two checkpoints of a run, 0 disables them
+	int sr_checkpointInterval = 0;
+	//! Job list
+	std::vector<Scenario> sr_scenarios;
+
+	/**
+	 * @brief Groups the CSV jobs that share a scheme and a time step, in order of first appearance; every series and
+	 * every adaptive job is its own group.
+	 * @return Indices of the jobs of each group
+	 */
+	std::vector<std::vector<int>> groupScenarios() const;
+
+	/**
+	 * @brief Runs one group with private solver objects: a single integration up to the last output time,
+	 * writing the CSV file of each job when its time is reached.
+	 * @param jobs Indices of the jobs of the group
+	 * @return Statistics printed with the run (those of an adaptive job, the steady-state stop time, the errors against
+	 * the analytical solution), one per line, empty if none
+	 */
+	std::string runGroup(const std::vector<int> &jobs) const;
+
+public:
+	/**
+	 * @brief Builds a runner with default parameters, which the configuration file may override.
+	 * @param deltax Grid step
+	 * @param numberOfPoint Total number of points to discretize
+	 * @param tsurf Temperature at x=0 and x=L
+	 * @param tinit Temperature at t=0
+	 * @param D Coefficient
+	 */
+	ScenarioRunner(double deltax, int numberOfPoint, double tsurf, double tinit, double D);
+
+	/**
+	 * @brief Reads parameters and jobs from a configuration file (format in the class description).
+	 * @param fileName Configuration file
+	 */
+	void loadFile(const std::string &fileName);
+
+	//! Adds one job to the list
+	void addScenario(const Scenario &scenario);
+
+	//! Sets the number of worker threads
+	void setThreads(int numberOfThreads);
+
+	/**
+	 * @brief Runs every group of jobs on the worker threads and prints the time of each run and the total wall time.
+	 */
+	void run();
+
+	//! Get Methods
+	const std::vector<Scenario> &getScenarios() const;
+	int getNumberOfPoint() const;
+
+	//! Name of a scheme as written in the configuration file
+	static std::string schemeName(Scheme scheme);
+	//! Scheme of a configuration file name, throws std::invalid_argument if unknown
+	static Scheme parseScheme(const std::string &name);
+};
+#endif // SCENARIORUNNER_H
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef SNAPSHOTFORMAT_H
+#define SNAPSHOTFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <bit>
+
+/**
+ * @file SnapshotFormat.h
+ * @brief Layout of the binary snapshot files written by SnapshotWriter and read by SnapshotReader
+ *
+ * A file is one 128-byte SnapshotHeader followed by any number of frames. A frame is the time (float64)
+ * followed by numberOfPoint values, all float64 or all float32 as given by the header. Every number is stored
+ * little-endian. The number of frames is not stored: it is the size of the file after the header divided by
+ * the frame size, so a file can be appended to while it is read and a partly written last frame is ignored.
+ */
+
+//! First 8 bytes of every snapshot file
+constexpr char SNAPSHOT_MAGIC[8] = {'H', 'E', 'A', 'T', 'S', 'N', 'A', 'P'};
+//! Format version written in the header
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader
+{
+	//! SNAPSHOT_MAGIC
+	char magic[8];
+	//! SNAPSHOT_VERSION
+	std::uint32_t version;
+	//! Size of one stored value: 8 (float64) or 4 (float32)
+	std::uint32_t valueBytes;
+	//! Number of values per frame
+	std::uint64_t numberOfPoint;
+	//! Grid step, time step and physical parameters of the run
+	double deltax;
+	double deltat;
+	double D;
+	double tsurf;
+	double tinit;
+	//! Scheme name, zero-padded
+	char scheme[32];
+	//! Reserved, zero
+	char padding[32];
+};
+static_assert(sizeof(SnapshotHeader) == 128, "SnapshotHeader must stay 128 bytes");
+
+//! Size in bytes of one frame (time + values)
+inline std::uint64_t snapshotFrameBytes(const SnapshotHeader &header)
+{
+	return sizeof(double) + header.numberOfPoint * header.valueBytes;
+}
+
+//! Converts a 4 or 8 byte value between host and little-endian order (no-op on little-endian hosts)
+template <class T>
+inline T snapshotLittleEndian(T value)
+{
+	static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Only 32 and 64-bit values are stored");
+	if constexpr (std::endian::native == std::endian::big)
+	{
+		unsigned char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		for (std::size_t i = 0; i < sizeof(T) / 2; i++)
+		{
+			unsigned char swap = bytes[i];
+			bytes[i] = bytes[sizeof(T) - 1 - i];
+			bytes[sizeof(T) - 1 - i] = swap;
+		}
+		std::memcpy(&value, bytes, sizeof(T));
+	}
+	return value;
+}
+#endif // SNAPSHOTFORMAT_H
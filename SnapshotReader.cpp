@@ -0,0 +1,136 @@
+#include "SnapshotReader.h"
+
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SnapshotReader::SnapshotReader(const std::string &fileName) : srd_fileName(fileName)
+{
+	refresh();
+}
+
+SnapshotReader::~SnapshotReader()
+{
+	unmap();
+}
+
+void SnapshotReader::unmap()
+{
+	if (srd_data)
+	{
+		munmap(const_cast<char *>(srd_data), srd_length);
+		srd_data = nullptr;
+		srd_length = 0;
+	}
+	srd_frames = 0;
+}
+
+void SnapshotReader::refresh()
+{
+	unmap();
+
+	int descriptor = open(srd_fileName.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		throw std::runtime_error("Cannot open snapshot file '" + srd_fileName + "'");
+	}
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(SnapshotHeader)))
+	{
+		::close(descriptor);
+		throw std::runtime_error("'" + srd_fileName + "' is too short to be a snapshot file");
+	}
+
+	void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+	::close(descriptor);
+	if (mapping == MAP_FAILED)
+	{
+		throw std::runtime_error("Cannot map snapshot file '" + srd_fileName + "'");
+	}
+	srd_data = static_cast<const char *>(mapping);
+	srd_length = status.st_size;
+
+	std::memcpy(&srd_header, srd_data, sizeof(SnapshotHeader));
+	srd_header.version = snapshotLittleEndian(srd_header.version);
+	srd_header.valueBytes = snapshotLittleEndian(srd_header.valueBytes);
+	srd_header.numberOfPoint = snapshotLittleEndian(srd_header.numberOfPoint);
+	for (double *value : {&srd_header.deltax, &srd_header.deltat, &srd_header.D, &srd_header.tsurf, &srd_header.tinit})
+	{
+		*value = snapshotLittleEndian(*value);
+	}
+
+	if (std::memcmp(srd_header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || srd_header.version != SNAPSHOT_VERSION ||
+		(srd_header.valueBytes != 4 && srd_header.valueBytes != 8) || srd_header.numberOfPoint == 0)
+	{
+		unmap();
+		throw std::runtime_error("'" + srd_fileName + "' is not a snapshot file of version " + std::to_string(SNAPSHOT_VERSION));
+	}
+
+	//! A partly written last frame is not counted
+	srd_frames = (srd_length - sizeof(SnapshotHeader)) / snapshotFrameBytes(srd_header);
+}
+
+const char *SnapshotReader::frameData(long frame) const
+{
+	if (frame < 0 || frame >= srd_frames)
+	{
+		throw std::out_of_range("Snapshot frame " + std::to_string(frame) + " out of " + std::to_string(srd_frames));
+	}
+	return srd_data + sizeof(SnapshotHeader) + frame * snapshotFrameBytes(srd_header);
+}
+
+double SnapshotReader::time(long frame) const
+{
+	double t;
+	std::memcpy(&t, frameData(frame), sizeof(double));
+	return snapshotLittleEndian(t);
+}
+
+void SnapshotReader::read(long frame, std::vector<double> &values) const
+{
+	const char *in = frameData(frame) + sizeof(double);
+	values.resize(srd_header.numberOfPoint);
+	for (std::size_t i = 0; i < values.size(); i++)
+	{
+		if (srd_header.valueBytes == 8)
+		{
+			double value;
+			std::memcpy(&value, in + i * sizeof(double), sizeof(double));
+			values[i] = snapshotLittleEndian(value);
+		}
+		else
+		{
+			float value;
+			std::memcpy(&value, in + i * sizeof(float), sizeof(float));
+			values[i] = snapshotLittleEndian(value);
+		}
+	}
+}
+
+std::span<const double> SnapshotReader::values(long frame) const
+{
+	if (srd_header.valueBytes != 8 || std::endian::native != std::endian::little)
+	{
+		throw std::logic_error("Only float64 frames on little-endian hosts can be viewed in place, use read()");
+	}
+	//! The header and every float64 frame are multiples of 8 bytes, so the values are aligned in the page-aligned mapping
+	return std::span<const double>(reinterpret_cast<const double *>(frameData(frame) + sizeof(double)), srd_header.numberOfPoint);
+}
+
+// Get functions
+const SnapshotHeader &SnapshotReader::getHeader() const
+{
+	return srd_header;
+}
+
+long SnapshotReader::getFrames() const
+{
+	return srd_frames;
+}
+
+std::string SnapshotReader::getScheme() const
+{
+	return std::string(srd_header.scheme, strnlen(srd_header.scheme, sizeof(srd_header.scheme)));
+}
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef SNAPSHOTREADER_H
+#define SNAPSHOTREADER_H
+
+#include <string>
+#include <vector>
+#include <span>
+
+#include "SnapshotFormat.h"
+
+/**
+ * @class SnapshotReader
+ * @brief Reads a binary snapshot file (SnapshotFormat.h) through a read-only memory mapping
+ *
+ * Nothing is copied when the file is opened: frames are read from the mapping on demand. float64 frames can be
+ * viewed in place with values(); read() converts any frame to doubles. refresh() maps the frames appended since
+ * the file was opened.
+ */
+
+class SnapshotReader
+{
+private:
+	//! Header of the file (host byte order)
+	SnapshotHeader srd_header;
+	//! Mapped file and its length
+	const char *srd_data = nullptr;
+	std::size_t srd_length = 0;
+	//! Number of complete frames in the mapping
+	long srd_frames = 0;
+	std::string srd_fileName;
+
+	//! Start of a frame in the mapping, throws std::out_of_range for a bad index
+	const char *frameData(long frame) const;
+
+	//! Releases the mapping
+	void unmap();
+
+public:
+	/**
+	 * @brief Maps the file and checks its header, throws std::runtime_error if it is not a snapshot file.
+	 * @param fileName Snapshot file
+	 */
+	explicit SnapshotReader(const std::string &fileName);
+	~SnapshotReader();
+
+	SnapshotReader(const SnapshotReader &) = delete;
+	SnapshotReader &operator=(const SnapshotReader &) = delete;
+
+	//! Maps the file again to see the frames written since it was opened
+	void refresh();
+
+	//! Time of a frame
+	double time(long frame) const;
+
+	/**
+	 * @brief Copies a frame into a vector of doubles (float32 values are widened).
+	 * @param frame Frame index, 0 to getFrames() - 1
+	 * @param values Resized to numberOfPoint
+	 */
+	void read(long frame, std::vector<double> &values) const;
+
+	/**
+	 * @brief Zero-copy view of a float64 frame, valid until refresh() or destruction.
+	 * Throws std::logic_error for float32 files or on big-endian hosts, where read() must be used.
+	 * @param frame Frame index, 0 to getFrames() - 1
+	 */
+	std::span<const double> values(long frame) const;
+
+	//! Get Methods
+	const SnapshotHeader &getHeader() const;
+	long getFrames() const;
+	//! Scheme name stored in the header
+	std::string getScheme() const;
+};
+#endif // SNAPSHOTREADER_H
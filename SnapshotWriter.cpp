@@ -0,0 +1,245 @@
+#include "SnapshotWriter.h"
+
+#include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+
+#include "Instrumentation.h"
+
+SnapshotWriter::SnapshotWriter(const std::string &fileName, const SnapshotHeader &header, bool append, int maxPendingFrames)
+	: sw_header(header), sw_maxPendingFrames(std::max(1, maxPendingFrames))
+{
+	if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || (header.valueBytes != 4 && header.valueBytes != 8) || header.numberOfPoint == 0)
+	{
+		throw std::invalid_argument("Invalid snapshot header, build it with SnapshotWriter::makeHeader");
+	}
+
+	//! The header stored on disk, little-endian
+	SnapshotHeader stored = header;
+	stored.version = snapshotLittleEndian(stored.version);
+	stored.valueBytes = snapshotLittleEndian(stored.valueBytes);
+	stored.numberOfPoint = snapshotLittleEndian(stored.numberOfPoint);
+	for (double *value : {&stored.deltax, &stored.deltat, &stored.D, &stored.tsurf, &stored.tinit})
+	{
+		*value = snapshotLittleEndian(*value);
+	}
+
+	std::error_code error;
+	std::uintmax_t size = append ? std::filesystem::file_size(fileName, error) : 0;
+	if (append && !error && size >= sizeof(SnapshotHeader))
+	{
+		SnapshotHeader existing;
+		std::ifstream input(fileName, std::ios::binary);
+		input.read(reinterpret_cast<char *>(&existing), sizeof(existing));
+		if (!input || std::memcmp(existing.magic, stored.magic, sizeof(existing.magic)) != 0 || existing.valueBytes != stored.valueBytes || existing.numberOfPoint != stored.numberOfPoint)
+		{
+			throw std::runtime_error("Cannot append to '" + fileName + "': not a snapshot file with the same layout");
+		}
+		input.close();
+
+		//! Drop a partly written last frame
+		std::uint64_t frameBytes = snapshotFrameBytes(header);
+		std::uintmax_t complete = sizeof(SnapshotHeader) + (size - sizeof(SnapshotHeader)) / frameBytes * frameBytes;
+		if (complete != size)
+		{
+			std::filesystem::resize_file(fileName, complete);
+		}
+		sw_file.open(fileName, std::ios::binary | std::ios::app);
+	}
+	else
+	{
+		sw_file.open(fileName, std::ios::binary | std::ios::trunc);
+		sw_file.write(reinterpret_cast<const char *>(&stored), sizeof(stored));
+	}
+
+	if (!sw_file)
+	{
+		throw std::runtime_error("Cannot open snapshot file '" + fileName + "'");
+	}
+
+	sw_thread = std::thread(&SnapshotWriter::writerLoop, this);
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+}
+
+SnapshotHeader SnapshotWriter::makeHeader(const std::string &scheme, int numberOfPoint, double deltax, double deltat, double D, double tsurf, double tinit, bool singlePrecision)
+{
+	SnapshotHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	header.version = SNAPSHOT_VERSION;
+	header.valueBytes = singlePrecision ? 4 : 8;
+	header.numberOfPoint = numberOfPoint;
+	header.deltax = deltax;
+	header.deltat = deltat;
+	header.D = D;
+	header.tsurf = tsurf;
+	header.tinit = tinit;
+	std::memcpy(header.scheme, scheme.data(), std::min(scheme.size(), sizeof(header.scheme) - 1));
+	return header;
+}
+
+void SnapshotWriter::writerLoop()
+{
+	std::unique_lock<std::mutex> lock(sw_mutex);
+	while (true)
+	{
+		sw_queued.wait(lock, [&]
+					   { return !sw_pending.empty() || sw_closing; });
+		if (sw_pending.empty())
+		{
+			break;
+		}
+
+		std::vector<char> frame = std::move(sw_pending.front());
+		sw_pending.pop_front();
+		sw_busy = true;
+
+		//! The file is written without holding the lock, so write() keeps queueing meanwhile
+		lock.unlock();
+		bool failed = false;
+		if (!sw_error)
+		{
+			HEAT_PROFILE_SCOPE("output.snapshot_io");
+			sw_file.write(frame.data(), frame.size());
+			failed = !sw_file;
+		}
+		lock.lock();
+
+		if (failed && !sw_error)
+		{
+			sw_error = std::make_exception_ptr(std::runtime_error("Error while writing a snapshot frame"));
+		}
+		sw_free.push_back(std::move(frame));
+		sw_busy = false;
+		sw_written.notify_all();
+	}
+	sw_file.flush();
+	if (!sw_file && !sw_error)
+	{
+		sw_error = std::make_exception_ptr(std::runtime_error("Error while closing the snapshot file"));
+	}
+}
+
+void SnapshotWriter::checkError()
+{
+	if (sw_error)
+	{
+		std::rethrow_exception(sw_error);
+	}
+}
+
+void SnapshotWriter::write(double t, std::span<const double> values)
+{
+	if (values.size() != sw_header.numberOfPoint)
+	{
+		throw std::invalid_argument("A snapshot frame must have numberOfPoint values");
+	}
+
+	std::vector<char> frame;
+	{
+		std::unique_lock<std::mutex> lock(sw_mutex);
+		checkError();
+		if (sw_closing)
+		{
+			throw std::logic_error("The snapshot writer is closed");
+		}
+		//! Back-pressure: wait while too many frames are queued
+		sw_written.wait(lock, [&]
+						{ return static_cast<int>(sw_pending.size()) < sw_maxPendingFrames || sw_error; });
+		checkError();
+		if (!sw_free.empty())
+		{
+			frame = std::move(sw_free.back());
+			sw_free.pop_back();
+		}
+	}
+
+	//! Encode outside the lock
+	HEAT_PROFILE_SCOPE("output.snapshot_encode");
+	frame.resize(snapshotFrameBytes(sw_header));
+	char *out = frame.data();
+	double time = snapshotLittleEndian(t);
+	std::memcpy(out, &time, sizeof(double));
+	out += sizeof(double);
+	if (sw_header.valueBytes == 8)
+	{
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			std::memcpy(out, values.data(), values.size_bytes());
+		}
+		else
+		{
+			for (std::size_t i = 0; i < values.size(); i++)
+			{
+				double value = snapshotLittleEndian(values[i]);
+				std::memcpy(out + i * sizeof(double), &value, sizeof(double));
+			}
+		}
+	}
+	else
+	{
+		for (std::size_t i = 0; i < values.size(); i++)
+		{
+			float value = snapshotLittleEndian(static_cast<float>(values[i]));
+			std::memcpy(out + i * sizeof(float), &value, sizeof(float));
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sw_mutex);
+		sw_pending.push_back(std::move(frame));
+		sw_frames++;
+	}
+	sw_queued.notify_one();
+}
+
+void SnapshotWriter::flush()
+{
+	std::unique_lock<std::mutex> lock(sw_mutex);
+	sw_written.wait(lock, [&]
+					{ return (sw_pending.empty() && !sw_busy) || sw_error || !sw_thread.joinable(); });
+	checkError();
+	if (sw_thread.joinable())
+	{
+		//! Only the writer thread touches the stream, and it is idle now
+		sw_file.flush();
+	}
+}
+
+void SnapshotWriter::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(sw_mutex);
+		sw_closing = true;
+	}
+	sw_queued.notify_one();
+	if (sw_thread.joinable())
+	{
+		sw_thread.join();
+		sw_file.close();
+	}
+
+	std::lock_guard<std::mutex> lock(sw_mutex);
+	checkError();
+}
+
+// Get functions
+const SnapshotHeader &SnapshotWriter::getHeader() const
+{
+	return sw_header;
+}
+
+long SnapshotWriter::getFrames() const
+{
+	return sw_frames;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef SNAPSHOTWRITER_H
+#define SNAPSHOTWRITER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <span>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#include "SnapshotFormat.h"
+
+/**
+ * @class SnapshotWriter
+ * @brief Appends snapshot frames to a binary file (SnapshotFormat.h) from a background thread
+ *
+ * write() converts the values into a frame buffer and returns; a writer thread empties the queue into the file,
+ * so output overlaps the time stepping. At most maxPendingFrames frames wait in memory: write() blocks when the
+ * disk falls behind. Frame buffers are recycled, so a steady stream does not allocate. An I/O error on the writer
+ * thread is thrown by the next write(), flush() or close().
+ */
+
+class SnapshotWriter
+{
+private:
+	//! Header of the file (host byte order)
+	SnapshotHeader sw_header;
+	//! Output stream, only used by the writer thread after construction
+	std::ofstream sw_file;
+	//! Encoded frames waiting for the writer thread
+	std::deque<std::vector<char>> sw_pending;
+	//! Buffers already written, reused by the next frames
+	std::vector<std::vector<char>> sw_free;
+	//! Maximum number of frames waiting in memory
+	int sw_maxPendingFrames;
+	//! Number of frames handed to write()
+	long sw_frames = 0;
+	//! true while the writer thread is writing a frame it took from the queue
+	bool sw_busy = false;
+	//! Set by close() to stop the writer thread
+	bool sw_closing = false;
+	//! First error of the writer thread
+	std::exception_ptr sw_error;
+
+	std::mutex sw_mutex;
+	//! Signalled when a frame is queued or the writer is closing
+	std::condition_variable sw_queued;
+	//! Signalled when the writer thread finished a frame
+	std::condition_variable sw_written;
+	std::thread sw_thread;
+
+	//! Body of the writer thread
+	void writerLoop();
+
+	//! Throws the writer thread error, if any (sw_mutex held)
+	void checkError();
+
+public:
+	/**
+	 * @brief Opens the file and starts the writer thread.
+	 * @param fileName Snapshot file
+	 * @param header Run description, see makeHeader
+	 * @param append If true and the file exists, new frames go after the existing ones (the headers must agree)
+	 * @param maxPendingFrames Maximum number of frames queued in memory before write() blocks
+	 */
+	SnapshotWriter(const std::string &fileName, const SnapshotHeader &header, bool append = false, int maxPendingFrames = 8);
+
+	//! Writes the pending frames and closes the file (errors are lost, call close() to see them)
+	~SnapshotWriter();
+
+	SnapshotWriter(const SnapshotWriter &) = delete;
+	SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+	/**
+	 * @brief Builds a header for a run.
+	 * @param scheme Scheme name (at most 31 characters are kept)
+	 * @param numberOfPoint Number of values per frame
+	 * @param deltax Grid step
+	 * @param deltat Time step
+	 * @param D Coefficient
+	 * @param tsurf Temperature at x=0 and x=L
+	 * @param tinit Temperature at t=0
+	 * @param singlePrecision Store float32 values instead of float64
+	 */
+	static SnapshotHeader makeHeader(const std::string &scheme, int numberOfPoint, double deltax, double deltat, double D, double tsurf, double tinit, bool singlePrecision = false);
+
+	/**
+	 * @brief Queues one frame; the values are copied (and rounded to float32 if selected) before returning.
+	 * @param t Time of the frame
+	 * @param values numberOfPoint values
+	 */
+	void write(double t, std::span<const double> values);
+
+	//! Waits until every queued frame is in the file
+	void flush();
+
+	//! Writes the pending frames, stops the writer thread and closes the file
+	void close();
+
+	//! Get Methods
+	const SnapshotHeader &getHeader() const;
+	long getFrames() const;
+};
+#endif // SNAPSHOTWRITER_H
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef SOLVERSTATE_H
+#define SOLVERSTATE_H
+
+#include <vector>
+#include <span>
+#include <functional>
+#include <numeric>
+#include <algorithm>
+
+/**
+ * @struct SolverState
+ * @brief State of a run that can be resumed: the current time level and, for the three-level schemes, the previous one
+ *
+ * A state is filled at the end of a snapshot run. Passing it back to the same scheme with the same grid and time step
+ * continues the integration from 'step' instead of restarting from the initial distribution.
+ */
+
+struct SolverState
+{
+	//! Time level of 'current', counted from the initial distribution (0 = nothing computed yet)
+	int step = 0;
+	//! Level step-1, only used by the Richardson and Dufort-Frankel schemes
+	std::vector<double> previous;
+	//! Level step
+	std::vector<double> current;
+};
+
+/**
+ * @brief Called once per requested output time with that time and the temperature at that time.
+ * The span points into the solver workspace: it is only valid during the call.
+ */
+typedef std::function<void(double t, std::span<const double> temperature)> SnapshotObserver;
+
+/**
+ * @brief Time level that the single-time methods return for a final time t (numStep = t / deltat time steps,
+ * of which the last one is not taken), so that snapshots match them exactly.
+ * @param t Output time
+ * @param deltat Time step
+ * @param firstLevel Lowest level a run can return (1 for the three-level schemes, which always take the FTCS step)
+ */
+inline int snapshotLevel(double t, double deltat, int firstLevel)
+{
+	int numStep = static_cast<int>(t / deltat);
+	return numStep - 1 > firstLevel ? numStep - 1 : firstLevel;
+}
+
+/**
+ * @brief Indices of the output times in the order a snapshot run visits them (increasing time, ties in input order)
+ * @param outputTimes Requested output times
+ */
+inline std::vector<int> snapshotOrder(const std::vector<double> &outputTimes)
+{
+	std::vector<int> order(outputTimes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+					 { return outputTimes[a] < outputTimes[b]; });
+	return order;
+}
+#endif // SOLVERSTATE_H
@@ -0,0 +1,154 @@
+#include "SpectralMethods.h"
+#include "CsvExporter.h"
+#include "Instrumentation.h"
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+void SpectralMethods::runSnapshots(Propagator propagator, double deltax, int numberOfPoint, double tsurf, double D, double deltat, const std::vector<double> &outputTimes,
+								   const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state)
+{
+	//! Unknowns: points 1 .. N - 2 for the exact propagator, all N points (tsurf outside them) for Laasonen
+	int first = propagator == Exponential ? 1 : 0;
+	int size = propagator == Exponential ? numberOfPoint - 2 : numberOfPoint;
+	if (size < 1)
+	{
+		throw std::invalid_argument("The spectral methods need at least three points");
+	}
+
+	int level = 0;
+	const std::vector<double> *start = &temperatureInit;
+	if (state && state->step > 0)
+	{
+		if (state->current.size() != static_cast<std::size_t>(numberOfPoint))
+		{
+			throw std::invalid_argument("The saved state does not match numberOfPoint");
+		}
+		level = state->step;
+		start = &state->current;
+	}
+	else if (temperatureInit.size() != static_cast<std::size_t>(numberOfPoint))
+	{
+		throw std::invalid_argument("temperatureInit must have numberOfPoint values");
+	}
+
+	//! Sine coefficients of the starting deviation, computed once for all the output times
+	sm_transform.plan(size);
+	sm_coefficients.resize(size);
+	sm_work.resize(size);
+	for (int j = 0; j < size; j++)
+	{
+		sm_coefficients[j] = (*start)[first + j] - tsurf;
+	}
+	{
+		HEAT_PROFILE_SCOPE("spectral.decompose");
+		sm_transform.transform(sm_coefficients);
+	}
+
+	//! Mode k decays as exp(-rate_k * steps): rate_k = 4 D deltat / deltax^2 sin^2(pi k / 2 (size + 1)) for the exact
+	//! propagator, log(1 + 4 theta sin^2(...)) for Laasonen
+	double theta = D * (deltat / (deltax * deltax));
+	sm_rates.resize(size);
+	for (int k = 1; k <= size; k++)
+	{
+		double sine = std::sin(std::numbers::pi * k / (2.0 * (size + 1)));
+		sm_rates[k - 1] = propagator == Exponential ? 4 * theta * sine * sine : std::log1p(4 * theta * sine * sine);
+	}
+	//! The inverse transform carries the factor 2 / (size + 1)
+	double normalization = 2.0 / (size + 1);
+
+	sm_temperature.assign(numberOfPoint, tsurf);
+	int outputLevel = level;
+	for (int index : snapshotOrder(outputTimes))
+	{
+		outputLevel = snapshotLevel(outputTimes[index], deltat, 0);
+		if (outputLevel < level)
+		{
+			throw std::invalid_argument("Output time " + std::to_string(outputTimes[index]) + " is before the resumed state");
+		}
+		int steps = outputLevel - level;
+
+		{
+			HEAT_PROFILE_SCOPE("spectral.compose");
+			for (int k = 0; k < size; k++)
+			{
+				sm_work[k] = normalization * std::exp(-sm_rates[k] * steps) * sm_coefficients[k];
+			}
+			sm_transform.transform(sm_work);
+			for (int j = 0; j < size; j++)
+			{
+				sm_temperature[first + j] = tsurf + sm_work[j];
+			}
+		}
+
+		if (observer)
+		{
+			HEAT_PROFILE_SCOPE("output.observer");
+			observer(outputTimes[index], std::span<const double>(sm_temperature.data(), numberOfPoint));
+		}
+	}
+
+	//! Checkpoint for a later resume
+	if (state && !outputTimes.empty())
+	{
+		state->step = outputLevel;
+		state->previous.clear();
+		state->current = sm_temperature;
+	}
+}
+
+std::vector<double> SpectralMethods::exponentialMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit)
+{
+	std::vector<double> temperature;
+	runSnapshots(Exponential, deltax, numberOfPoint, tsurf, D, deltat, {t}, temperatureInit, [&](double, std::span<const double> values)
+				 { temperature.assign(values.begin(), values.end()); }, nullptr);
+	return temperature;
+}
+
+std::vector<double> SpectralMethods::laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit)
+{
+	std::vector<double> temperature;
+	runSnapshots(Laasonen, deltax, numberOfPoint, tsurf, D, deltat, {t}, temperatureInit, [&](double, std::span<const double> values)
+				 { temperature.assign(values.begin(), values.end()); }, nullptr);
+	return temperature;
+}
+
+void SpectralMethods::exponentialMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+										const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state)
+{
+	runSnapshots(Exponential, deltax, numberOfPoint, tsurf, D, deltat, outputTimes, temperatureInit, observer, state);
+}
+
+std::vector<std::vector<double>> SpectralMethods::exponentialMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+																	const std::vector<double> &temperatureInit, SolverState *state)
+{
+	std::vector<std::vector<double>> snapshots(outputTimes.size());
+	std::vector<int> order = snapshotOrder(outputTimes);
+	int next = 0;
+	exponentialMethod(deltax, numberOfPoint, tsurf, tinit, D, deltat, outputTimes, temperatureInit, [&](double, std::span<const double> temperature)
+					  { snapshots[order[next++]].assign(temperature.begin(), temperature.end()); }, state);
+	return snapshots;
+}
+
+void SpectralMethods::laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+									 const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state)
+{
+	runSnapshots(Laasonen, deltax, numberOfPoint, tsurf, D, deltat, outputTimes, temperatureInit, observer, state);
+}
+
+std::vector<std::vector<double>> SpectralMethods::laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+																 const std::vector<double> &temperatureInit, SolverState *state)
+{
+	std::vector<std::vector<double>> snapshots(outputTimes.size());
+	std::vector<int> order = snapshotOrder(outputTimes);
+	int next = 0;
+	laasonenMethod(deltax, numberOfPoint, tsurf, tinit, D, deltat, outputTimes, temperatureInit, [&](double, std::span<const double> temperature)
+				   { snapshots[order[next++]].assign(temperature.begin(), temperature.end()); }, state);
+	return snapshots;
+}
+
+void SpectralMethods::saveCSV(const std::string &fileName, const std::vector<double> &temperature)
+{
+	CsvExporter::write(fileName, temperature);
+}
@@ -0,0 +1,139 @@
+#pragma once
+#ifndef SPECTRALMETHODS_H
+#define SPECTRALMETHODS_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <span>
+
+#include "FastSineTransform.h"
+#include "SolverState.h"
+
+/**
+ * @class SpectralMethods
+ * @brief This class solves the constant-coefficient problem in the sine basis, without time stepping
+ *
+ * With constant D, a uniform grid and tsurf at both ends, the discrete Laplacian is diagonalized by the DST-I
+ * (FastSineTransform): T(t) = tsurf + S^-1 diag(g_k(t)) S (T(0) - tsurf). Any output time costs one transform, and a
+ * run with several output times transforms the initial distribution once and each output once, whatever t / deltat.
+ *
+ * Two propagators g_k are available:
+ * - exponentialMethod: exp(-4 D / deltax^2 sin^2(pi k / 2 (N - 1)) t), the exact solution of the semi-discrete
+ *   equations with points 0 and N - 1 held at tsurf; no time discretization error.
+ * - laasonenMethod: (1 + 4 theta sin^2(pi k / 2 (N + 1)))^-steps, theta = D deltat / deltax^2, the amplification of
+ *   ImplicitMethods::laasonenMethod. That method solves for all N points with tsurf just outside them, so the basis
+ *   has N sines; the result equals its result to rounding.
+ * Both return the temperature at the time level of the implicit methods, (t / deltat - 1) deltat (snapshotLevel), so
+ * the outputs can be compared one to one. The Crank-Nicholson matrix of ImplicitMethods is not symmetric in its last
+ * row and has no sine basis.
+ */
+
+class SpectralMethods
+{
+public:
+	//! Growth factors of the sine modes
+	enum Propagator
+	{
+		Exponential,
+		Laasonen
+	};
+
+private:
+	//! Attribute for the sine transform, planned for the number of unknowns of the propagator
+	FastSineTransform sm_transform;
+	//! Attribute for the sine coefficients of the starting deviation T - tsurf
+	std::vector<double> sm_coefficients;
+	//! Attribute for the decay of each mode per time step, exp(-rate) being its growth factor
+	std::vector<double> sm_rates;
+	//! Attribute for the coefficients of an output time, transformed back in place
+	std::vector<double> sm_work;
+	//! Attribute for the temperature passed to the observer
+	std::vector<double> sm_temperature;
+
+	/**
+	 * @brief Single run that calls the observer at every output time (in increasing order): transforms the starting
+	 * distribution (the initial one or a saved state) once, then each output time once.
+	 * @param propagator Growth factors used
+	 * @param deltax Grid step
+	 * @param numberOfPoint Total number of points to discretize
+	 * @param tsurf Temperature at x=0 and x=L
+	 * @param D Coefficient
+	 * @param deltat Time step, which sets the time levels of the outputs
+	 * @param outputTimes Times at which the observer is called
+	 * @param temperatureInit Initial temperature distribution vector (ignored when resuming)
+	 * @param observer Called with each output time and the temperature at that time
+	 * @param state If not null and state->step > 0, run resumed from it; filled with the last output on return
+	 */
+	void runSnapshots(Propagator propagator, double deltax, int numberOfPoint, double tsurf, double D, double deltat, const std::vector<double> &outputTimes,
+					  const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state);
+
+public:
+	//! Methods
+	/**
+	 * @brief Exact time integration of the semi-discrete heat equation, see the class description.
+	 * @param deltax Grid step.
+	 * @param numberOfPoint Total number of points to discretize.
+	 * @param tsurf  Temperature at x=0 and x=L
+	 * @param tinit Temperature at t=0
+	 * @param D Coefficient.
+	 * @param deltat Time step, only used to place t on the time levels of the other methods.
+	 * @param t Total simulation time.
+	 * @param temperatureInit Initial temperature distribution vector.
+	 * @return The temperature distribution at time (t / deltat - 1) deltat.
+	 */
+	std::vector<double> exponentialMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit);
+
+	/**
+	 * @brief Laasonen scheme evaluated in the sine basis: same result as ImplicitMethods::laasonenMethod, in one transform each way.
+	 * @param deltax Grid step.
+	 * @param numberOfPoint Total number of points to discretize.
+	 * @param tsurf  Temperature at x=0 and x=L
+	 * @param tinit Temperature at t=0
+	 * @param D Coefficient.
+	 * @param deltat Time step.
+	 * @param t Total simulation time.
+	 * @param temperatureInit Initial temperature distribution vector.
+	 * @return The final temperature distribution at time t.
+	 */
+	std::vector<double> laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, double t, const std::vector<double> &temperatureInit);
+
+	//! Snapshot Methods
+	/**
+	 * @brief Exact time integration with several output times; each output costs one transform.
+	 * The temperature passed for time t is identical to exponentialMethod(..., t, ...).
+	 * @param state If not null, resumes from it when state->step > 0 and receives the last output (checkpoint).
+	 */
+	void exponentialMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+						   const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state = nullptr);
+
+	/**
+	 * @brief Same as the observer version, returning one temperature distribution per output time (in the order given).
+	 */
+	std::vector<std::vector<double>> exponentialMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+													   const std::vector<double> &temperatureInit, SolverState *state = nullptr);
+
+	/**
+	 * @brief Laasonen scheme in the sine basis with several output times; each output costs one transform.
+	 * The temperature passed for time t is identical to laasonenMethod(..., t, ...).
+	 * @param state If not null, resumes from it when state->step > 0 and receives the last output (checkpoint).
+	 */
+	void laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+						const std::vector<double> &temperatureInit, const SnapshotObserver &observer, SolverState *state = nullptr);
+
+	/**
+	 * @brief Same as the observer version, returning one temperature distribution per output time (in the order given).
+	 */
+	std::vector<std::vector<double>> laasonenMethod(double deltax, int numberOfPoint, double tsurf, double tinit, double D, double deltat, const std::vector<double> &outputTimes,
+													const std::vector<double> &temperatureInit, SolverState *state = nullptr);
+
+	//! Write Methods
+
+	/**
+	 * @brief Saves the values of the vector to a CSV file (CsvExporter, full double precision).
+	 * @param fileName Name of the CSV file.
+	 * @param temperature Vector to be filled in the CSV file.
+	 */
+	void saveCSV(const std::string &fileName, const std::vector<double> &temperature);
+};
+#endif // SPECTRALMETHODS_H
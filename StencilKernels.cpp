@@ -0,0 +1,544 @@
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STENCIL_KERNELS_X86 1
+//! The stencils and vector helpers are always inlined into the AVX2 / AVX-512 kernels, no vector crosses a call boundary
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+#include "StencilKernels.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace StencilKernels
+{
+	namespace
+	{
+		//! Signature of a kernel specialized for one stencil, one storage type and one instruction set
+		template <class Stencil, class Storage>
+		using Kernel = void (*)(const Stencil &, const Storage *, const Storage *, const Storage *, const Storage *, Storage *, long);
+		//! Same, on rows [firstRow, lastRow) of an interleaved batch
+		template <class Stencil, class Storage>
+		using RowsKernel = void (*)(const Stencil &, const Storage *, const Storage *, Storage *, int, int, long, long);
+		//! Same, also returning the largest change of the output level
+		template <class Stencil, class Storage>
+		using MaxChangeKernel = double (*)(const Stencil &, const Storage *, const Storage *, const Storage *, const Storage *, Storage *, long);
+
+		//! Same, with per-point coefficients on the points [first, last) of a 1D grid
+		using VariableKernel = void (*)(const VariableStencil &, const double *, const double *, double *, int, int);
+
+		//! Same, for the cross stencil of a 2D or 3D grid
+		using CrossKernel = void (*)(const CrossStencil &, const double *, const double *, double *, long, long, long);
+
+		//! Scalar loop on [first, count); each value is converted to the compute type and the result back to the storage type
+		template <class Stencil, class Storage>
+		STENCIL_INLINE void sweepScalar(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long first, long count)
+		{
+			typedef typename Stencil::Value Compute;
+			for (long k = first; k < count; k++)
+			{
+				Compute previous = 0;
+				if constexpr (Stencil::usesPrevious)
+				{
+					previous = prev[k];
+				}
+				out[k] = static_cast<Storage>(stencil(previous, static_cast<Compute>(left[k]), static_cast<Compute>(centre[k]), static_cast<Compute>(right[k])));
+			}
+		}
+
+		template <class Stencil, class Storage>
+		void kernelScalar(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+		{
+			sweepScalar(stencil, prev, left, centre, right, out, 0, count);
+		}
+
+		//! One sweep per row, the rows before and after being the left and right neighbours
+		template <class Stencil, class Storage>
+		void kernelScalarRows(const Stencil &stencil, const Storage *prev, const Storage *curr, Storage *next, int firstRow, int lastRow, long stride, long count)
+		{
+			for (int i = firstRow; i < lastRow; i++)
+			{
+				long row = i * stride;
+				sweepScalar(stencil, Stencil::usesPrevious ? prev + row : nullptr, curr + row - stride, curr + row, curr + row + stride, next + row, 0, count);
+			}
+		}
+
+		//! One point of applyVariableStencil1D, on scalars or SIMD registers
+		template <VariableStencil::Form F, class V>
+		STENCIL_INLINE V variableUpdate(V previousCoefficient, V lower, V upper, V prev, V left, V centre, V right)
+		{
+			if constexpr (F == VariableStencil::ScalePrevious)
+			{
+				return previousCoefficient * prev + lower * left + upper * right;
+			}
+			else
+			{
+				return (F == VariableStencil::Centre ? centre : prev) + lower * (left - centre) + upper * (right - centre);
+			}
+		}
+
+		//! Scalar loop of applyVariableStencil1D on the points [first, last)
+		template <VariableStencil::Form F>
+		STENCIL_INLINE void sweepVariableScalar(const VariableStencil &stencil, const double *prev, const double *curr, double *next, long first, long last)
+		{
+			for (long i = first; i < last; i++)
+			{
+				double previous = F == VariableStencil::Centre ? 0.0 : prev[i];
+				double previousCoefficient = F == VariableStencil::ScalePrevious ? stencil.previous[i] : 0.0;
+				next[i] = variableUpdate<F>(previousCoefficient, stencil.lower[i], stencil.upper[i], previous, curr[i - 1], curr[i], curr[i + 1]);
+			}
+		}
+
+		template <VariableStencil::Form F>
+		void kernelVariableScalar(const VariableStencil &stencil, const double *prev, const double *curr, double *next, int first, int last)
+		{
+			sweepVariableScalar<F>(stencil, prev, curr, next, first, last);
+		}
+
+		//! One point of applyCrossStencil, on scalars or SIMD registers; the pairs of neighbours are summed first
+		template <bool UsesPrevious, bool ThreeD, class V>
+		STENCIL_INLINE V crossUpdate(const CrossStencil &stencil, V prev, V centre, V x, V y, V z)
+		{
+			V value = stencil.centre * centre + stencil.weightX * x + stencil.weightY * y;
+			if constexpr (ThreeD)
+			{
+				value = value + stencil.weightZ * z;
+			}
+			if constexpr (UsesPrevious)
+			{
+				value = stencil.previous * prev + value;
+			}
+			return value;
+		}
+
+		//! Scalar loop of applyCrossStencil on [first, count)
+		template <bool UsesPrevious, bool ThreeD>
+		STENCIL_INLINE void sweepCrossScalar(const CrossStencil &stencil, const double *prev, const double *curr, double *out, long first, long count, long strideY, long strideZ)
+		{
+			for (long i = first; i < count; i++)
+			{
+				double z = ThreeD ? curr[i - strideZ] + curr[i + strideZ] : 0.0;
+				out[i] = crossUpdate<UsesPrevious, ThreeD>(stencil, UsesPrevious ? prev[i] : 0.0, curr[i], curr[i - 1] + curr[i + 1], curr[i - strideY] + curr[i + strideY], z);
+			}
+		}
+
+		template <bool UsesPrevious, bool ThreeD>
+		void kernelCrossScalar(const CrossStencil &stencil, const double *prev, const double *curr, double *out, long count, long strideY, long strideZ)
+		{
+			sweepCrossScalar<UsesPrevious, ThreeD>(stencil, prev, curr, out, 0, count, strideY, strideZ);
+		}
+
+		//! Scalar loop on [first, count) that also folds |out - centre| into change; NaN becomes infinity so it is never taken as converged.
+		//! The change is the one of the stored values, in the compute type.
+		template <class Stencil, class Storage>
+		STENCIL_INLINE typename Stencil::Value sweepScalarMaxChange(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out,
+																	 long first, long count, typename Stencil::Value change)
+		{
+			typedef typename Stencil::Value Compute;
+			for (long k = first; k < count; k++)
+			{
+				Compute previous = 0;
+				if constexpr (Stencil::usesPrevious)
+				{
+					previous = prev[k];
+				}
+				Storage value = static_cast<Storage>(stencil(previous, static_cast<Compute>(left[k]), static_cast<Compute>(centre[k]), static_cast<Compute>(right[k])));
+				out[k] = value;
+				Compute difference = static_cast<Compute>(value) - static_cast<Compute>(centre[k]);
+				difference = difference < 0 ? -difference : difference;
+				difference = difference == difference ? difference : static_cast<Compute>(__builtin_inf());
+				change = difference > change ? difference : change;
+			}
+			return change;
+		}
+
+		template <class Stencil, class Storage>
+		double kernelScalarMaxChange(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+		{
+			return sweepScalarMaxChange(stencil, prev, left, centre, right, out, 0, count, typename Stencil::Value(0));
+		}
+
+#ifdef STENCIL_KERNELS_X86
+		//! W values of type T in one register (or in half of one when a float level is computed in double)
+		template <class T, int W>
+		struct VectorType
+		{
+			typedef T type __attribute__((vector_size(W * sizeof(T))));
+		};
+		template <class T, int W>
+		using Vector = typename VectorType<T, W>::type;
+
+		//! Loads W stored values and widens them to the compute type (a no-op when both types are the same)
+		template <class Compute, int W, class Storage>
+		STENCIL_INLINE Vector<Compute, W> load(const Storage *p)
+		{
+			Vector<Storage, W> value;
+			__builtin_memcpy(&value, p, sizeof(value));
+			return __builtin_convertvector(value, Vector<Compute, W>);
+		}
+
+		//! Rounds W computed values to the storage type and stores them
+		template <class Storage, class Compute, int W>
+		STENCIL_INLINE void store(Storage *p, Vector<Compute, W> value)
+		{
+			Vector<Storage, W> stored = __builtin_convertvector(value, Vector<Storage, W>);
+			__builtin_memcpy(p, &stored, sizeof(stored));
+		}
+
+		//! Vector loop, W values per iteration, then the scalar remainder
+		template <class Stencil, int W, class Storage>
+		STENCIL_INLINE void sweepVector(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+		{
+			typedef typename Stencil::Value Compute;
+			typedef Vector<Compute, W> V;
+			long k = 0;
+			for (; k + W <= count; k += W)
+			{
+				V previous = {};
+				if constexpr (Stencil::usesPrevious)
+				{
+					previous = load<Compute, W>(prev + k);
+				}
+				store<Storage, Compute, W>(out + k, stencil(previous, load<Compute, W>(left + k), load<Compute, W>(centre + k), load<Compute, W>(right + k)));
+			}
+			sweepScalar(stencil, prev, left, centre, right, out, k, count);
+		}
+
+		//! Vector loop of applyVariableStencil1D, W points per iteration, then the scalar remainder
+		template <VariableStencil::Form F, int W>
+		STENCIL_INLINE void sweepVariableVector(const VariableStencil &stencil, const double *prev, const double *curr, double *next, long first, long last)
+		{
+			typedef Vector<double, W> V;
+			long i = first;
+			for (; i + W <= last; i += W)
+			{
+				V previous = {};
+				V previousCoefficient = {};
+				if constexpr (F != VariableStencil::Centre)
+				{
+					previous = load<double, W>(prev + i);
+				}
+				if constexpr (F == VariableStencil::ScalePrevious)
+				{
+					previousCoefficient = load<double, W>(stencil.previous + i);
+				}
+				store<double, double, W>(next + i, variableUpdate<F>(previousCoefficient, load<double, W>(stencil.lower + i), load<double, W>(stencil.upper + i), previous,
+																	  load<double, W>(curr + i - 1), load<double, W>(curr + i), load<double, W>(curr + i + 1)));
+			}
+			sweepVariableScalar<F>(stencil, prev, curr, next, i, last);
+		}
+
+		//! Vector loop of applyCrossStencil, W points per iteration, then the scalar remainder
+		template <bool UsesPrevious, bool ThreeD, int W>
+		STENCIL_INLINE void sweepCrossVector(const CrossStencil &stencil, const double *prev, const double *curr, double *out, long count, long strideY, long strideZ)
+		{
+			typedef Vector<double, W> V;
+			long i = 0;
+			for (; i + W <= count; i += W)
+			{
+				V previous = {};
+				V z = {};
+				if constexpr (UsesPrevious)
+				{
+					previous = load<double, W>(prev + i);
+				}
+				if constexpr (ThreeD)
+				{
+					z = load<double, W>(curr + i - strideZ) + load<double, W>(curr + i + strideZ);
+				}
+				V x = load<double, W>(curr + i - 1) + load<double, W>(curr + i + 1);
+				V y = load<double, W>(curr + i - strideY) + load<double, W>(curr + i + strideY);
+				store<double, double, W>(out + i, crossUpdate<UsesPrevious, ThreeD>(stencil, previous, load<double, W>(curr + i), x, y, z));
+			}
+			sweepCrossScalar<UsesPrevious, ThreeD>(stencil, prev, curr, out, i, count, strideY, strideZ);
+		}
+
+		//! Vector loop of applyStencilMaxChange, one running maximum per lane reduced at the end
+		template <class Stencil, int W, class Storage>
+		STENCIL_INLINE double sweepVectorMaxChange(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+		{
+			typedef typename Stencil::Value Compute;
+			typedef Vector<Compute, W> V;
+			V change = {};
+			V infinity = change + static_cast<Compute>(__builtin_inf());
+			long k = 0;
+			for (; k + W <= count; k += W)
+			{
+				V previous = {};
+				if constexpr (Stencil::usesPrevious)
+				{
+					previous = load<Compute, W>(prev + k);
+				}
+				V current = load<Compute, W>(centre + k);
+				V value = stencil(previous, load<Compute, W>(left + k), current, load<Compute, W>(right + k));
+				store<Storage, Compute, W>(out + k, value);
+				//! Change of the stored value: identical to value - current unless the storage is narrower
+				if constexpr (!std::is_same_v<Storage, Compute>)
+				{
+					value = __builtin_convertvector(__builtin_convertvector(value, Vector<Storage, W>), V);
+				}
+				V difference = value - current;
+				difference = difference < 0 ? -difference : difference;
+				difference = difference == difference ? difference : infinity;
+				change = difference > change ? difference : change;
+			}
+			Compute largest = 0;
+			for (int lane = 0; lane < W; lane++)
+			{
+				largest = change[lane] > largest ? change[lane] : largest;
+			}
+			return sweepScalarMaxChange(stencil, prev, left, centre, right, out, k, count, largest);
+		}
+
+		//! Values per iteration of a kernel: one full register of the compute type. A float level computed in double
+		//! is widened half a register at a time, so that path only wins when the sweep is bound by memory traffic.
+		template <class Stencil, int Bytes>
+		constexpr int lanes = Bytes / sizeof(typename Stencil::Value);
+
+		template <class Stencil, class Storage>
+		__attribute__((target("avx2"))) void kernelAvx2(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+		{
+			sweepVector<Stencil, lanes<Stencil, 32>>(stencil, prev, left, centre, right, out, count);
+		}
+
+		template <class Stencil, class Storage>
+		__attribute__((target("avx512f"))) void kernelAvx512(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+		{
+			sweepVector<Stencil, lanes<Stencil, 64>>(stencil, prev, left, centre, right, out, count);
+		}
+
+		template <class Stencil, class Storage>
+		__attribute__((target("avx2"))) void kernelAvx2Rows(const Stencil &stencil, const Storage *prev, const Storage *curr, Storage *next, int firstRow, int lastRow, long stride, long count)
+		{
+			for (int i = firstRow; i < lastRow; i++)
+			{
+				long row = i * stride;
+				sweepVector<Stencil, lanes<Stencil, 32>>(stencil, Stencil::usesPrevious ? prev + row : nullptr, curr + row - stride, curr + row, curr + row + stride, next + row, count);
+			}
+		}
+
+		template <class Stencil, class Storage>
+		__attribute__((target("avx512f"))) void kernelAvx512Rows(const Stencil &stencil, const Storage *prev, const Storage *curr, Storage *next, int firstRow, int lastRow, long stride, long count)
+		{
+			for (int i = firstRow; i < lastRow; i++)
+			{
+				long row = i * stride;
+				sweepVector<Stencil, lanes<Stencil, 64>>(stencil, Stencil::usesPrevious ? prev + row : nullptr, curr + row - stride, curr + row, curr + row + stride, next + row, count);
+			}
+		}
+
+		template <VariableStencil::Form F>
+		__attribute__((target("avx2"))) void kernelVariableAvx2(const VariableStencil &stencil, const double *prev, const double *curr, double *next, int first, int last)
+		{
+			sweepVariableVector<F, 4>(stencil, prev, curr, next, first, last);
+		}
+
+		template <VariableStencil::Form F>
+		__attribute__((target("avx512f"))) void kernelVariableAvx512(const VariableStencil &stencil, const double *prev, const double *curr, double *next, int first, int last)
+		{
+			sweepVariableVector<F, 8>(stencil, prev, curr, next, first, last);
+		}
+
+		template <bool UsesPrevious, bool ThreeD>
+		__attribute__((target("avx2"))) void kernelCrossAvx2(const CrossStencil &stencil, const double *prev, const double *curr, double *out, long count, long strideY, long strideZ)
+		{
+			sweepCrossVector<UsesPrevious, ThreeD, 4>(stencil, prev, curr, out, count, strideY, strideZ);
+		}
+
+		template <bool UsesPrevious, bool ThreeD>
+		__attribute__((target("avx512f"))) void kernelCrossAvx512(const CrossStencil &stencil, const double *prev, const double *curr, double *out, long count, long strideY, long strideZ)
+		{
+			sweepCrossVector<UsesPrevious, ThreeD, 8>(stencil, prev, curr, out, count, strideY, strideZ);
+		}
+
+		template <class Stencil, class Storage>
+		__attribute__((target("avx2"))) double kernelAvx2MaxChange(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+		{
+			return sweepVectorMaxChange<Stencil, lanes<Stencil, 32>>(stencil, prev, left, centre, right, out, count);
+		}
+
+		template <class Stencil, class Storage>
+		__attribute__((target("avx512f"))) double kernelAvx512MaxChange(const Stencil &stencil, const Storage *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+		{
+			return sweepVectorMaxChange<Stencil, lanes<Stencil, 64>>(stencil, prev, left, centre, right, out, count);
+		}
+#endif
+
+		//! Widest instruction set supported by the CPU: 2 for AVX-512, 1 for AVX2, 0 for scalar
+		int cpuLevel()
+		{
+#ifdef STENCIL_KERNELS_X86
+			static const int level = []
+			{
+				__builtin_cpu_init();
+				if (__builtin_cpu_supports("avx512f"))
+				{
+					return 2;
+				}
+				return __builtin_cpu_supports("avx2") ? 1 : 0;
+			}();
+			return level;
+#else
+			return 0;
+#endif
+		}
+
+		template <class Stencil, class Storage>
+		Kernel<Stencil, Storage> selectKernel()
+		{
+#ifdef STENCIL_KERNELS_X86
+			switch (cpuLevel())
+			{
+			case 2:
+				return kernelAvx512<Stencil, Storage>;
+			case 1:
+				return kernelAvx2<Stencil, Storage>;
+			}
+#endif
+			return kernelScalar<Stencil, Storage>;
+		}
+
+		template <class Stencil, class Storage>
+		RowsKernel<Stencil, Storage> selectRowsKernel()
+		{
+#ifdef STENCIL_KERNELS_X86
+			switch (cpuLevel())
+			{
+			case 2:
+				return kernelAvx512Rows<Stencil, Storage>;
+			case 1:
+				return kernelAvx2Rows<Stencil, Storage>;
+			}
+#endif
+			return kernelScalarRows<Stencil, Storage>;
+		}
+
+		template <VariableStencil::Form F>
+		VariableKernel selectVariableKernel()
+		{
+#ifdef STENCIL_KERNELS_X86
+			switch (cpuLevel())
+			{
+			case 2:
+				return kernelVariableAvx512<F>;
+			case 1:
+				return kernelVariableAvx2<F>;
+			}
+#endif
+			return kernelVariableScalar<F>;
+		}
+
+		template <bool UsesPrevious, bool ThreeD>
+		CrossKernel selectCrossKernel()
+		{
+#ifdef STENCIL_KERNELS_X86
+			switch (cpuLevel())
+			{
+			case 2:
+				return kernelCrossAvx512<UsesPrevious, ThreeD>;
+			case 1:
+				return kernelCrossAvx2<UsesPrevious, ThreeD>;
+			}
+#endif
+			return kernelCrossScalar<UsesPrevious, ThreeD>;
+		}
+
+		template <class Stencil, class Storage>
+		MaxChangeKernel<Stencil, Storage> selectMaxChangeKernel()
+		{
+#ifdef STENCIL_KERNELS_X86
+			switch (cpuLevel())
+			{
+			case 2:
+				return kernelAvx512MaxChange<Stencil, Storage>;
+			case 1:
+				return kernelAvx2MaxChange<Stencil, Storage>;
+			}
+#endif
+			return kernelScalarMaxChange<Stencil, Storage>;
+		}
+	}
+
+	template <class Stencil, class Storage>
+	void applyStencil(const Stencil &stencil, const std::type_identity_t<Storage> *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+	{
+		static const Kernel<Stencil, Storage> kernel = selectKernel<Stencil, Storage>();
+		kernel(stencil, prev, left, centre, right, out, count);
+	}
+
+	template <class Stencil, class Storage>
+	void applyStencilRows(const Stencil &stencil, const std::type_identity_t<Storage> *prev, const Storage *curr, Storage *next, int firstRow, int lastRow, long stride, long count)
+	{
+		static const RowsKernel<Stencil, Storage> kernel = selectRowsKernel<Stencil, Storage>();
+		if (lastRow > firstRow && count > 0)
+		{
+			kernel(stencil, prev, curr, next, firstRow, lastRow, stride, count);
+		}
+	}
+
+	template <class Stencil, class Storage>
+	double applyStencilMaxChange(const Stencil &stencil, const std::type_identity_t<Storage> *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count)
+	{
+		static const MaxChangeKernel<Stencil, Storage> kernel = selectMaxChangeKernel<Stencil, Storage>();
+		return kernel(stencil, prev, left, centre, right, out, count);
+	}
+
+	void applyVariableStencil1D(const VariableStencil &stencil, const double *prev, const double *curr, double *next, int first, int last)
+	{
+		static const VariableKernel kernels[3] = {selectVariableKernel<VariableStencil::Centre>(), selectVariableKernel<VariableStencil::AddPrevious>(),
+												  selectVariableKernel<VariableStencil::ScalePrevious>()};
+		if (last > first)
+		{
+			kernels[stencil.form](stencil, prev, curr, next, first, last);
+		}
+	}
+
+	void applyCrossStencil(const CrossStencil &stencil, const double *prev, const double *curr, double *out, long count, long strideY, long strideZ)
+	{
+		//! Indexed by 2 * (prev != nullptr) + (strideZ != 0)
+		static const CrossKernel kernels[4] = {selectCrossKernel<false, false>(), selectCrossKernel<false, true>(), selectCrossKernel<true, false>(),
+											   selectCrossKernel<true, true>()};
+		if (count > 0)
+		{
+			kernels[2 * (prev != nullptr) + (strideZ != 0)](stencil, prev, curr, out, count, strideY, strideZ);
+		}
+	}
+
+	double copyMaxChange(const double *source, double *destination, long count)
+	{
+		double change = 0;
+		for (long i = 0; i < count; i++)
+		{
+			double difference = std::abs(source[i] - destination[i]);
+			change = difference == difference ? std::max(change, difference) : std::numeric_limits<double>::infinity();
+			destination[i] = source[i];
+		}
+		return change;
+	}
+
+	const char *instructionSet()
+	{
+		const char *names[3] = {"scalar", "avx2", "avx512"};
+		return names[cpuLevel()];
+	}
+
+	template void applyStencil<BasicRichardsonStencil<double>, double>(const BasicRichardsonStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	template void applyStencil<BasicRichardsonStencil<double>, float>(const BasicRichardsonStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	template void applyStencil<BasicRichardsonStencil<float>, float>(const BasicRichardsonStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+	template void applyStencil<BasicDufortFrankelStencil<double>, double>(const BasicDufortFrankelStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	template void applyStencil<BasicDufortFrankelStencil<double>, float>(const BasicDufortFrankelStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	template void applyStencil<BasicDufortFrankelStencil<float>, float>(const BasicDufortFrankelStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+	template void applyStencil<BasicFtcsStencil<double>, double>(const BasicFtcsStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	template void applyStencil<BasicFtcsStencil<double>, float>(const BasicFtcsStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	template void applyStencil<BasicFtcsStencil<float>, float>(const BasicFtcsStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+	template void applyStencil<CrankNicolsonRhsStencil, double>(const CrankNicolsonRhsStencil &, const double *, const double *, const double *, const double *, double *, long);
+	template void applyStencilRows<BasicRichardsonStencil<double>, double>(const BasicRichardsonStencil<double> &, const double *, const double *, double *, int, int, long, long);
+	template void applyStencilRows<BasicDufortFrankelStencil<double>, double>(const BasicDufortFrankelStencil<double> &, const double *, const double *, double *, int, int, long, long);
+	template void applyStencilRows<BasicFtcsStencil<double>, double>(const BasicFtcsStencil<double> &, const double *, const double *, double *, int, int, long, long);
+	template void applyStencilRows<CrankNicolsonRhsStencil, double>(const CrankNicolsonRhsStencil &, const double *, const double *, double *, int, int, long, long);
+	template double applyStencilMaxChange<BasicRichardsonStencil<double>, double>(const BasicRichardsonStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	template double applyStencilMaxChange<BasicRichardsonStencil<double>, float>(const BasicRichardsonStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	template double applyStencilMaxChange<BasicRichardsonStencil<float>, float>(const BasicRichardsonStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+	template double applyStencilMaxChange<BasicDufortFrankelStencil<double>, double>(const BasicDufortFrankelStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	template double applyStencilMaxChange<BasicDufortFrankelStencil<double>, float>(const BasicDufortFrankelStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	template double applyStencilMaxChange<BasicDufortFrankelStencil<float>, float>(const BasicDufortFrankelStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+}
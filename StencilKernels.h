@@ -0,0 +1,252 @@
+#pragma once
+#ifndef STENCILKERNELS_H
+#define STENCILKERNELS_H
+
+#if defined(__GNUC__)
+#define STENCIL_INLINE __attribute__((always_inline)) inline
+#else
+#define STENCIL_INLINE inline
+#endif
+
+#include <type_traits>
+
+/**
+ * @brief Three-point stencils of the four schemes and the vectorized kernel that applies them.
+ *
+ * A stencil computes one output value from the value at level n-1 (when the scheme uses it) and the left,
+ * centre and right values at level n. Its coefficients are computed once by its constructor. The formula is
+ * written once, as a template on the value type, and is instantiated both for scalars and for SIMD registers
+ * so the vector and scalar paths give bit-for-bit identical results.
+ *
+ * Each stencil is a template on its compute precision Real (the coefficients are computed in double, then rounded
+ * to Real); RichardsonStencil and the other plain names are the double versions. The kernels are templates on the
+ * storage type of the levels as well, so three combinations are available: double storage and arithmetic, float
+ * storage with double arithmetic (each value is widened on load and rounded on store) and float throughout.
+ */
+namespace StencilKernels
+{
+	/**
+	 * @brief Richardson: T_i^{n+1} = T_i^{n-1} + beta (T_{i+1}^n - 2 T_i^n + T_{i-1}^n)
+	 */
+	template <class Real>
+	struct BasicRichardsonStencil
+	{
+		typedef Real Value;
+		static constexpr bool usesPrevious = true;
+		Real beta;
+
+		explicit BasicRichardsonStencil(double new_beta) : beta(new_beta) {}
+
+		template <class V>
+		STENCIL_INLINE V operator()(V prev, V left, V centre, V right) const
+		{
+			return prev + beta * (right - Real(2) * centre + left);
+		}
+	};
+	typedef BasicRichardsonStencil<double> RichardsonStencil;
+
+	/**
+	 * @brief Dufort-Frankel: T_i^{n+1} = a T_i^{n-1} + c (T_{i+1}^n + T_{i-1}^n), a = (1 - 2 beta)/(1 + 2 beta), c = 2 beta/(1 + 2 beta)
+	 */
+	template <class Real>
+	struct BasicDufortFrankelStencil
+	{
+		typedef Real Value;
+		static constexpr bool usesPrevious = true;
+		Real previousCoefficient;
+		Real neighbourCoefficient;
+
+		explicit BasicDufortFrankelStencil(double beta)
+			: previousCoefficient((1 - 2 * beta) / (1 + 2 * beta)), neighbourCoefficient((2 * beta) / (1 + 2 * beta)) {}
+
+		template <class V>
+		STENCIL_INLINE V operator()(V prev, V left, V /* centre */, V right) const
+		{
+			return prev * previousCoefficient + neighbourCoefficient * (right + left);
+		}
+	};
+	typedef BasicDufortFrankelStencil<double> DufortFrankelStencil;
+
+	/**
+	 * @brief FTCS starter step of the three-level schemes: T_i^1 = T_i^0 + beta (T_{i+1}^0 - 2 T_i^0 + T_{i-1}^0)
+	 */
+	template <class Real>
+	struct BasicFtcsStencil
+	{
+		typedef Real Value;
+		static constexpr bool usesPrevious = false;
+		Real beta;
+
+		explicit BasicFtcsStencil(double new_beta) : beta(new_beta) {}
+
+		template <class V>
+		STENCIL_INLINE V operator()(V, V left, V centre, V right) const
+		{
+			return centre + beta * (right - Real(2) * centre + left);
+		}
+	};
+	typedef BasicFtcsStencil<double> FtcsStencil;
+
+	/**
+	 * @brief Crank-Nicholson right-hand side: lambda T_{i-1}^n + (1 - 2 lambda) T_i^n + lambda T_{i+1}^n
+	 */
+	struct CrankNicolsonRhsStencil
+	{
+		typedef double Value;
+		static constexpr bool usesPrevious = false;
+		double lambda;
+		double diagonal;
+
+		explicit CrankNicolsonRhsStencil(double new_lambda) : lambda(new_lambda), diagonal(1 - 2 * new_lambda) {}
+
+		template <class V>
+		STENCIL_INLINE V operator()(V, V left, V centre, V right) const
+		{
+			return lambda * left + diagonal * centre + lambda * right;
+		}
+	};
+
+	/**
+	 * @brief Per-point coefficients of a three-point update, for a non-uniform grid or a D(x) (see Grid). The update
+	 * is written with differences, so the diagonal is implied and only two coefficient arrays are streamed, three for
+	 * Dufort-Frankel:
+	 * - Centre: next[i] = T_i^n + lower[i] (T_{i-1}^n - T_i^n) + upper[i] (T_{i+1}^n - T_i^n) (FTCS, Crank-Nicholson right-hand side)
+	 * - AddPrevious: next[i] = T_i^{n-1} + lower[i] (T_{i-1}^n - T_i^n) + upper[i] (T_{i+1}^n - T_i^n) (Richardson)
+	 * - ScalePrevious: next[i] = previous[i] T_i^{n-1} + lower[i] T_{i-1}^n + upper[i] T_{i+1}^n (Dufort-Frankel)
+	 * Each coefficient is a contiguous array indexed by the grid point.
+	 */
+	struct VariableStencil
+	{
+		enum Form
+		{
+			Centre,
+			AddPrevious,
+			ScalePrevious
+		};
+
+		Form form = Centre;
+		//! Coefficient of level n-1, only read by ScalePrevious
+		const double *previous = nullptr;
+		const double *lower = nullptr;
+		const double *upper = nullptr;
+	};
+
+	/**
+	 * @brief Cross-shaped update of a uniform 2D or 3D grid stored x fastest, the same weight on each pair of neighbours:
+	 * out = previous T^{n-1} + centre T + weightX (T_{i-1} + T_{i+1}) + weightY (T_{j-1} + T_{j+1}) + weightZ (T_{k-1} + T_{k+1})
+	 * Every explicit update and every ADI right-hand side of MultiDimensionalMethods is one set of these coefficients.
+	 */
+	struct CrossStencil
+	{
+		double previous = 0;
+		double centre = 0;
+		double weightX = 0;
+		double weightY = 0;
+		double weightZ = 0;
+	};
+
+	/**
+	 * @brief Applies a cross stencil to 'count' consecutive points along x: out[i] from curr[i], curr[i +- 1],
+	 * curr[i +- strideY] and curr[i +- strideZ].
+	 * @param prev Level n-1 at the same points, nullptr to leave the previous term out
+	 * @param strideY Distance between two neighbours along y
+	 * @param strideZ Distance between two neighbours along z, 0 on a 2D grid (weightZ is then not used)
+	 */
+	void applyCrossStencil(const CrossStencil &stencil, const double *prev, const double *curr, double *out, long count, long strideY, long strideZ);
+
+	/**
+	 * @brief Applies a stencil to 'count' points: out[k] = stencil(prev[k], left[k], centre[k], right[k]).
+	 * The inputs are shifted views of the same level (left = centre - 1 on a 1D grid, or rows of an interleaved
+	 * batch); out must not overlap them. prev is only read when Stencil::usesPrevious.
+	 * The values are stored as Storage and computed as Stencil::Value (see the instantiations at the end).
+	 * The SIMD width (AVX-512, AVX2 or scalar) is chosen at runtime from the CPU features.
+	 */
+	template <class Stencil, class Storage>
+	void applyStencil(const Stencil &stencil, const std::type_identity_t<Storage> *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count);
+
+	/**
+	 * @brief Applies a stencil on the points [first, last) of a 1D grid: next[i] = stencil(prev[i], curr[i-1], curr[i], curr[i+1]).
+	 * @param prev Level n-1 (may be nullptr when the stencil does not use it)
+	 * @param curr Level n
+	 * @param next Output level
+	 */
+	template <class Stencil, class Storage>
+	inline void applyStencil1D(const Stencil &stencil, const std::type_identity_t<Storage> *prev, const Storage *curr, Storage *next, int first, int last)
+	{
+		if (last > first)
+		{
+			applyStencil(stencil, prev ? prev + first : nullptr, curr + first - 1, curr + first, curr + first + 1, next + first, last - first);
+		}
+	}
+
+	/**
+	 * @brief Applies a stencil on the rows [firstRow, lastRow) of an interleaved batch, 'count' values per row:
+	 * next[i * stride + k] = stencil(prev[i * stride + k], curr[(i - 1) * stride + k], curr[i * stride + k], curr[(i + 1) * stride + k]).
+	 * Same values as one applyStencil call per row, with a single kernel dispatch for all the rows.
+	 * @param prev Level n-1 (may be nullptr when the stencil does not use it)
+	 * @param curr Level n
+	 * @param next Output level
+	 * @param stride Distance between two rows (the batch size), at least count
+	 */
+	template <class Stencil, class Storage>
+	void applyStencilRows(const Stencil &stencil, const std::type_identity_t<Storage> *prev, const Storage *curr, Storage *next, int firstRow, int lastRow, long stride, long count);
+
+	/**
+	 * @brief Same as applyStencil, and returns max_k |out[k] - centre[k]| computed in the same pass (the change of
+	 * the level over one step). A value that is not a number counts as an infinite change.
+	 */
+	template <class Stencil, class Storage>
+	double applyStencilMaxChange(const Stencil &stencil, const std::type_identity_t<Storage> *prev, const Storage *left, const Storage *centre, const Storage *right, Storage *out, long count);
+
+	/**
+	 * @brief Same as applyStencil1D, and returns max |next[i] - curr[i]| on [first, last) (0 for an empty range).
+	 */
+	template <class Stencil, class Storage>
+	inline double applyStencil1DMaxChange(const Stencil &stencil, const std::type_identity_t<Storage> *prev, const Storage *curr, Storage *next, int first, int last)
+	{
+		if (last > first)
+		{
+			return applyStencilMaxChange(stencil, prev ? prev + first : nullptr, curr + first - 1, curr + first, curr + first + 1, next + first, last - first);
+		}
+		return 0.0;
+	}
+
+	/**
+	 * @brief Applies per-point coefficients on the points [first, last) of a 1D grid (see VariableStencil).
+	 * @param prev Level n-1 (not read by the Centre form, may be nullptr then)
+	 * @param curr Level n
+	 * @param next Output level, must not overlap the inputs
+	 */
+	void applyVariableStencil1D(const VariableStencil &stencil, const double *prev, const double *curr, double *next, int first, int last);
+
+	/**
+	 * @brief Copies count values and returns max |source[k] - destination[k]| of the overwritten values (the change of
+	 * a level solved out of place). A value that is not a number counts as an infinite change.
+	 */
+	double copyMaxChange(const double *source, double *destination, long count);
+
+	//! Name of the instruction set selected at runtime ("avx512", "avx2" or "scalar")
+	const char *instructionSet();
+
+	extern template void applyStencil<BasicRichardsonStencil<double>, double>(const BasicRichardsonStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	extern template void applyStencil<BasicRichardsonStencil<double>, float>(const BasicRichardsonStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template void applyStencil<BasicRichardsonStencil<float>, float>(const BasicRichardsonStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template void applyStencil<BasicDufortFrankelStencil<double>, double>(const BasicDufortFrankelStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	extern template void applyStencil<BasicDufortFrankelStencil<double>, float>(const BasicDufortFrankelStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template void applyStencil<BasicDufortFrankelStencil<float>, float>(const BasicDufortFrankelStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template void applyStencil<BasicFtcsStencil<double>, double>(const BasicFtcsStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	extern template void applyStencil<BasicFtcsStencil<double>, float>(const BasicFtcsStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template void applyStencil<BasicFtcsStencil<float>, float>(const BasicFtcsStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template void applyStencil<CrankNicolsonRhsStencil, double>(const CrankNicolsonRhsStencil &, const double *, const double *, const double *, const double *, double *, long);
+	extern template void applyStencilRows<BasicRichardsonStencil<double>, double>(const BasicRichardsonStencil<double> &, const double *, const double *, double *, int, int, long, long);
+	extern template void applyStencilRows<BasicDufortFrankelStencil<double>, double>(const BasicDufortFrankelStencil<double> &, const double *, const double *, double *, int, int, long, long);
+	extern template void applyStencilRows<BasicFtcsStencil<double>, double>(const BasicFtcsStencil<double> &, const double *, const double *, double *, int, int, long, long);
+	extern template void applyStencilRows<CrankNicolsonRhsStencil, double>(const CrankNicolsonRhsStencil &, const double *, const double *, double *, int, int, long, long);
+	extern template double applyStencilMaxChange<BasicRichardsonStencil<double>, double>(const BasicRichardsonStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	extern template double applyStencilMaxChange<BasicRichardsonStencil<double>, float>(const BasicRichardsonStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template double applyStencilMaxChange<BasicRichardsonStencil<float>, float>(const BasicRichardsonStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template double applyStencilMaxChange<BasicDufortFrankelStencil<double>, double>(const BasicDufortFrankelStencil<double> &, const double *, const double *, const double *, const double *, double *, long);
+	extern template double applyStencilMaxChange<BasicDufortFrankelStencil<double>, float>(const BasicDufortFrankelStencil<double> &, const float *, const float *, const float *, const float *, float *, long);
+	extern template double applyStencilMaxChange<BasicDufortFrankelStencil<float>, float>(const BasicDufortFrankelStencil<float> &, const float *, const float *, const float *, const float *, float *, long);
+}
+#endif // STENCILKERNELS_H
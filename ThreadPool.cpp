@@ -0,0 +1,134 @@
+#include "ThreadPool.h"
+#include <stdexcept>
+
+// Constructor
+ThreadPool::ThreadPool(int numberOfThreads)
+	: tp_task(nullptr), tp_generation(0), tp_pending(0), tp_stop(false)
+{
+	if (numberOfThreads < 1)
+	{
+		throw std::invalid_argument("A thread pool needs at least one thread");
+	}
+
+	for (int index = 1; index < numberOfThreads; index++)
+	{
+		tp_workers.emplace_back(&ThreadPool::workerLoop, this, index);
+	}
+}
+
+// Destructor
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(tp_mutex);
+		tp_stop = true;
+	}
+	tp_start.notify_all();
+	for (std::thread &worker : tp_workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::workerLoop(int index)
+{
+	unsigned long seenGeneration = 0;
+	while (true)
+	{
+		const std::function<void(int)> *task;
+		{
+			std::unique_lock<std::mutex> lock(tp_mutex);
+			tp_start.wait(lock, [&]
+						  { return tp_stop || tp_generation != seenGeneration; });
+			if (tp_stop)
+			{
+				return;
+			}
+			seenGeneration = tp_generation;
+			task = tp_task;
+		}
+
+		//! An exception cannot leave a worker: it is kept for run() to rethrow
+		std::exception_ptr exception;
+		try
+		{
+			(*task)(index);
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(tp_mutex);
+			if (exception && !tp_exception)
+			{
+				tp_exception = exception;
+			}
+			tp_pending--;
+		}
+		tp_done.notify_one();
+	}
+}
+
+void ThreadPool::run(const std::function<void(int)> &task)
+{
+	if (tp_workers.empty())
+	{
+		task(0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(tp_mutex);
+		tp_task = &task;
+		tp_pending = tp_workers.size();
+		tp_exception = nullptr;
+		tp_generation++;
+	}
+	tp_start.notify_all();
+
+	//! The calling thread takes chunk 0; even if it throws, the workers still use task until they are done
+	std::exception_ptr exception;
+	try
+	{
+		task(0);
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+
+	std::unique_lock<std::mutex> lock(tp_mutex);
+	tp_done.wait(lock, [&]
+				 { return tp_pending == 0; });
+	if (!exception)
+	{
+		exception = tp_exception;
+	}
+	tp_exception = nullptr;
+	lock.unlock();
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+// Get functions
+int ThreadPool::size() const
+{
+	return tp_workers.size() + 1;
+}
+
+void ThreadPool::chunk(long count, int index, long &first, long &last) const
+{
+	int threads = size();
+	first = count * index / threads;
+	last = count * (index + 1) / threads;
+}
+
+int ThreadPool::hardwareThreads()
+{
+	unsigned int threads = std::thread::hardware_concurrency();
+	return threads == 0 ? 1 : threads;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+/**
+ * @class ThreadPool
+ * @brief This class keeps a fixed set of worker threads alive and runs one task on all of them at a time
+ *
+ * run() hands the same task to every thread (the calling thread takes index 0) and returns once all of them
+ * have finished, so a time step can be split over the threads without creating a thread per step.
+ */
+
+class ThreadPool
+{
+private:
+	//! Attribute for the worker threads (indices 1 to size-1)
+	std::vector<std::thread> tp_workers;
+	//! Attribute for the task of the current round
+	const std::function<void(int)> *tp_task;
+	//! Attribute for the round counter, workers start a task when it changes
+	unsigned long tp_generation;
+	//! Attribute for the number of workers still running the current round
+	int tp_pending;
+	//! Attribute set by the destructor to stop the workers
+	bool tp_stop;
+	//! Attribute for the first exception thrown by the task in the current round
+	std::exception_ptr tp_exception;
+
+	std::mutex tp_mutex;
+	std::condition_variable tp_start;
+	std::condition_variable tp_done;
+
+	void workerLoop(int index);
+
+public:
+	/**
+	 * @brief Starts numberOfThreads - 1 workers; the caller of run() is the remaining thread.
+	 * @param numberOfThreads Total number of threads, at least 1
+	 */
+	explicit ThreadPool(int numberOfThreads);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/**
+	 * @brief Runs task(index) on every thread, index in [0, size()), and waits for all of them.
+	 *
+	 * If the task throws on any thread, run still waits for every thread to finish the round, then rethrows the
+	 * first exception. A task whose threads wait for each other (a barrier) must not throw between the waits.
+	 * @param task Function called once per thread with the thread index
+	 */
+	void run(const std::function<void(int)> &task);
+
+	//! Get Methods
+	int size() const;
+
+	/**
+	 * @brief Splits [0, count) in size() contiguous chunks and returns the bounds of chunk 'index'.
+	 * @param count Number of items
+	 * @param index Chunk index
+	 * @param first First item of the chunk
+	 * @param last One past the last item of the chunk
+	 */
+	void chunk(long count, int index, long &first, long &last) const;
+
+	//! Number of hardware threads, at least 1
+	static int hardwareThreads();
+};
+#endif // THREADPOOL_H
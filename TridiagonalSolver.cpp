@@ -0,0 +1,108 @@
+#include "TridiagonalSolver.h"
+#include <stdexcept>
+#include "Instrumentation.h"
+
+// Constructors
+template <class Real>
+BasicTridiagonalSolver<Real>::BasicTridiagonalSolver()
+{
+}
+
+template <class Real>
+BasicTridiagonalSolver<Real>::BasicTridiagonalSolver(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag)
+{
+	factorize(lower_diag, diag, upper_diag);
+}
+
+template <class Real>
+void BasicTridiagonalSolver<Real>::factorize(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag)
+{
+	HEAT_PROFILE_SCOPE("thomas.factorize");
+	int size = diag.size();
+
+	if (size == 0 || lower_diag.size() != static_cast<std::size_t>(size) || upper_diag.size() != static_cast<std::size_t>(size))
+	{
+		throw std::invalid_argument("Vectors diag, lower_diag, and  upper_diag must have the same non-zero size");
+	}
+
+	ts_lower.assign(lower_diag.begin(), lower_diag.end());
+	ts_upperStar.resize(size);
+	ts_inversePivot.resize(size);
+
+	//! First row
+	double inversePivot = 1.0 / diag[0];
+	double upperStar = upper_diag[0] * inversePivot;
+	ts_inversePivot[0] = inversePivot;
+	ts_upperStar[0] = upperStar;
+
+	//! Pivots of the forward sweep, they only depend on the matrix (in double, then stored as Real)
+	for (int i = 1; i < size; i++)
+	{
+		inversePivot = 1.0 / (diag[i] - lower_diag[i] * upperStar);
+		upperStar = upper_diag[i] * inversePivot;
+		ts_inversePivot[i] = inversePivot;
+		ts_upperStar[i] = upperStar;
+	}
+}
+
+template <class Real>
+void BasicTridiagonalSolver<Real>::solve(std::span<Real> x) const
+{
+	int size = ts_inversePivot.size();
+
+	if (x.size() != static_cast<std::size_t>(size))
+	{
+		throw std::invalid_argument("Right-hand side must have the size of the factorized matrix");
+	}
+
+	const Real *lower = ts_lower.data();
+	const Real *upperStar = ts_upperStar.data();
+	const Real *inversePivot = ts_inversePivot.data();
+
+	//! Forward sweep: x becomes x_star
+	{
+		HEAT_PROFILE_SCOPE("thomas.forward_sweep");
+		x[0] = x[0] * inversePivot[0];
+		for (int i = 1; i < size; i++)
+		{
+			x[i] = (x[i] - lower[i] * x[i - 1]) * inversePivot[i];
+		}
+	}
+
+	//! Back substitution
+	{
+		HEAT_PROFILE_SCOPE("thomas.back_substitution");
+		for (int i = size - 2; i >= 0; i--)
+		{
+			x[i] = x[i] - upperStar[i] * x[i + 1];
+		}
+	}
+}
+
+// Get functions
+template <class Real>
+int BasicTridiagonalSolver<Real>::size() const
+{
+	return ts_inversePivot.size();
+}
+
+template <class Real>
+const std::vector<Real> &BasicTridiagonalSolver<Real>::getLower() const
+{
+	return ts_lower;
+}
+
+template <class Real>
+const std::vector<Real> &BasicTridiagonalSolver<Real>::getUpperStar() const
+{
+	return ts_upperStar;
+}
+
+template <class Real>
+const std::vector<Real> &BasicTridiagonalSolver<Real>::getInversePivot() const
+{
+	return ts_inversePivot;
+}
+
+template class BasicTridiagonalSolver<double>;
+template class BasicTridiagonalSolver<float>;
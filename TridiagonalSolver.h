@@ -0,0 +1,70 @@
+#pragma once
+#ifndef TRIDIAGONALSOLVER_H
+#define TRIDIAGONALSOLVER_H
+
+#include <vector>
+#include <span>
+
+/**
+ * @class TridiagonalSolver
+ * @brief This class factorizes a tridiagonal matrix once and solves systems with it in place (Thomas algorithm)
+ *
+ * The implicit schemes keep the same matrix for the whole simulation, so the pivots of the forward sweep
+ * are computed once by factorize() and each time step only costs a forward and a backward pass over the
+ * right-hand side.
+ *
+ * The coefficients and the solve are in the storage type Real: TridiagonalSolver is the double solver, and
+ * BasicTridiagonalSolver<float> the float one that ImplicitMethods refines in double (Precision::Mixed). The pivots
+ * are always computed in double and rounded once to Real.
+ */
+
+template <class Real>
+class BasicTridiagonalSolver
+{
+private:
+	//! Attribute for data storage for lower diagonal coefficient
+	std::vector<Real> ts_lower;
+	//! Attribute for data storage for modified upper diagonal c'_i = upper_i * m_i
+	std::vector<Real> ts_upperStar;
+	//! Attribute for data storage for inverse pivots m_i = 1 / (diag_i - lower_i * c'_{i-1})
+	std::vector<Real> ts_inversePivot;
+
+public:
+	BasicTridiagonalSolver();
+
+	/**
+	 * @brief Builds the solver and factorizes the matrix given by its three diagonals.
+	 * @param lower_diag Lower diagonal of the tridiagonal matrix (lower_diag[0] is not used)
+	 * @param diag Diagonal of the tridiagonal matrix
+	 * @param upper_diag Upper diagonal of the tridiagonal matrix (upper_diag[size-1] is not used)
+	 */
+	BasicTridiagonalSolver(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag);
+
+	/**
+	 * @brief Precomputes the inverse pivots and modified upper diagonal of the forward sweep.
+	 * The storage is reused when the size does not change.
+	 * @param lower_diag Lower diagonal of the tridiagonal matrix
+	 * @param diag Diagonal of the tridiagonal matrix
+	 * @param upper_diag Upper diagonal of the tridiagonal matrix
+	 */
+	void factorize(const std::vector<double> &lower_diag, const std::vector<double> &diag, const std::vector<double> &upper_diag);
+
+	/**
+	 * @brief Solves the system in place: x holds the right-hand side on entry and the solution on exit.
+	 * Does not allocate and does not modify the solver, so it can be called concurrently.
+	 * @param x Right-hand side / solution, of the factorized size
+	 */
+	void solve(std::span<Real> x) const;
+
+	//! Get Methods
+	int size() const;
+	const std::vector<Real> &getLower() const;
+	const std::vector<Real> &getUpperStar() const;
+	const std::vector<Real> &getInversePivot() const;
+};
+
+typedef BasicTridiagonalSolver<double> TridiagonalSolver;
+
+extern template class BasicTridiagonalSolver<double>;
+extern template class BasicTridiagonalSolver<float>;
+#endif // TRIDIAGONALSOLVER_H
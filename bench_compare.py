@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Compares two result files written by ./bench (--output) and flags performance regressions.
+
+Usage: python3 bench_compare.py baseline.tsv candidate.tsv [--threshold 0.05]
+
+Runs are matched by name and grid size. A run is a regression when its ns per point update grows by more
+than the threshold (5% by default) or when it allocates more per step. The exit status is 1 if any run
+regressed, so the script can gate a build.
+"""
+
+import argparse
+import sys
+
+
+def load(path):
+    """Returns {(name, N): row} for the data lines of a result file."""
+    rows = {}
+    columns = None
+    with open(path) as results:
+        for line in results:
+            if line.startswith('#') or not line.strip():
+                continue
+            fields = line.rstrip('\n').split('\t')
+            if columns is None:
+                columns = fields
+                continue
+            row = dict(zip(columns, fields))
+            rows[(row['name'], int(row['N']))] = row
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two ./bench result files.')
+    parser.add_argument('baseline')
+    parser.add_argument('candidate')
+    parser.add_argument('--threshold', type=float, default=0.05, help='relative slowdown reported as a regression')
+    arguments = parser.parse_args()
+
+    baseline = load(arguments.baseline)
+    candidate = load(arguments.candidate)
+
+    regressions = 0
+    print('%-24s %10s %14s %14s %9s  %s' % ('name', 'N', 'base ns/upd', 'new ns/upd', 'change', 'status'))
+    for key in sorted(set(baseline) | set(candidate)):
+        if key not in baseline or key not in candidate:
+            print('%-24s %10d %s' % (key[0], key[1], 'only in ' + ('candidate' if key in candidate else 'baseline')))
+            continue
+        old = float(baseline[key]['ns_per_update'])
+        new = float(candidate[key]['ns_per_update'])
+        change = new / old - 1
+        status = 'ok'
+        if change > arguments.threshold:
+            status = 'REGRESSION'
+        elif change < -arguments.threshold:
+            status = 'faster'
+        if float(candidate[key]['allocations_per_step']) > float(baseline[key]['allocations_per_step']):
+            status = 'REGRESSION (allocations)'
+        if status.startswith('REGRESSION'):
+            regressions += 1
+        print('%-24s %10d %14.4f %14.4f %+8.1f%%  %s' % (key[0], key[1], old, new, 100 * change, status))
+
+    print('%d regression(s) above %.0f%%' % (regressions, 100 * arguments.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
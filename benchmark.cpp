@@ -0,0 +1,1459 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <unistd.h>
+#include <fstream>
+
+#include "Initializer.h"
+#include "ExplicitMethods.h"
+#include "ImplicitMethods.h"
+#include "BandedSolver.h"
+#include "ParallelTridiagonalSolver.h"
+#include "StencilKernels.h"
+#include "BatchedTridiagonalSolver.h"
+#include "SnapshotWriter.h"
+#include "SnapshotReader.h"
+#include "CsvExporter.h"
+#include "AnalyticalSolution.h"
+#include "SpectralMethods.h"
+#include "HeatSolver.h"
+#include "CheckpointWriter.h"
+#include "CheckpointReader.h"
+#include "EnsembleMethods.h"
+#include "NonUniformMethods.h"
+#include "MultiDimensionalMethods.h"
+
+#define DELTAX 0.05
+#define TSURF 149.0
+#define TINIT 38.0
+#define D 93.0
+#define XMIN 0
+#define XMAX 31
+#define NUMBER_OF_POINTS 1 + ((XMAX - XMIN) / DELTAX)
+
+using namespace std;
+
+//! Global heap allocation counter, incremented by every replaced operator new below
+static std::atomic<unsigned long long> g_allocations{0};
+
+//! Counts one allocation and returns size bytes from malloc, or from aligned_alloc past the default alignment
+static void *countedAllocate(std::size_t size, std::size_t alignment) noexcept
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0)
+    {
+        size = 1;
+    }
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        return std::malloc(size);
+    }
+    // aligned_alloc needs a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void *countedAllocateOrThrow(std::size_t size, std::size_t alignment)
+{
+    if (void *p = countedAllocate(size, alignment))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size)
+{
+    return countedAllocateOrThrow(size, 0);
+}
+
+void *operator new[](std::size_t size)
+{
+    return countedAllocateOrThrow(size, 0);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size, 0);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size, 0);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+// malloc and aligned_alloc both release through free, so every delete form forwards here
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+//! Signature shared by richardsonMethods and dufort_frankelMethods
+typedef vector<double> (ExplicitMethods::*ExplicitScheme)(double, int, double, double, double, double, double, const vector<double> &, int);
+
+//! Signature shared by laasonenMethod and crankNicholsonMethod
+typedef vector<double> (ImplicitMethods::*ImplicitScheme)(double, int, double, double, double, double, double, const vector<double> &);
+
+//! One line of the suite results
+struct SuiteResult
+{
+    string name;
+    int numberOfPoint;
+    long steps;
+    double seconds;
+    double bytesPerUpdate;
+    unsigned long long allocations;
+    //! Iterations per step of an iterative solver (multigrid V-cycles), 0 for the direct ones
+    double iterationsPerStep = 0;
+};
+
+//! Size of the last-level cache in bytes (32 MiB when the system does not report it)
+long lastLevelCache()
+{
+    for (int level : {_SC_LEVEL3_CACHE_SIZE, _SC_LEVEL2_CACHE_SIZE})
+    {
+        long size = sysconf(level);
+        if (size > 0)
+        {
+            return size;
+        }
+    }
+    return 32L << 20;
+}
+
+//! Sustained memory bandwidth (STREAM triad a = b + s * c, 24 bytes per element, best of 5) in GB/s
+double streamTriad(long size)
+{
+    vector<double> a(size, 0.0), b(size, 1.0), c(size, 2.0);
+    double best = 1e30;
+    for (int repetition = 0; repetition < 5; repetition++)
+    {
+        auto start = chrono::steady_clock::now();
+        double *pa = a.data();
+        const double *pb = b.data();
+        const double *pc = c.data();
+        for (long i = 0; i < size; i++)
+        {
+            pa[i] = pb[i] + 3.0 * pc[i];
+        }
+        best = std::min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    //! Keeps the stores observable
+    if (a[size / 2] != 7.0)
+    {
+        cout << "STREAM triad check failed" << endl;
+    }
+    return 24.0 * size / best * 1e-9;
+}
+
+/**
+ * @brief Times one call of a solver after a warm-up call, best of the given repetitions.
+ * @param run Runs the solver once
+ * @param repetitions Number of timed calls
+ * @param allocations Heap allocations of the last timed call
+ */
+template <class Run>
+double timeBest(const Run &run, int repetitions, unsigned long long &allocations)
+{
+    run();
+    double best = 1e30;
+    for (int repetition = 0; repetition < repetitions; repetition++)
+    {
+        unsigned long long allocationsBefore = g_allocations;
+        auto start = chrono::steady_clock::now();
+        run();
+        best = std::min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        allocations = g_allocations - allocationsBefore;
+    }
+    return best;
+}
+
+/**
+ * @brief Suite entry for an explicit scheme on N points, beta = 0.4 (stable for Dufort-Frankel).
+ * Traffic model: read n-1 and n, write n+1, 24 bytes per point update.
+ */
+SuiteResult suiteExplicit(const string &name, ExplicitScheme scheme, int numberOfPoint, long pointUpdates, int repetitions)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    double deltat = 0.4 * deltax * deltax / D;
+    int numStep = std::max(3L, pointUpdates / numberOfPoint);
+    vector<double> temperatureInit = Initializer(deltat, deltat * numStep).getT_values(numberOfPoint, TSURF, TINIT);
+    ExplicitMethods explicitMethods;
+
+    SuiteResult result = {name, numberOfPoint, numStep - 1L, 0, 24.0, 0};
+    result.seconds = timeBest([&]
+                              { (explicitMethods.*scheme)(deltax, numberOfPoint, TSURF, TINIT, D, deltat, deltat * numStep, temperatureInit, 1); },
+                              repetitions, result.allocations);
+    return result;
+}
+
+/**
+ * @brief Suite entry for an implicit scheme on N points with the dt of main.cpp.
+ * Traffic model: Laasonen solves in place (forward sweep reads x, l, 1/m and writes x; back substitution reads x, c' and writes x),
+ * 56 bytes per point update; Crank-Nicholson adds the right-hand side (read T, write rhs) and the copy back, 88 bytes.
+ */
+SuiteResult suiteImplicit(const string &name, ImplicitScheme scheme, double bytesPerUpdate, int numberOfPoint, long pointUpdates, int repetitions)
+{
+    double deltat = 0.01;
+    int numStep = std::max(3L, pointUpdates / numberOfPoint);
+    vector<double> temperatureInit = Initializer(deltat, deltat * numStep).getT_values(numberOfPoint, TSURF, TINIT);
+    ImplicitMethods implicitMethods;
+
+    SuiteResult result = {name, numberOfPoint, numStep - 1L, 0, bytesPerUpdate, 0};
+    result.seconds = timeBest([&]
+                              { (implicitMethods.*scheme)(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, deltat * numStep, temperatureInit); },
+                              repetitions, result.allocations);
+    return result;
+}
+
+/**
+ * @brief Suite entry for the one-shot ImplicitMethods::thomasAlgorithm, called once per step on a Laasonen matrix.
+ * Traffic model: copy of x_n (16 bytes), factorization (reads 3 diagonals, writes 3 coefficients, 48 bytes), solve (56 bytes).
+ */
+SuiteResult suiteThomas(int numberOfPoint, long pointUpdates, int repetitions)
+{
+    double theta = D * (0.01 / (DELTAX * DELTAX));
+    vector<double> lower(numberOfPoint, -theta), diag(numberOfPoint, 1 + 2 * theta), upper(numberOfPoint, -theta);
+    lower[0] = 0;
+    upper[numberOfPoint - 1] = 0;
+    vector<double> temperature = Initializer(0.01, 1).getT_values(numberOfPoint, TSURF, TINIT);
+    long steps = std::max(1L, pointUpdates / numberOfPoint);
+    ImplicitMethods implicitMethods;
+
+    SuiteResult result = {"thomasAlgorithm", numberOfPoint, steps, 0, 120.0, 0};
+    result.seconds = timeBest([&]
+                              {
+        vector<double> x = temperature;
+        for (long step = 0; step < steps; step++)
+        {
+            x = implicitMethods.thomasAlgorithm(x, lower, diag, upper);
+        } },
+                              repetitions, result.allocations);
+    return result;
+}
+
+/**
+ * @brief Laasonen matrix I - theta M of a rod, with M deltax^-2 the second- or fourth-order approximation of d2T/dx2
+ * (see BandedOperator): tridiagonal, five-band, and cyclic for a periodic rod.
+ */
+BandedMatrix laasonenMatrix(int numberOfPoint, double theta, bool fourthOrder, bool periodic)
+{
+    BandedMatrix matrix;
+    matrix.cyclic = periodic;
+    if (fourthOrder)
+    {
+        matrix.lower2.assign(numberOfPoint, theta / 12);
+        matrix.lower.assign(numberOfPoint, -16 * theta / 12);
+        matrix.diag.assign(numberOfPoint, 1 + 30 * theta / 12);
+        matrix.upper.assign(numberOfPoint, -16 * theta / 12);
+        matrix.upper2.assign(numberOfPoint, theta / 12);
+    }
+    else
+    {
+        matrix.lower.assign(numberOfPoint, -theta);
+        matrix.diag.assign(numberOfPoint, 1 + 2 * theta);
+        matrix.upper.assign(numberOfPoint, -theta);
+    }
+    return matrix;
+}
+
+/**
+ * @brief Suite entry for a BandedSolver backend: solves in place, step after step, with the Laasonen matrix (dt of
+ * main.cpp) of the structure the backend is selected for (tridiagonal, periodic tridiagonal, five-band, periodic
+ * five-band). Traffic model: Thomas 56 bytes per point update (see suiteImplicit), cyclic Thomas adds the update with
+ * z (24 bytes), the pentadiagonal LU reads x and five coefficients and writes x twice (72 bytes); multigrid is
+ * iterative and has no traffic model (0): its entry reports the V-cycles per solve instead. At least 5 solves are
+ * timed, so that the large grids are not timed on a single solve.
+ */
+SuiteResult suiteBandedSolver(BandedSolver::Backend backend, int numberOfPoint, long pointUpdates, int repetitions)
+{
+    double theta = D * (0.01 / (DELTAX * DELTAX));
+    bool fourthOrder = backend == BandedSolver::Pentadiagonal || backend == BandedSolver::Multigrid;
+    bool periodic = backend == BandedSolver::CyclicThomas || backend == BandedSolver::Multigrid;
+    BandedSolver solver;
+    solver.factorize(laasonenMatrix(numberOfPoint, theta, fourthOrder, periodic));
+    vector<double> temperature = Initializer(0.01, 1).getT_values(numberOfPoint, TSURF, TINIT);
+    long steps = std::max(5L, pointUpdates / numberOfPoint);
+    double bytesPerUpdate = backend == BandedSolver::Thomas ? 56.0 : backend == BandedSolver::CyclicThomas ? 80.0 : backend == BandedSolver::Pentadiagonal ? 72.0 : 0.0;
+
+    SuiteResult result = {string("solver_") + BandedSolver::backendName(backend), numberOfPoint, steps, 0, bytesPerUpdate, 0};
+    vector<double> x(numberOfPoint);
+    long cycles = 0;
+    result.seconds = timeBest([&]
+                              {
+        x = temperature;
+        cycles = 0;
+        for (long step = 0; step < steps; step++)
+        {
+            solver.solve(x);
+            cycles += solver.getCycles();
+        } },
+                              repetitions, result.allocations);
+    result.iterationsPerStep = static_cast<double>(cycles) / steps;
+    return result;
+}
+
+/**
+ * @brief Times every scheme, thomasAlgorithm and the BandedSolver backends on each grid size and writes one
+ * tab-separated line per run.
+ * Columns: name, N, steps, seconds, ns per point update, modelled GB/s (the traffic model of each entry over the
+ * time, not a measured bandwidth), its fraction of the STREAM triad bandwidth, heap allocations per step, and the
+ * iterations per step of an iterative solver. The fraction is only given ('-' otherwise) when the bytes an entry
+ * sweeps per step exceed the last-level cache: smaller grids run from cache, where the DRAM bandwidth of STREAM
+ * does not bound them. The STREAM arrays are twice the last-level cache at least, for the same reason.
+ * @param resultsFile Machine-readable output, compared between builds by bench_compare.py
+ * @param quick Smaller grids and fewer point updates
+ */
+void runSuite(const string &resultsFile, bool quick)
+{
+    long pointUpdates = quick ? 20000000L : 200000000L;
+    int repetitions = quick ? 1 : 3;
+    vector<int> gridSizes = quick ? vector<int>{1000, 100000} : vector<int>{1000, 10000, 100000, 1000000};
+
+    long cache = lastLevelCache();
+    double stream = streamTriad(std::max(quick ? (1L << 21) : (1L << 23), 2 * cache / 24));
+    cout << "STREAM triad	" << stream << " GB/s" << endl;
+
+    vector<SuiteResult> results;
+    for (int numberOfPoint : gridSizes)
+    {
+        results.push_back(suiteExplicit("richardsonMethods", &ExplicitMethods::richardsonMethods, numberOfPoint, pointUpdates, repetitions));
+        results.push_back(suiteExplicit("dufort_frankelMethods", &ExplicitMethods::dufort_frankelMethods, numberOfPoint, pointUpdates, repetitions));
+        results.push_back(suiteImplicit("laasonenMethod", &ImplicitMethods::laasonenMethod, 56.0, numberOfPoint, pointUpdates / 4, repetitions));
+        results.push_back(suiteImplicit("crankNicholsonMethod", &ImplicitMethods::crankNicholsonMethod, 88.0, numberOfPoint, pointUpdates / 4, repetitions));
+        results.push_back(suiteThomas(numberOfPoint, pointUpdates / 8, repetitions));
+        for (BandedSolver::Backend backend : {BandedSolver::Thomas, BandedSolver::CyclicThomas, BandedSolver::Pentadiagonal, BandedSolver::Multigrid})
+        {
+            //! A V-cycle costs tens of times a direct solve
+            long updates = backend == BandedSolver::Multigrid ? pointUpdates / 64 : pointUpdates / 8;
+            results.push_back(suiteBandedSolver(backend, numberOfPoint, updates, repetitions));
+        }
+    }
+
+    ofstream file(resultsFile);
+    file << "# stencil=" << StencilKernels::instructionSet() << " batched=" << BatchedTridiagonalSolver::instructionSet()
+         << " stream_gbps=" << stream << " quick=" << quick << "\n";
+    file << "name\tN\tsteps\tseconds\tns_per_update\tmodel_gb_per_s\tstream_fraction\tallocations_per_step\titerations_per_step\n";
+    for (const SuiteResult &result : results)
+    {
+        double updates = static_cast<double>(result.steps) * result.numberOfPoint;
+        double nsPerUpdate = 1e9 * result.seconds / updates;
+        double gbPerSecond = result.bytesPerUpdate * updates / result.seconds * 1e-9;
+        double allocationsPerStep = static_cast<double>(result.allocations) / result.steps;
+        bool dramResident = result.bytesPerUpdate * result.numberOfPoint > cache;
+
+        file << result.name << "\t" << result.numberOfPoint << "\t" << result.steps << "\t" << result.seconds << "\t"
+             << nsPerUpdate << "\t" << gbPerSecond << "\t";
+        if (dramResident)
+        {
+            file << gbPerSecond / stream;
+        }
+        else
+        {
+            file << "-";
+        }
+        file << "\t" << allocationsPerStep << "\t" << result.iterationsPerStep << "\n";
+
+        cout << result.name << "\tN=" << result.numberOfPoint << "\t" << result.steps << " steps\t" << nsPerUpdate << " ns/point-update\t";
+        if (result.iterationsPerStep > 0)
+        {
+            cout << result.iterationsPerStep << " iterations/step\t";
+        }
+        else
+        {
+            cout << gbPerSecond << " GB/s modelled";
+            if (dramResident)
+            {
+                cout << " (" << 100 * gbPerSecond / stream << "% of STREAM)";
+            }
+            cout << "\t";
+        }
+        cout << allocationsPerStep << " allocations/step" << endl;
+    }
+    cout << "Results written to " << resultsFile << endl;
+}
+
+/**
+ * @brief Solves K profiles with the batched Laasonen / Crank-Nicholson entry points and with K separate calls.
+ * Reports both timings and checks that every member matches its separate run exactly.
+ */
+void benchBatch(int batchSize, int numStep)
+{
+    double deltat = 0.01;
+    Initializer values = Initializer(deltat, deltat * numStep);
+    ImplicitMethods implicitMethods;
+
+    //! Members differ by their surface and initial temperatures
+    vector<double> tsurf(batchSize);
+    vector<vector<double>> temperatureInits(batchSize);
+    for (int k = 0; k < batchSize; k++)
+    {
+        tsurf[k] = TSURF + k;
+        temperatureInits[k] = values.getT_values(NUMBER_OF_POINTS, tsurf[k], TINIT - k);
+    }
+
+    const char *names[2] = {"LaasonenBatch", "CrankNicholsonBatch"};
+    for (int scheme = 0; scheme < 2; scheme++)
+    {
+        auto start = chrono::steady_clock::now();
+        vector<vector<double>> batch = scheme == 0
+                                           ? implicitMethods.laasonenMethodBatch(DELTAX, NUMBER_OF_POINTS, tsurf, D, deltat, values.gett(), temperatureInits)
+                                           : implicitMethods.crankNicholsonMethodBatch(DELTAX, NUMBER_OF_POINTS, tsurf, D, deltat, values.gett(), temperatureInits);
+        auto middle = chrono::steady_clock::now();
+
+        bool identical = true;
+        for (int k = 0; k < batchSize; k++)
+        {
+            vector<double> single = scheme == 0
+                                        ? implicitMethods.laasonenMethod(DELTAX, NUMBER_OF_POINTS, tsurf[k], TINIT - k, D, deltat, values.gett(), temperatureInits[k])
+                                        : implicitMethods.crankNicholsonMethod(DELTAX, NUMBER_OF_POINTS, tsurf[k], TINIT - k, D, deltat, values.gett(), temperatureInits[k]);
+            identical = identical && single == batch[k];
+        }
+        auto stop = chrono::steady_clock::now();
+
+        double batched = chrono::duration<double>(middle - start).count();
+        double separate = chrono::duration<double>(stop - middle).count();
+        cout << names[scheme] << "\tK=" << batchSize << "\t" << numStep << " steps\t"
+             << batched << " s batched\t" << separate << " s separate\t"
+             << "speedup " << separate / batched << "\t"
+             << (identical ? "identical" : "MISMATCH") << endl;
+    }
+}
+
+/**
+ * @brief Strong scaling of the partitioned Thomas solver on a Laasonen matrix of the given size.
+ * Each thread count is compared with the serial TridiagonalSolver for time and maximum relative difference.
+ */
+void benchParallelThomas(int size, int repetitions)
+{
+    double theta = D * (0.01 / (DELTAX * DELTAX));
+    vector<double> lower(size, -theta), diag(size, 1 + 2 * theta), upper(size, -theta);
+    lower[0] = 0;
+    upper[size - 1] = 0;
+
+    vector<double> rhs(size);
+    for (int i = 0; i < size; i++)
+    {
+        rhs[i] = TINIT + (TSURF - TINIT) * std::sin(0.001 * i);
+    }
+
+    //! Serial reference
+    TridiagonalSolver serial(lower, diag, upper);
+    vector<double> reference = rhs;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+    {
+        reference = rhs;
+        serial.solve(reference);
+    }
+    double serialSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / repetitions;
+    cout << "Thomas\tN=" << size << "\tserial\t" << serialSeconds << " s/solve" << endl;
+
+    int maxThreads = std::max(2, ThreadPool::hardwareThreads());
+    for (int threads = 1; threads <= maxThreads; threads = threads * 2 > maxThreads && threads != maxThreads ? maxThreads : threads * 2)
+    {
+        ParallelTridiagonalSolver parallel(std::make_shared<ThreadPool>(threads));
+        parallel.factorize(lower, diag, upper);
+        vector<double> x = rhs;
+        start = chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++)
+        {
+            x = rhs;
+            parallel.solve(x);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / repetitions;
+
+        double difference = 0;
+        for (int i = 0; i < size; i++)
+        {
+            difference = std::max(difference, std::abs(x[i] - reference[i]) / std::abs(reference[i]));
+        }
+        cout << "PartitionedThomas\tN=" << size << "\t" << threads << " threads\t" << seconds << " s/solve\t"
+             << "speedup " << serialSeconds / seconds << "\tmax relative difference " << difference << endl;
+    }
+}
+
+/**
+ * @brief Steps per second of the explicit schemes versus grid size, time step by time step and temporally blocked.
+ * The grid step is chosen so that beta = 0.4 on every grid; both loops must give bit-for-bit identical results
+ * (compared with memcmp, Richardson is unstable and overflows to NaN on long runs).
+ */
+void benchTemporalBlocking(int numberOfPoint, long pointUpdates, int blockSteps)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    double deltat = 0.4 * deltax * deltax / D;
+    int numStep = std::max(3L, pointUpdates / numberOfPoint);
+
+    Initializer values = Initializer(deltat, deltat * numStep);
+    vector<double> temperatureInit = values.getT_values(numberOfPoint, TSURF, TINIT);
+
+    const char *names[2] = {"Richardson", "DufortFrankel"};
+    ExplicitScheme schemes[2] = {&ExplicitMethods::richardsonMethods, &ExplicitMethods::dufort_frankelMethods};
+    for (int scheme = 0; scheme < 2; scheme++)
+    {
+        ExplicitMethods naive;
+        ExplicitMethods blocked;
+        blocked.setTemporalBlocking(blockSteps);
+
+        auto start = chrono::steady_clock::now();
+        vector<double> reference = (naive.*schemes[scheme])(deltax, numberOfPoint, TSURF, TINIT, D, deltat, values.gett(), temperatureInit, 1);
+        auto middle = chrono::steady_clock::now();
+        vector<double> result = (blocked.*schemes[scheme])(deltax, numberOfPoint, TSURF, TINIT, D, deltat, values.gett(), temperatureInit, 1);
+        auto stop = chrono::steady_clock::now();
+
+        double naiveSeconds = chrono::duration<double>(middle - start).count();
+        double blockedSeconds = chrono::duration<double>(stop - middle).count();
+        cout << names[scheme] << "\tN=" << numberOfPoint << "\t"
+             << numStep / naiveSeconds << " steps/s naive\t"
+             << numStep / blockedSeconds << " steps/s blocked (" << blockSteps << " steps/tile)\t"
+             << (std::memcmp(reference.data(), result.data(), reference.size() * sizeof(double)) == 0 ? "bit-for-bit identical" : "MISMATCH") << endl;
+    }
+}
+
+/**
+ * @brief Thread scaling of the Dufort-Frankel scheme on the persistent pool, for one grid size.
+ * Every thread count must reproduce the single-thread result bit-for-bit.
+ */
+void benchExplicitThreads(int numberOfPoint, long pointUpdates)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    double deltat = 0.4 * deltax * deltax / D;
+    int numStep = std::max(3L, pointUpdates / numberOfPoint);
+
+    Initializer values = Initializer(deltat, deltat * numStep);
+    vector<double> temperatureInit = values.getT_values(numberOfPoint, TSURF, TINIT);
+    ExplicitMethods explicitMethods;
+
+    vector<double> reference;
+    double serialSeconds = 0;
+    int maxThreads = std::max(2, ThreadPool::hardwareThreads());
+    for (int threads = 1; threads <= maxThreads; threads = threads * 2 > maxThreads && threads != maxThreads ? maxThreads : threads * 2)
+    {
+        //! Warm-up call starts the pool and places the levels
+        explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, deltat * 3, temperatureInit, threads);
+
+        auto start = chrono::steady_clock::now();
+        vector<double> result = explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, values.gett(), temperatureInit, threads);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if (threads == 1)
+        {
+            reference = result;
+            serialSeconds = seconds;
+        }
+        cout << "DufortFrankelThreads\tN=" << numberOfPoint << "\t" << threads << " threads\t"
+             << 1e9 * seconds / (static_cast<double>(numStep) * numberOfPoint) << " ns/point-update\t"
+             << "speedup " << serialSeconds / seconds << "\t"
+             << (std::memcmp(reference.data(), result.data(), reference.size() * sizeof(double)) == 0 ? "bit-for-bit identical" : "MISMATCH") << endl;
+    }
+}
+
+/**
+ * @brief Dufort-Frankel time series on one grid: no output, one CSV file per frame, and one binary snapshot file
+ * written in float64 and float32 by the background writer. The float64 file is read back and compared bit-for-bit.
+ */
+void benchSnapshotOutput(int numberOfPoint, int frames, int stepsPerFrame)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    double deltat = 0.4 * deltax * deltax / D;
+
+    Initializer values = Initializer(deltat, deltat * frames * stepsPerFrame);
+    vector<double> temperatureInit = values.getT_values(numberOfPoint, TSURF, TINIT);
+    vector<double> outputTimes;
+    for (int frame = 1; frame <= frames; frame++)
+    {
+        //! Half a step past the frame time so that the truncation to a level is exact
+        outputTimes.push_back((frame * stepsPerFrame + 1.5) * deltat);
+    }
+
+    const char *modes[4] = {"none", "csv", "float64", "float32"};
+    vector<double> lastFrame;
+    for (int mode = 0; mode < 4; mode++)
+    {
+        ExplicitMethods explicitMethods;
+        SnapshotObserver observer;
+        unique_ptr<SnapshotWriter> writer;
+        int frame = 0;
+        if (mode == 1)
+        {
+            observer = [&](double, span<const double> temperature)
+            { CsvExporter::write("bench_snapshot_" + to_string(frame++) + ".csv", temperature); };
+        }
+        else if (mode > 1)
+        {
+            writer = make_unique<SnapshotWriter>("bench_snapshot.snap", SnapshotWriter::makeHeader("dufort_frankel", numberOfPoint, deltax, deltat, D, TSURF, TINIT, mode == 3));
+            observer = [&](double t, span<const double> temperature)
+            { writer->write(t, temperature); };
+        }
+        else
+        {
+            observer = [&](double, span<const double> temperature)
+            { lastFrame.assign(temperature.begin(), temperature.end()); };
+        }
+
+        auto start = chrono::steady_clock::now();
+        explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, outputTimes, temperatureInit, observer);
+        if (writer)
+        {
+            writer->close();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cout << "SnapshotOutput	N=" << numberOfPoint << "	" << frames << " frames	" << modes[mode] << "	" << seconds << " s";
+        if (mode == 2)
+        {
+            SnapshotReader reader("bench_snapshot.snap");
+            span<const double> stored = reader.values(reader.getFrames() - 1);
+            cout << "	" << reader.getFrames() << " frames read back, last "
+                 << (std::memcmp(stored.data(), lastFrame.data(), lastFrame.size() * sizeof(double)) == 0 ? "bit-for-bit identical" : "MISMATCH");
+        }
+        cout << endl;
+    }
+
+    for (int frame = 0; frame < frames; frame++)
+    {
+        std::remove(("bench_snapshot_" + to_string(frame) + ".csv").c_str());
+    }
+    std::remove("bench_snapshot.snap");
+}
+
+/**
+ * @brief Laasonen up to time t with fixed steps and with adaptive steps, each compared with a fixed run at deltat / 256
+ * ending at the same time: error, tridiagonal solves and time.
+ */
+void benchAdaptive(double t)
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    double deltat = 0.01;
+    Initializer values = Initializer(deltat, t);
+    vector<double> temperatureInit = values.getT_values(numberOfPoint, TSURF, TINIT);
+    ImplicitMethods implicitMethods;
+
+    //! Every run ends at (t / deltat - 1) deltat; half a fine step more keeps the truncation of the reference exact
+    double end = (static_cast<int>(t / deltat) - 1) * deltat;
+    vector<double> reference = implicitMethods.laasonenMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat / 256, end + 1.5 * deltat / 256, temperatureInit);
+    auto error = [&](const vector<double> &temperature)
+    {
+        double largest = 0;
+        for (int i = 0; i < numberOfPoint; i++)
+        {
+            largest = std::max(largest, std::abs(temperature[i] - reference[i]));
+        }
+        return largest;
+    };
+
+    double fixedDeltats[3] = {deltat, deltat / 4, deltat / 16};
+    for (int i = 0; i < 3; i++)
+    {
+        auto start = chrono::steady_clock::now();
+        vector<double> temperature = implicitMethods.laasonenMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, fixedDeltats[i], end + 1.5 * fixedDeltats[i], temperatureInit);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Adaptive	t=" << t << "	fixed deltat=" << fixedDeltats[i] << "	" << static_cast<long>(std::round(end / fixedDeltats[i])) << " solves	"
+             << seconds << " s	error " << error(temperature) << endl;
+    }
+
+    double tolerances[3] = {1e-1, 1e-2, 1e-3};
+    for (int i = 0; i < 3; i++)
+    {
+        ImplicitMethods::AdaptiveReport report;
+        auto start = chrono::steady_clock::now();
+        vector<double> temperature = implicitMethods.laasonenMethodAdaptive(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit, tolerances[i], &report);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Adaptive	t=" << t << "	tolerance=" << tolerances[i] << "	" << report.solves << " solves (" << report.steps << " steps, "
+             << report.factorizations << " factorizations)	" << seconds << " s	error " << error(temperature) << endl;
+    }
+}
+
+/**
+ * @brief Each scheme up to time t with and without the steady-state detection: time, stop time and largest
+ * difference between the two results.
+ */
+void benchSteadyState(double t, double tolerance)
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    const char *names[4] = {"richardson", "dufort_frankel", "laasonen", "crank_nicholson"};
+    //! Richardson is unstable for any deltat, it never reaches the steady state and runs to t
+    double deltats[4] = {0.00001, 0.00001, 0.01, 0.01};
+    for (int scheme = 0; scheme < 4; scheme++)
+    {
+        Initializer values = Initializer(deltats[scheme], t);
+        vector<double> temperatureInit = values.getT_values(numberOfPoint, TSURF, TINIT);
+        vector<double> results[2];
+        double seconds[2];
+        double stopTime = 0;
+        for (int detect = 0; detect < 2; detect++)
+        {
+            ExplicitMethods explicitMethods;
+            ImplicitMethods implicitMethods;
+            explicitMethods.setSteadyStateDetection(detect ? tolerance : 0);
+            implicitMethods.setSteadyStateDetection(detect ? tolerance : 0);
+            auto start = chrono::steady_clock::now();
+            switch (scheme)
+            {
+            case 0:
+                results[detect] = explicitMethods.richardsonMethods(DELTAX, numberOfPoint, TSURF, TINIT, D, deltats[scheme], t, temperatureInit);
+                stopTime = explicitMethods.getStopTime();
+                break;
+            case 1:
+                results[detect] = explicitMethods.dufort_frankelMethods(DELTAX, numberOfPoint, TSURF, TINIT, D, deltats[scheme], t, temperatureInit);
+                stopTime = explicitMethods.getStopTime();
+                break;
+            case 2:
+                results[detect] = implicitMethods.laasonenMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltats[scheme], t, temperatureInit);
+                stopTime = implicitMethods.getStopTime();
+                break;
+            default:
+                results[detect] = implicitMethods.crankNicholsonMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltats[scheme], t, temperatureInit);
+                stopTime = implicitMethods.getStopTime();
+                break;
+            }
+            seconds[detect] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+
+        double difference = 0;
+        for (int i = 0; i < numberOfPoint; i++)
+        {
+            difference = std::max(difference, std::abs(results[1][i] - results[0][i]));
+        }
+        cout << "SteadyState\t" << names[scheme] << "\tt=" << t << "\tfull " << seconds[0] << " s\tdetection " << seconds[1] << " s, stopped at t="
+             << stopTime << "\tmax difference " << difference << endl;
+    }
+}
+
+void benchAnalytical(int numberOfPoint, int repetitions)
+{
+    //! Wall of the same length as the reference problem, refined to numberOfPoint points
+    double length = XMAX - XMIN;
+    double deltax = length / (numberOfPoint - 1);
+    AnalyticalSolution analytical(D, TSURF, TINIT);
+    vector<double> exact(numberOfPoint), profile(numberOfPoint);
+    double times[4] = {0.0001, 0.01, 0.5, 5.0};
+    for (double t : times)
+    {
+        //! A profile slightly off the solution stands for a solver output
+        analytical.evaluate(deltax, numberOfPoint, t * 1.01, profile);
+        analytical.evaluate(deltax, numberOfPoint, t, exact);
+
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++)
+        {
+            analytical.evaluate(deltax, numberOfPoint, t, exact);
+        }
+        double evaluateSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / repetitions;
+
+        AnalyticalSolution::ErrorNorms norms;
+        start = chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++)
+        {
+            norms = analytical.errorNorms(deltax, profile, t);
+        }
+        double normsSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / repetitions;
+
+        //! Direct summation of the Fourier series, one sin and one exp per point and term
+        int terms = analytical.fourierTerms(length, t);
+        int sample = std::min(numberOfPoint, 10000);
+        double difference = 0;
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < sample; i++)
+        {
+            double x = i * deltax, sum = 0;
+            for (int j = 0; j < terms; j++)
+            {
+                double n = 2 * j + 1;
+                sum += 4 / (n * M_PI) * std::sin(n * M_PI * x / length) * std::exp(-D * (n * M_PI / length) * (n * M_PI / length) * t);
+            }
+            double value = i == 0 ? TSURF : TSURF + (TINIT - TSURF) * sum;
+            difference = std::max(difference, std::abs(value - exact[i]));
+        }
+        double directSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / sample * numberOfPoint;
+
+        cout << "Analytical\tN=" << numberOfPoint << "\tt=" << t << "\t" << terms << " Fourier terms, " << analytical.imageTerms(length, t) << " image pairs"
+             << "\tevaluate " << 1e9 * evaluateSeconds / numberOfPoint << " ns/point\terror norms " << 1e9 * normsSeconds / numberOfPoint
+             << " ns/point\tdirect sum " << 1e9 * directSeconds / numberOfPoint << " ns/point (max difference " << difference << ")\tLinf " << norms.linf << endl;
+    }
+}
+
+void benchSpectral(int numberOfPoint, double deltat, double t)
+{
+    double deltax = static_cast<double>(XMAX - XMIN) / (numberOfPoint - 1);
+    Initializer values = Initializer(deltat, t);
+    vector<double> temperatureInit = values.getT_values(numberOfPoint, TSURF, TINIT);
+
+    ImplicitMethods implicitMethods;
+    auto start = chrono::steady_clock::now();
+    vector<double> stepped = implicitMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+    double steppingSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    //! The first call plans the transform, the timed ones reuse it
+    SpectralMethods spectralMethods;
+    vector<double> spectral = spectralMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+    int repetitions = 5;
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+    {
+        spectral = spectralMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+    }
+    double spectralSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / repetitions;
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+    {
+        spectralMethods.exponentialMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+    }
+    double exponentialSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / repetitions;
+
+    double difference = 0;
+    for (int i = 0; i < numberOfPoint; i++)
+    {
+        difference = std::max(difference, std::abs(spectral[i] - stepped[i]));
+    }
+    cout << "Spectral\tN=" << numberOfPoint << "\tdeltat=" << deltat << "\tt=" << t << "\tlaasonen stepping " << steppingSeconds << " s\tlaasonen spectral "
+         << spectralSeconds << " s (max difference " << difference << ")\texponential " << exponentialSeconds << " s" << endl;
+}
+
+/**
+ * @brief Dufort-Frankel (beta = 0.4), Laasonen and Crank-Nicholson (dt of main.cpp) on one grid in the three precisions:
+ * time per point update, largest difference with the double result and Linf error against the analytical solution at
+ * the time level of the result, which shows whether the rounding of the reduced precisions matters next to the
+ * discretization error.
+ */
+void benchPrecision(int numberOfPoint, long pointUpdates)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    AnalyticalSolution analytical(D, TSURF, TINIT);
+    const char *names[3] = {"dufort_frankel", "laasonen", "crank_nicholson"};
+    for (int scheme = 0; scheme < 3; scheme++)
+    {
+        double deltat = scheme == 0 ? 0.4 * deltax * deltax / D : 0.01;
+        int numStep = std::max(3L, pointUpdates / numberOfPoint);
+        double t = deltat * numStep;
+        double level = snapshotLevel(t, deltat, scheme == 0 ? 1 : 0) * deltat;
+        vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+        vector<double> reference;
+        for (Precision precision : {Precision::Double, Precision::Mixed, Precision::Float})
+        {
+            ExplicitMethods explicitMethods;
+            ImplicitMethods implicitMethods;
+            explicitMethods.setPrecision(precision);
+            implicitMethods.setPrecision(precision);
+            vector<double> result;
+            unsigned long long allocations;
+            double seconds = timeBest([&]
+                                      {
+                switch (scheme)
+                {
+                case 0:
+                    result = explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+                    break;
+                case 1:
+                    result = implicitMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+                    break;
+                default:
+                    result = implicitMethods.crankNicholsonMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+                    break;
+                } },
+                                      2, allocations);
+            if (reference.empty())
+            {
+                reference = result;
+            }
+            double difference = 0;
+            for (int i = 0; i < numberOfPoint; i++)
+            {
+                difference = std::max(difference, std::abs(result[i] - reference[i]));
+            }
+            double updates = static_cast<double>(numberOfPoint) * std::max(1, numStep - 1);
+            cout << "Precision\t" << names[scheme] << "\tN=" << numberOfPoint << "\t" << precisionName(precision) << "\t" << 1e9 * seconds / updates
+                 << " ns/point update\tmax difference with double " << difference << "\tLinf vs analytical " << analytical.errorNorms(deltax, result, level).linf << endl;
+        }
+    }
+}
+
+/**
+ * @brief E rods with their own tsurf and initial temperature, advanced by EnsembleMethods and one at a time by the
+ * single-rod methods. Prints the throughput of both in member-point updates per second and whether every member is
+ * identical to its single-rod result.
+ */
+void benchEnsemble(int numberOfPoint, int members, int numStep, int numberOfThreads)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    const char *names[4] = {"richardson", "dufort_frankel", "laasonen", "crank_nicholson"};
+    for (int scheme = 0; scheme < 4; scheme++)
+    {
+        //! Richardson is unstable: a small beta and few steps keep it finite
+        double deltat = scheme == 0 ? 0.1 * deltax * deltax / D : scheme == 1 ? 0.4 * deltax * deltax / D : 0.01;
+        double t = deltat * numStep;
+        Initializer values(deltat, t);
+        vector<double> tsurf(members);
+        vector<vector<double>> temperatureInits(members);
+        for (int k = 0; k < members; k++)
+        {
+            tsurf[k] = TSURF + 0.01 * k;
+            temperatureInits[k] = values.getT_values(numberOfPoint, tsurf[k], TINIT - 0.01 * k);
+        }
+
+        EnsembleMethods ensemble;
+        ensemble.setThreads(numberOfThreads);
+        ensemble.load(numberOfPoint, tsurf, temperatureInits);
+        auto start = chrono::steady_clock::now();
+        ensemble.run(static_cast<EnsembleMethods::Scheme>(scheme), deltax, D, deltat, t);
+        double ensembleSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        ExplicitMethods explicitMethods;
+        ImplicitMethods implicitMethods;
+        bool identical = true;
+        start = chrono::steady_clock::now();
+        for (int k = 0; k < members; k++)
+        {
+            vector<double> single;
+            switch (scheme)
+            {
+            case 0:
+                single = explicitMethods.richardsonMethods(deltax, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]);
+                break;
+            case 1:
+                single = explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]);
+                break;
+            case 2:
+                single = implicitMethods.laasonenMethod(deltax, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]);
+                break;
+            default:
+                single = implicitMethods.crankNicholsonMethod(deltax, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]);
+            }
+            span<const double> ensembleValues = ensemble.getTemperatures();
+            for (int i = 0; i < numberOfPoint && identical; i++)
+            {
+                identical = single[i] == ensembleValues[static_cast<size_t>(i) * members + k];
+            }
+        }
+        double singleSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        int levels = scheme < 2 ? 3 : scheme == 2 ? 1 : 2;
+        double updates = static_cast<double>(members) * numberOfPoint * snapshotLevel(t, deltat, scheme < 2 ? 1 : 0);
+        cout << "Ensemble\t" << names[scheme] << "\tN=" << numberOfPoint << "\tE=" << members << "\t" << numberOfThreads << " threads\t"
+             << ensemble.getTileMembers(levels) << " members per tile\tensemble " << updates / ensembleSeconds / 1e9 << " G member-point updates/s"
+             << "\tone rod at a time " << updates / singleSeconds / 1e9 << " G/s\tspeedup " << singleSeconds / ensembleSeconds << "\t"
+             << (identical ? "identical" : "MISMATCH") << endl;
+    }
+}
+
+/**
+ * @brief A coupled workload: the field is read back after every few steps. Compares resuming a snapshot method from a
+ * SolverState at each exchange (state copied in and out, matrix assembled and factorized again) with HeatSolver::advanceTo
+ * on its workspace. Prints the time and heap allocations per exchange, and whether both runs end on the same temperature.
+ */
+void benchIncremental(int numberOfPoint, int exchanges, int stepsPerExchange)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    const char *names[2] = {"dufort_frankel", "laasonen"};
+    for (int scheme = 0; scheme < 2; scheme++)
+    {
+        double deltat = scheme == 0 ? 0.4 * deltax * deltax / D : 0.01;
+        double t = deltat * exchanges * stepsPerExchange;
+        HeatProblem problem = {deltax, numberOfPoint, TSURF, D, deltat, Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT)};
+        double sum = 0;
+
+        //! Level k * stepsPerExchange at exchange k: numStep = k * stepsPerExchange + 1 for the snapshot method (snapshotLevel)
+        ExplicitMethods explicitMethods;
+        ImplicitMethods implicitMethods;
+        SolverState state;
+        vector<double> resumed;
+        unsigned long long allocationsBefore = g_allocations;
+        auto start = chrono::steady_clock::now();
+        for (int exchange = 1; exchange <= exchanges; exchange++)
+        {
+            vector<double> outputTime = {(exchange * stepsPerExchange + 1.5) * deltat};
+            SnapshotObserver observer = [&](double, span<const double> temperature)
+            { sum += temperature[numberOfPoint / 2]; };
+            if (scheme == 0)
+            {
+                explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, outputTime, problem.temperatureInit, observer, &state);
+            }
+            else
+            {
+                implicitMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, outputTime, problem.temperatureInit, observer, &state);
+            }
+        }
+        double resumeSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double resumeAllocations = static_cast<double>(g_allocations - allocationsBefore) / exchanges;
+        resumed = state.current;
+
+        HeatSolver solver(scheme == 0 ? HeatSolver::DufortFrankel : HeatSolver::Laasonen, problem);
+        allocationsBefore = g_allocations;
+        start = chrono::steady_clock::now();
+        for (int exchange = 1; exchange <= exchanges; exchange++)
+        {
+            solver.advanceTo((exchange * stepsPerExchange + 0.5) * deltat);
+            sum += solver.temperature()[numberOfPoint / 2];
+        }
+        double solverSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double solverAllocations = static_cast<double>(g_allocations - allocationsBefore) / exchanges;
+        span<const double> temperature = solver.temperature();
+        bool identical = std::equal(temperature.begin(), temperature.end(), resumed.begin(), resumed.end());
+
+        cout << "Incremental\t" << names[scheme] << "\tN=" << numberOfPoint << "\t" << stepsPerExchange << " steps per exchange"
+             << "\tresume from state " << 1e6 * resumeSeconds / exchanges << " us, " << resumeAllocations << " allocations"
+             << "\tHeatSolver " << 1e6 * solverSeconds / exchanges << " us, " << solverAllocations << " allocations"
+             << "\t" << (identical ? "bit-for-bit identical" : "MISMATCH") << endl;
+    }
+}
+
+/**
+ * @brief Accuracy of a stretched grid (Grid::stretched, s = 1) against a uniform one with the same number of points:
+ * Linf error of Crank-Nicholson at the time level of t against the analytical solution, with a time step small enough
+ * for the spatial error to dominate. Then the fewest stretched points that reach the error of the uniform grid of
+ * NUMBER_OF_POINTS points.
+ */
+void benchNonUniform(double deltat, double t)
+{
+    int uniformPoints = NUMBER_OF_POINTS;
+    AnalyticalSolution analytical(D, TSURF, TINIT);
+    NonUniformMethods methods;
+    auto error = [&](int numberOfPoint, double stretching)
+    {
+        Grid grid = Grid::stretched(XMAX - XMIN, numberOfPoint, D, stretching);
+        vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+        methods.setup(NonUniformMethods::CrankNicholson, grid, deltat);
+        span<const double> temperature = methods.run(TSURF, t, temperatureInit);
+        return analytical.errorNorms(grid.getPositions(), temperature, methods.getTime()).linf;
+    };
+
+    for (int numberOfPoint : {uniformPoints, 311, 161, 81, 41})
+    {
+        cout << "NonUniform	crank_nicholson	deltat=" << deltat << "	t=" << t << "	N=" << numberOfPoint << "	Linf uniform " << error(numberOfPoint, 0)
+             << "	stretched (s=1) " << error(numberOfPoint, 1) << endl;
+    }
+
+    //! The error decreases with N: bisection on the number of stretched points
+    double target = error(uniformPoints, 0);
+    int low = 3, high = uniformPoints;
+    while (high - low > 1)
+    {
+        int middle = (low + high) / 2;
+        (error(middle, 1) <= target ? high : low) = middle;
+    }
+    cout << "NonUniform	crank_nicholson	t=" << t << "	uniform N=" << NUMBER_OF_POINTS << " (Linf " << target << ") matched by " << high
+         << " stretched points, " << static_cast<double>(uniformPoints) / high << "x fewer" << endl;
+}
+
+/**
+ * @brief Cost per point update of the four schemes with per-point coefficients (NonUniformMethods on a uniform grid)
+ * against the uniform methods, and the largest difference of the Dufort-Frankel results (the same scheme, within round-off).
+ */
+void benchNonUniformCost(int numberOfPoint, long pointUpdates)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    Grid grid = Grid::uniform(deltax, numberOfPoint, D);
+    const char *names[4] = {"richardson", "dufort_frankel", "laasonen", "crank_nicholson"};
+    for (int scheme = 0; scheme < 4; scheme++)
+    {
+        //! Richardson is unstable at any time step: few enough steps that it stays finite
+        double deltat = scheme < 2 ? 0.4 * grid.explicitTimeStepLimit() : 0.01;
+        int numStep = std::max(3L, pointUpdates / numberOfPoint);
+        double t = deltat * (scheme == 0 ? 50 : numStep);
+        vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+
+        ExplicitMethods explicitMethods;
+        ImplicitMethods implicitMethods;
+        vector<double> uniform;
+        auto start = chrono::steady_clock::now();
+        switch (scheme)
+        {
+        case 0:
+            uniform = explicitMethods.richardsonMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+            break;
+        case 1:
+            uniform = explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+            break;
+        case 2:
+            uniform = implicitMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+            break;
+        case 3:
+            uniform = implicitMethods.crankNicholsonMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+            break;
+        }
+        double uniformSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        NonUniformMethods methods;
+        start = chrono::steady_clock::now();
+        vector<double> variable = methods.solve(static_cast<NonUniformMethods::Scheme>(scheme), grid, TSURF, deltat, t, temperatureInit);
+        double variableSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double updates = static_cast<double>(methods.getLevel()) * numberOfPoint;
+        cout << "NonUniformCost	" << names[scheme] << "	N=" << numberOfPoint << "	uniform " << 1e9 * uniformSeconds / updates << " ns/point update"
+             << "	per-point coefficients " << 1e9 * variableSeconds / updates << " ns/point update";
+        if (scheme < 2)
+        {
+            double difference = 0;
+            for (int i = 0; i < numberOfPoint; i++)
+            {
+                difference = std::max(difference, std::abs(variable[i] - uniform[i]) / std::max(1.0, std::abs(uniform[i])));
+            }
+            cout << "	relative difference " << difference;
+        }
+        cout << endl;
+    }
+}
+
+/**
+ * @brief Plate (nz = 1) or block of side XMAX - XMIN with every face at TSURF: time to reach t, cost per point update and
+ * Linf error against the product of the 1D analytical solutions, for the ADI schemes at deltat and for the explicit
+ * schemes at 0.4 of their stability limit (Richardson, unstable, only for 50 steps).
+ */
+void benchMultiDimensional(int numberOfPoint, int nz, double deltat, double t, int numberOfThreads)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    int dimensions = nz == 1 ? 2 : 3;
+    vector<double> temperatureInit = MultiDimensionalMethods::initialField(numberOfPoint, numberOfPoint, nz, TSURF, TINIT);
+    AnalyticalSolution analytical(D, TSURF, TINIT);
+    MultiDimensionalMethods methods;
+    methods.setThreads(numberOfThreads);
+    const char *names[4] = {"richardson", "dufort_frankel", "peaceman_rachford", "douglas"};
+    for (int scheme = 0; scheme < 4; scheme++)
+    {
+        if (scheme == MultiDimensionalMethods::PeacemanRachford && nz > 1)
+        {
+            continue;
+        }
+        double step = scheme < 2 ? 0.4 * deltax * deltax / (2 * dimensions * D) : deltat;
+        double end = scheme == MultiDimensionalMethods::Richardson ? 50 * step : t;
+        auto start = chrono::steady_clock::now();
+        vector<double> temperature = methods.solve(static_cast<MultiDimensionalMethods::Scheme>(scheme), deltax, numberOfPoint, numberOfPoint, nz, TSURF, D, step, end, temperatureInit);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        //! theta = (T - TSURF) / (TINIT - TSURF) of the block is the product of those of the walls along each axis
+        vector<double> wall = analytical.evaluate(deltax, numberOfPoint, methods.getTime());
+        double error = 0;
+        for (int k = 0; k < nz; k++)
+        {
+            double thetaZ = nz == 1 ? 1 : (wall[k] - TSURF) / (TINIT - TSURF);
+            for (int j = 0; j < numberOfPoint; j++)
+            {
+                for (int i = 0; i < numberOfPoint; i++)
+                {
+                    double theta = thetaZ * (wall[j] - TSURF) / (TINIT - TSURF) * (wall[i] - TSURF) / (TINIT - TSURF);
+                    double exact = TSURF + (TINIT - TSURF) * theta;
+                    error = std::max(error, std::abs(temperature[(static_cast<size_t>(k) * numberOfPoint + j) * numberOfPoint + i] - exact));
+                }
+            }
+        }
+
+        double updates = static_cast<double>(methods.getLevel()) * temperature.size();
+        cout << "MultiDimensional	" << names[scheme] << "	" << numberOfPoint << "^" << dimensions << "	threads=" << numberOfThreads << "	deltat=" << step
+             << "	t=" << methods.getTime() << "	" << seconds << " s	" << 1e9 * seconds / updates << " ns/point update	Linf " << error << endl;
+    }
+}
+
+/**
+ * @brief Dufort-Frankel run of numStep steps with a checkpoint every interval levels (flushed to the disk or left in the
+ * page cache) against the same run without checkpoints, then the time to restart from the checkpoint of the middle
+ * level and whether the resumed run ends bit-for-bit on the uninterrupted one.
+ */
+void benchCheckpoint(int numberOfPoint, int numStep, int interval)
+{
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    double deltat = 0.4 * deltax * deltax / D;
+    HeatProblem problem = {deltax, numberOfPoint, TSURF, D, deltat, Initializer(deltat, deltat * numStep).getT_values(numberOfPoint, TSURF, TINIT)};
+    const char *fileName = "bench_checkpoint.ckpt";
+
+    vector<double> reference;
+    double referenceSeconds = 0;
+    for (int mode = 0; mode < 3; mode++)
+    {
+        HeatSolver solver(HeatSolver::DufortFrankel, problem);
+        CheckpointWriter writer(fileName, mode == 1);
+        if (mode > 0)
+        {
+            solver.setCheckpointing(&writer, interval);
+        }
+        auto start = chrono::steady_clock::now();
+        solver.advance(numStep);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (mode == 0)
+        {
+            reference.assign(solver.temperature().begin(), solver.temperature().end());
+            referenceSeconds = seconds;
+            cout << "Checkpoint	N=" << numberOfPoint << "	" << numStep << " steps	no checkpoint	" << seconds << " s" << endl;
+            continue;
+        }
+        cout << "Checkpoint	N=" << numberOfPoint << "	" << numStep << " steps	every " << interval << " levels, " << (mode == 1 ? "durable" : "page cache") << "	"
+             << seconds << " s	" << writer.getCheckpoints() << " checkpoints, " << 1e3 * (seconds - referenceSeconds) / std::max(1L, writer.getCheckpoints())
+             << " ms each" << endl;
+    }
+
+    //! Stop in the middle, then continue from the file in a new solver
+    {
+        HeatSolver solver(HeatSolver::DufortFrankel, problem);
+        CheckpointWriter writer(fileName, false);
+        solver.advance(numStep / 2);
+        solver.writeCheckpoint(writer);
+    }
+    HeatSolver resumed(HeatSolver::DufortFrankel, problem);
+    auto start = chrono::steady_clock::now();
+    resumed.restart(CheckpointReader(fileName));
+    double restartSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    resumed.advance(numStep - resumed.getLevel() + 1);
+    span<const double> temperature = resumed.temperature();
+    bool identical = std::memcmp(temperature.data(), reference.data(), reference.size() * sizeof(double)) == 0;
+    cout << "Checkpoint	N=" << numberOfPoint << "	restart at level " << numStep / 2 + 1 << "	" << 1e6 * restartSeconds << " us	final level "
+         << (identical ? "bit-for-bit identical" : "MISMATCH") << " to the uninterrupted run" << endl;
+    std::remove(fileName);
+}
+
+/**
+ * @brief Every BandedSolver backend on the Laasonen matrices (dt of main.cpp) of the four structures it can meet:
+ * factorization time, time per point of a solve, V-cycles and relative residual |b - A x| / |b| of the solution. The
+ * backend that Automatic selects for each structure is marked.
+ */
+void benchLinearSolvers(int numberOfPoint, int solves)
+{
+    double theta = D * (0.01 / (DELTAX * DELTAX));
+    vector<double> temperature = Initializer(0.01, 1).getT_values(numberOfPoint, TSURF, TINIT);
+    const char *structures[4] = {"tridiagonal", "cyclic_tridiagonal", "pentadiagonal", "cyclic_pentadiagonal"};
+    for (int structure = 0; structure < 4; structure++)
+    {
+        BandedMatrix matrix = laasonenMatrix(numberOfPoint, theta, structure >= 2, structure % 2 == 1);
+        BandedSolver::Backend automatic = BandedSolver::selectBackend(matrix);
+        for (BandedSolver::Backend backend : {BandedSolver::Thomas, BandedSolver::CyclicThomas, BandedSolver::Pentadiagonal, BandedSolver::Multigrid})
+        {
+            BandedSolver solver;
+            solver.setBackend(backend);
+            auto start = chrono::steady_clock::now();
+            try
+            {
+                solver.factorize(matrix);
+            }
+            catch (const std::invalid_argument &)
+            {
+                continue;
+            }
+            double factorizeSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            vector<double> x(numberOfPoint);
+            double seconds = 0;
+            long cycles = 0;
+            for (int solve = 0; solve < solves; solve++)
+            {
+                x = temperature;
+                start = chrono::steady_clock::now();
+                solver.solve(x);
+                seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                cycles += solver.getCycles();
+            }
+
+            vector<double> product(numberOfPoint);
+            matrix.multiply(x, product);
+            double residual = 0;
+            double norm = 0;
+            for (int i = 0; i < numberOfPoint; i++)
+            {
+                residual = std::max(residual, std::abs(temperature[i] - product[i]));
+                norm = std::max(norm, std::abs(temperature[i]));
+            }
+            cout << "LinearSolver\t" << structures[structure] << "\tN=" << numberOfPoint << "\t" << BandedSolver::backendName(backend)
+                 << (backend == automatic ? " (automatic)" : "") << "\tfactorize " << 1e3 * factorizeSeconds << " ms\t"
+                 << 1e9 * seconds / (static_cast<double>(solves) * numberOfPoint) << " ns/point per solve\t"
+                 << static_cast<double>(cycles) / solves << " V-cycles\trelative residual " << residual / norm << endl;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    //! ./bench [--quick] [--suite-only] [--output results.tsv]
+    string resultsFile = "bench_results.tsv";
+    bool quick = false;
+    bool suiteOnly = false;
+    for (int i = 1; i < argc; i++)
+    {
+        string argument = argv[i];
+        if (argument == "--quick")
+        {
+            quick = true;
+        }
+        else if (argument == "--suite-only")
+        {
+            suiteOnly = true;
+        }
+        else if (argument == "--output" && i + 1 < argc)
+        {
+            resultsFile = argv[++i];
+        }
+        else
+        {
+            cerr << "Usage: " << argv[0] << " [--quick] [--suite-only] [--output results.tsv]" << endl;
+            return 1;
+        }
+    }
+
+    cout << "Stencil kernels: " << StencilKernels::instructionSet() << endl;
+    cout << "Batched Thomas kernel: " << BatchedTridiagonalSolver::instructionSet() << endl;
+    runSuite(resultsFile, quick);
+    if (suiteOnly || quick)
+    {
+        return 0;
+    }
+
+    int batchSizes[4] = {1, 8, 32, 128};
+    for (int i = 0; i < 4; i++)
+    {
+        benchBatch(batchSizes[i], 2000);
+    }
+
+    int gridSizes[5] = {1000, 10000, 100000, 1000000, 10000000};
+    for (int i = 0; i < 5; i++)
+    {
+        benchTemporalBlocking(gridSizes[i], 200000000L, 32);
+    }
+
+    //! 10^8 points need about 4 GB (three levels, the initial profile and the result)
+    double memoryBytes = static_cast<double>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE);
+    int threadGridSizes[5] = {10000, 100000, 1000000, 10000000, 100000000};
+    for (int i = 0; i < 5; i++)
+    {
+        if (threadGridSizes[i] * 8.0 * 5 > 0.75 * memoryBytes)
+        {
+            cout << "DufortFrankelThreads\tN=" << threadGridSizes[i] << "\tskipped, not enough memory" << endl;
+            continue;
+        }
+        benchExplicitThreads(threadGridSizes[i], 200000000L);
+    }
+
+    benchParallelThomas(1000000, 20);
+    benchParallelThomas(10000000, 3);
+
+    benchSnapshotOutput(100000, 100, 10);
+    benchSnapshotOutput(1000000, 20, 10);
+
+    benchAdaptive(5.0);
+    benchAdaptive(50.0);
+
+    benchSteadyState(50.0, 1e-3);
+
+    benchAnalytical(100000, 20);
+    benchAnalytical(10000000, 3);
+
+    benchSpectral(NUMBER_OF_POINTS, 0.01, 0.5);
+    benchSpectral(NUMBER_OF_POINTS, 0.01, 50.0);
+    benchSpectral(100001, 0.001, 0.5);
+    benchSpectral(100001, 0.001, 5.0);
+
+    benchPrecision(10000, 20000000L);
+    benchPrecision(1000000, 20000000L);
+
+    benchEnsemble(NUMBER_OF_POINTS, 1024, 200, 1);
+    benchEnsemble(NUMBER_OF_POINTS, 16, 2000, 1);
+    if (ThreadPool::hardwareThreads() > 1)
+    {
+        benchEnsemble(NUMBER_OF_POINTS, 1024, 200, ThreadPool::hardwareThreads());
+    }
+
+    benchIncremental(NUMBER_OF_POINTS, 1000, 1);
+    benchIncremental(NUMBER_OF_POINTS, 1000, 10);
+    benchIncremental(100000, 100, 10);
+
+    benchNonUniform(1e-5, 0.1);
+    benchNonUniform(1e-5, 0.5);
+    benchNonUniformCost(NUMBER_OF_POINTS, 20000000L);
+    benchNonUniformCost(100000, 20000000L);
+
+    benchCheckpoint(NUMBER_OF_POINTS, 1000000, 100000);
+    benchCheckpoint(1000000, 200, 50);
+
+    benchLinearSolvers(NUMBER_OF_POINTS, 1000);
+    benchLinearSolvers(1000000, 10);
+
+    benchMultiDimensional(201, 1, 0.01, 0.5, 1);
+    benchMultiDimensional(201, 1, 0.001, 0.5, 1);
+    benchMultiDimensional(61, 61, 0.01, 0.5, 1);
+    if (ThreadPool::hardwareThreads() > 1)
+    {
+        benchMultiDimensional(61, 61, 0.01, 0.5, ThreadPool::hardwareThreads());
+    }
+
+    return 0;
+}
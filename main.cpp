@@ -1,10 +1,9 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <string>
 
-#include "Initializer.h"
-#include "ExplicitMethods.h"
-#include "ImplicitMethods.h"
+#include "ScenarioRunner.h"
 
 #define DELTAX 0.05
 #define TSURF 149.0
@@ -16,52 +15,25 @@
 
 using namespace std;
 
-int main()
+int main(int argc, char *argv[])
 {
+    // Scenario file: first argument, scenarios.cfg by default
+    string scenarioFile = argc > 1 ? argv[1] : "scenarios.cfg";
 
-    // Initialize the initial values and initial vector
-    Initializer values = Initializer(0.01, 0.05);
-    vector<double> temperatureInit = values.getT_values(NUMBER_OF_POINTS, TSURF, TINIT);
+    // Default grid and physical parameters, the scenario file may override them
+    ScenarioRunner runner = ScenarioRunner(DELTAX, NUMBER_OF_POINTS, TSURF, TINIT, D);
 
-    // Create an object of ExplicitMethods
-    ExplicitMethods explicitMethods;
-
-    // Create an object of ImplicitMethods
-    ImplicitMethods ImplicitMethods;
-
-    double timevalues[5] = {0.1, 0.2, 0.3, 0.4, 0.5};
-
-    for (int i = 0; i < 5; i++)
+    try
     {
-        values.sett(timevalues[i]);
-        vector<double> richardson = explicitMethods.richardsonMethods(DELTAX, NUMBER_OF_POINTS, TSURF, TINIT, D, values.getDeltat(), values.gett(), temperatureInit);
-        vector<double> dufort_Frankel = explicitMethods.dufort_frankelMethods(DELTAX, NUMBER_OF_POINTS, TSURF, TINIT, D, values.getDeltat(), values.gett(), temperatureInit);
-        explicitMethods.saveCSV("Richardson" + to_string(timevalues[i]) + ".csv", richardson);
-        explicitMethods.saveCSV("DufortFrankelt" + to_string(timevalues[i]) + ".csv", dufort_Frankel);
-
-        vector<double> laasonen = ImplicitMethods.laasonenMethod(DELTAX, NUMBER_OF_POINTS, TSURF, TINIT, D, values.getDeltat(), values.gett(), temperatureInit);
-        vector<double> cn = ImplicitMethods.crankNicholsonMethod(DELTAX, NUMBER_OF_POINTS, TSURF, TINIT, D, values.getDeltat(), values.gett(), temperatureInit);
-        ImplicitMethods.saveCSV("Laasonen" + to_string(timevalues[i]) + ".csv", laasonen);
-        ImplicitMethods.saveCSV("Cn" + to_string(timevalues[i]) + ".csv", cn);
+        // Read the final times, time steps and schemes to run, then run them concurrently
+        runner.loadFile(scenarioFile);
+        runner.run();
     }
-
-    // Laasonen  Convergence Study
-    values.sett(0.5);
-
-    double deltatvalues[4] = {0.1, 0.05, 0.025, 0.01};
-
-    for (int i = 0; i < 4; i++)
+    catch (const exception &error)
     {
-        values.setDeltat(deltatvalues[i]);
-        vector<double> laasonen_deltat = ImplicitMethods.laasonenMethod(DELTAX, NUMBER_OF_POINTS, TSURF, TINIT, D, values.getDeltat(), values.gett(), temperatureInit);
-        ImplicitMethods.saveCSV("laasonenDeltat" + to_string(timevalues[i]) + ".csv", laasonen_deltat);
+        cerr << error.what() << endl;
+        return 1;
     }
 
-    // Call the dufort_frankelMethods method for deltat = 0.0000005h
-    values.sett(0.5);
-    values.setDeltat(0.0000005);
-    vector<double> dufort_Frankel_test = explicitMethods.dufort_frankelMethods(DELTAX, NUMBER_OF_POINTS, TSURF, TINIT, D, values.getDeltat(), values.gett(), temperatureInit);
-    explicitMethods.saveCSV("DufortFrankeldeltat_0.0000005.csv", dufort_Frankel_test);
-
     return 0;
 }
@@ -0,0 +1,710 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <span>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "Initializer.h"
+#include "ExplicitMethods.h"
+#include "ImplicitMethods.h"
+#include "SnapshotWriter.h"
+#include "SnapshotReader.h"
+#include "AnalyticalSolution.h"
+#include "SpectralMethods.h"
+#include "EnsembleMethods.h"
+#include "Grid.h"
+#include "NonUniformMethods.h"
+#include "MultiDimensionalMethods.h"
+#include "HeatSolver.h"
+#include "CheckpointWriter.h"
+#include "CheckpointReader.h"
+
+#define DELTAX 0.05
+#define TSURF 149.0
+#define TINIT 38.0
+#define D 93.0
+#define XMIN 0
+#define XMAX 31
+#define NUMBER_OF_POINTS 1 + ((XMAX - XMIN) / DELTAX)
+
+using namespace std;
+
+//! Number of failed checks
+static int g_failures = 0;
+
+//! Prints one check and counts it when it fails
+void check(bool passed, const string &what)
+{
+    cout << (passed ? "ok  \t" : "FAIL\t") << what << endl;
+    if (!passed)
+    {
+        g_failures++;
+    }
+}
+
+//! Same size and same bits (memcmp, so that two NaN levels of an unstable run also compare equal)
+bool identical(span<const double> a, span<const double> b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size_bytes()) == 0;
+}
+
+//! Largest |a_i - b_i|
+double maxDifference(span<const double> a, span<const double> b)
+{
+    double difference = 0;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        difference = std::max(difference, std::abs(a[i] - b[i]));
+    }
+    return difference;
+}
+
+//! Check description followed by a measured difference and its bound
+string withDifference(const string &what, double difference, double bound)
+{
+    ostringstream text;
+    text << what << " (max difference " << scientific << difference << ", bound " << bound << ")";
+    return text.str();
+}
+
+/**
+ * @brief The batched implicit methods give every member the result of its single-rod run bit for bit.
+ */
+void testBatch()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    int members = 7;
+    double deltat = 0.01;
+    double t = 1.0;
+    Initializer values(deltat, t);
+    vector<double> tsurf(members);
+    vector<vector<double>> temperatureInits(members);
+    for (int k = 0; k < members; k++)
+    {
+        tsurf[k] = TSURF + k;
+        temperatureInits[k] = values.getT_values(numberOfPoint, tsurf[k], TINIT - k);
+    }
+
+    ImplicitMethods implicitMethods;
+    vector<vector<double>> batch = implicitMethods.laasonenMethodBatch(DELTAX, numberOfPoint, tsurf, D, deltat, t, temperatureInits);
+    bool same = true;
+    for (int k = 0; k < members; k++)
+    {
+        same = same && identical(batch[k], implicitMethods.laasonenMethod(DELTAX, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]));
+    }
+    check(same, "laasonen batch of " + to_string(members) + " = single-rod runs");
+
+    batch = implicitMethods.crankNicholsonMethodBatch(DELTAX, numberOfPoint, tsurf, D, deltat, t, temperatureInits);
+    same = true;
+    for (int k = 0; k < members; k++)
+    {
+        same = same && identical(batch[k], implicitMethods.crankNicholsonMethod(DELTAX, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]));
+    }
+    check(same, "crank_nicholson batch of " + to_string(members) + " = single-rod runs");
+}
+
+/**
+ * @brief The temporally blocked explicit runs give the time-step-by-time-step result bit for bit, with tiles
+ * smaller and larger than the rod.
+ */
+void testTemporalBlocking()
+{
+    for (int numberOfPoint : {5, 621, 20000})
+    {
+        double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+        double deltat = 0.1 * deltax * deltax / D;
+        double t = deltat * 200;
+        vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+        ExplicitMethods naive;
+        ExplicitMethods blocked;
+        blocked.setTemporalBlocking(16, 256);
+        check(identical(naive.richardsonMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit),
+                        blocked.richardsonMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit)),
+              "richardson N=" + to_string(numberOfPoint) + " temporally blocked = naive loop");
+        check(identical(naive.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit),
+                        blocked.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit)),
+              "dufort_frankel N=" + to_string(numberOfPoint) + " temporally blocked = naive loop");
+    }
+}
+
+/**
+ * @brief The threaded explicit runs give the serial result bit for bit, also with more threads than points.
+ */
+void testExplicitThreads()
+{
+    for (int numberOfPoint : {5, 621, 20000})
+    {
+        double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+        double deltat = 0.1 * deltax * deltax / D;
+        double t = deltat * 200;
+        vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+        ExplicitMethods serial;
+        vector<double> richardson = serial.richardsonMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+        vector<double> dufortFrankel = serial.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+        for (int threads : {2, 3, 8})
+        {
+            ExplicitMethods threaded;
+            check(identical(richardson, threaded.richardsonMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit, threads)),
+                  "richardson N=" + to_string(numberOfPoint) + " " + to_string(threads) + " threads = serial");
+            check(identical(dufortFrankel, threaded.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit, threads)),
+                  "dufort_frankel N=" + to_string(numberOfPoint) + " " + to_string(threads) + " threads = serial");
+        }
+    }
+}
+
+/**
+ * @brief The frames of a snapshot run written by SnapshotWriter and read back by SnapshotReader are the ones the
+ * observer received: bit for bit in float64, rounded to float in float32.
+ */
+void testSnapshotRoundTrip()
+{
+    int numberOfPoint = 201;
+    int frames = 5;
+    int stepsPerFrame = 20;
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    double deltat = 0.4 * deltax * deltax / D;
+    vector<double> temperatureInit = Initializer(deltat, deltat * frames * stepsPerFrame).getT_values(numberOfPoint, TSURF, TINIT);
+    vector<double> outputTimes;
+    for (int frame = 1; frame <= frames; frame++)
+    {
+        outputTimes.push_back((frame * stepsPerFrame + 1.5) * deltat);
+    }
+    const char *fileName = "tests_snapshot.snap";
+    for (bool singlePrecision : {false, true})
+    {
+        vector<double> times;
+        vector<vector<double>> observed;
+        {
+            SnapshotWriter writer(fileName, SnapshotWriter::makeHeader("dufort_frankel", numberOfPoint, deltax, deltat, D, TSURF, TINIT, singlePrecision));
+            ExplicitMethods explicitMethods;
+            explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, outputTimes, temperatureInit,
+                                                  [&](double t, span<const double> temperature)
+                                                  {
+                                                      times.push_back(t);
+                                                      observed.emplace_back(temperature.begin(), temperature.end());
+                                                      writer.write(t, temperature);
+                                                  });
+            writer.close();
+        }
+
+        SnapshotReader reader(fileName);
+        bool same = reader.getFrames() == static_cast<long>(observed.size()) && reader.getScheme() == "dufort_frankel";
+        vector<double> values;
+        for (long frame = 0; same && frame < reader.getFrames(); frame++)
+        {
+            reader.read(frame, values);
+            vector<double> expected = observed[frame];
+            if (singlePrecision)
+            {
+                for (double &value : expected)
+                {
+                    value = static_cast<float>(value);
+                }
+            }
+            same = reader.time(frame) == times[frame] && identical(values, expected);
+        }
+        check(same, string("snapshot ") + (singlePrecision ? "float32" : "float64") + " round trip of " + to_string(frames) + " frames");
+        std::remove(fileName);
+    }
+}
+
+/**
+ * @brief Laasonen with adaptive steps ends at the final time of laasonenMethod, within the tolerance of a fixed run
+ * at deltat / 256, and tightening the tolerance brings it closer; Crank-Nicholson with adaptive steps converges to
+ * its tight-tolerance result in the same way.
+ */
+void testAdaptive()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    double deltat = 0.01;
+    double t = 1.0;
+    double end = (static_cast<int>(t / deltat) - 1) * deltat;
+    vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+    ImplicitMethods implicitMethods;
+
+    //! Half a fine step past the end keeps the truncation of the reference exact
+    vector<double> reference = implicitMethods.laasonenMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat / 256, end + 1.5 * deltat / 256, temperatureInit);
+    ImplicitMethods::AdaptiveReport report;
+    vector<double> loose = implicitMethods.laasonenMethodAdaptive(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit, 1e-2, &report);
+    check(std::abs(report.endTime - end) <= 1e-12, "laasonen adaptive ends at the final time of laasonenMethod");
+    vector<double> tight = implicitMethods.laasonenMethodAdaptive(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit, 1e-4);
+    double looseError = maxDifference(loose, reference);
+    double tightError = maxDifference(tight, reference);
+    check(tightError <= 0.05 && tightError < looseError, withDifference("laasonen adaptive (tolerance 1e-4) = fixed deltat / 256", tightError, 0.05));
+
+    vector<double> converged = implicitMethods.crankNicholsonMethodAdaptive(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit, 1e-7);
+    looseError = maxDifference(implicitMethods.crankNicholsonMethodAdaptive(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit, 1e-2), converged);
+    tightError = maxDifference(implicitMethods.crankNicholsonMethodAdaptive(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit, 1e-4), converged);
+    check(tightError <= 0.05 && tightError < looseError, withDifference("crank_nicholson adaptive (tolerance 1e-4) = tolerance 1e-7", tightError, 0.05));
+
+    //! A started run goes on where it was after adaptive runs on another grid, also with the refined solves of Mixed
+    int coarsePoints = 41;
+    double coarseDeltax = (XMAX - XMIN) / static_cast<double>(coarsePoints - 1);
+    vector<double> coarseInit = Initializer(deltat, t).getT_values(coarsePoints, TSURF, TINIT);
+    const char *names[2] = {"laasonen", "crank_nicholson"};
+    ImplicitMethods::Scheme schemes[2] = {ImplicitMethods::Laasonen, ImplicitMethods::CrankNicholson};
+    for (int scheme = 0; scheme < 2; scheme++)
+    {
+        for (Precision precision : {Precision::Double, Precision::Mixed})
+        {
+            ImplicitMethods uninterrupted;
+            ImplicitMethods interrupted;
+            uninterrupted.setPrecision(precision);
+            interrupted.setPrecision(precision);
+            uninterrupted.start(schemes[scheme], DELTAX, numberOfPoint, TSURF, D, deltat, temperatureInit);
+            interrupted.start(schemes[scheme], DELTAX, numberOfPoint, TSURF, D, deltat, temperatureInit);
+            uninterrupted.step(40);
+            interrupted.step(20);
+            interrupted.laasonenMethodAdaptive(coarseDeltax, coarsePoints, TSURF, TINIT, D, deltat, t, coarseInit, 1e-2);
+            interrupted.crankNicholsonMethodAdaptive(coarseDeltax, coarsePoints, TSURF, TINIT, D, deltat, t, coarseInit, 1e-2);
+            interrupted.step(20);
+            check(identical(interrupted.current(), uninterrupted.current()),
+                  string(names[scheme]) + " run started in " + precisionName(precision) + " goes on unchanged after adaptive runs");
+        }
+    }
+}
+
+/**
+ * @brief With the steady-state detection, Dufort-Frankel, Laasonen and Crank-Nicholson stop before the final time
+ * on a profile whose distance to the steady state tsurf matches the tolerance: the slowest mode decays at
+ * D (pi / L)^2, so max |T - tsurf| is a small multiple of tolerance / (D (pi / L)^2).
+ */
+void testSteadyState()
+{
+    double tolerance = 1e-3;
+    double t = 30;
+    double decay = D * (M_PI / (XMAX - XMIN)) * (M_PI / (XMAX - XMIN));
+    double bound = 3 * tolerance / decay;
+    const char *names[3] = {"dufort_frankel", "laasonen", "crank_nicholson"};
+    for (int scheme = 0; scheme < 3; scheme++)
+    {
+        //! A coarse grid keeps the stable explicit time step large, and D deltat / deltax^2 small enough that the
+        //! oscillation of Crank-Nicholson dies out instead of holding the change above the tolerance
+        int numberOfPoint = 41;
+        double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+        double deltat = scheme == 0 ? 0.4 * deltax * deltax / D : 0.01;
+        vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+        ExplicitMethods explicitMethods;
+        ImplicitMethods implicitMethods;
+        explicitMethods.setSteadyStateDetection(tolerance);
+        implicitMethods.setSteadyStateDetection(tolerance);
+        vector<double> result;
+        bool steady;
+        double stopTime;
+        switch (scheme)
+        {
+        case 0:
+            result = explicitMethods.dufort_frankelMethods(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+            steady = explicitMethods.reachedSteadyState();
+            stopTime = explicitMethods.getStopTime();
+            break;
+        case 1:
+            result = implicitMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+            steady = implicitMethods.reachedSteadyState();
+            stopTime = implicitMethods.getStopTime();
+            break;
+        default:
+            result = implicitMethods.crankNicholsonMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+            steady = implicitMethods.reachedSteadyState();
+            stopTime = implicitMethods.getStopTime();
+            break;
+        }
+        double distance = 0;
+        for (double value : result)
+        {
+            distance = std::max(distance, std::abs(value - TSURF));
+        }
+        check(steady && stopTime < t - 1 && distance <= bound, withDifference(string(names[scheme]) + " stops at the steady state", distance, bound));
+    }
+}
+
+/**
+ * @brief The analytical solution matches a direct summation of its Fourier series with enough terms for every time,
+ * whichever series it uses, and its fused error norms match the norms computed from the evaluated profile.
+ */
+void testAnalytical()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    double length = XMAX - XMIN;
+    AnalyticalSolution analytical(D, TSURF, TINIT);
+    for (double t : {0.0001, 0.01, 0.5, 5.0})
+    {
+        vector<double> exact = analytical.evaluate(DELTAX, numberOfPoint, t);
+        double difference = 0;
+        for (int i = 0; i < numberOfPoint; i++)
+        {
+            //! exp(-D (n pi / L)^2 t) is below 1e-17 well before n = 4000 for t >= 1e-4
+            double x = i * DELTAX, sum = 0;
+            for (int j = 0; j < 2000; j++)
+            {
+                double n = 2 * j + 1;
+                sum += 4 / (n * M_PI) * std::sin(n * M_PI * x / length) * std::exp(-D * (n * M_PI / length) * (n * M_PI / length) * t);
+            }
+            double value = i == 0 || i == numberOfPoint - 1 ? TSURF : TSURF + (TINIT - TSURF) * sum;
+            difference = std::max(difference, std::abs(value - exact[i]));
+        }
+        ostringstream time;
+        time << t;
+        check(difference <= 1e-9, withDifference("analytical solution t=" + time.str() + " = direct Fourier sum", difference, 1e-9));
+
+        //! A profile slightly off the solution stands for a solver output
+        vector<double> profile = analytical.evaluate(DELTAX, numberOfPoint, t * 1.01);
+        AnalyticalSolution::ErrorNorms norms = analytical.errorNorms(DELTAX, profile, t);
+        double l1 = 0, l2 = 0;
+        for (int i = 0; i < numberOfPoint; i++)
+        {
+            l1 += std::abs(profile[i] - exact[i]);
+            l2 += (profile[i] - exact[i]) * (profile[i] - exact[i]);
+        }
+        l1 *= DELTAX;
+        l2 = std::sqrt(DELTAX * l2);
+        double linf = maxDifference(profile, exact);
+        check(std::abs(norms.l1 - l1) <= 1e-9 * (1 + l1) && std::abs(norms.l2 - l2) <= 1e-9 * (1 + l2) && std::abs(norms.linf - linf) <= 1e-9 * (1 + linf),
+              "analytical error norms t=" + time.str() + " = norms of the evaluated profile");
+    }
+}
+
+/**
+ * @brief The spectral Laasonen method (one transform, each mode raised to the number of steps) gives the stepped
+ * Laasonen result to 1e-10.
+ */
+void testSpectralLaasonen()
+{
+    for (int numberOfPoint : {41, 621})
+    {
+        double deltax = static_cast<double>(XMAX - XMIN) / (numberOfPoint - 1);
+        double deltat = 0.01;
+        double t = 0.5;
+        vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+        ImplicitMethods implicitMethods;
+        SpectralMethods spectralMethods;
+        vector<double> stepped = implicitMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+        vector<double> spectral = spectralMethods.laasonenMethod(deltax, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+        double difference = maxDifference(stepped, spectral);
+        check(difference <= 1e-10, withDifference("spectral laasonen N=" + to_string(numberOfPoint) + " = stepped laasonen", difference, 1e-10));
+    }
+}
+
+/**
+ * @brief Precision::Mixed keeps the implicit results at double accuracy, and the float storage of the explicit levels
+ * and the float solves stay within float round-off of the double results.
+ */
+void testPrecision()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    const char *names[3] = {"dufort_frankel", "laasonen", "crank_nicholson"};
+    for (int scheme = 0; scheme < 3; scheme++)
+    {
+        double deltat = scheme == 0 ? 0.4 * DELTAX * DELTAX / D : 0.01;
+        double t = deltat * 1000;
+        vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+        vector<double> reference;
+        for (Precision precision : {Precision::Double, Precision::Mixed, Precision::Float})
+        {
+            ExplicitMethods explicitMethods;
+            ImplicitMethods implicitMethods;
+            explicitMethods.setPrecision(precision);
+            implicitMethods.setPrecision(precision);
+            vector<double> result;
+            switch (scheme)
+            {
+            case 0:
+                result = explicitMethods.dufort_frankelMethods(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+                break;
+            case 1:
+                result = implicitMethods.laasonenMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+                break;
+            default:
+                result = implicitMethods.crankNicholsonMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit);
+                break;
+            }
+            if (precision == Precision::Double)
+            {
+                reference = result;
+                continue;
+            }
+            //! The float round-off of each step (about 6e-8 of the temperatures) accumulates over the 1000 steps; the
+            //! refined solves keep double accuracy
+            double bound = precision == Precision::Mixed && scheme > 0 ? 1e-9 : 5e-4 * TSURF;
+            double difference = maxDifference(result, reference);
+            check(difference <= bound, withDifference(string(names[scheme]) + " " + precisionName(precision) + " = double", difference, bound));
+        }
+    }
+}
+
+/**
+ * @brief A HeatSolver on several implicit threads rejects the reduced precisions and goes on with its run as if
+ * setPrecision had not been called.
+ */
+void testRejectedPrecision()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    double deltat = 0.01;
+    HeatProblem problem = {DELTAX, numberOfPoint, TSURF, D, deltat, Initializer(deltat, deltat * 40).getT_values(numberOfPoint, TSURF, TINIT)};
+    HeatSolver uninterrupted(HeatSolver::CrankNicholson, problem, 2);
+    uninterrupted.advance(40);
+    for (Precision precision : {Precision::Mixed, Precision::Float})
+    {
+        HeatSolver solver(HeatSolver::CrankNicholson, problem, 2);
+        solver.advance(20);
+        bool rejected = false;
+        try
+        {
+            solver.setPrecision(precision);
+        }
+        catch (const std::invalid_argument &)
+        {
+            rejected = true;
+        }
+        solver.advance(20);
+        check(rejected && solver.getLevel() == uninterrupted.getLevel() && identical(solver.temperature(), uninterrupted.temperature()),
+              string("crank_nicholson 2 threads rejects ") + precisionName(precision) + " and keeps its run");
+    }
+}
+
+/**
+ * @brief The ensembles of the four schemes give every member the result of its single-rod run bit for bit, on one
+ * thread and on several.
+ */
+void testEnsemble()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    int members = 7;
+    int numStep = 100;
+    const char *names[4] = {"richardson", "dufort_frankel", "laasonen", "crank_nicholson"};
+    EnsembleMethods::Scheme schemes[4] = {EnsembleMethods::Richardson, EnsembleMethods::DufortFrankel, EnsembleMethods::Laasonen, EnsembleMethods::CrankNicholson};
+    for (int scheme = 0; scheme < 4; scheme++)
+    {
+        double deltat = scheme == 0 ? 0.1 * DELTAX * DELTAX / D : scheme == 1 ? 0.4 * DELTAX * DELTAX / D : 0.01;
+        double t = deltat * numStep;
+        Initializer values(deltat, t);
+        vector<double> tsurf(members);
+        vector<vector<double>> temperatureInits(members);
+        vector<vector<double>> singles(members);
+        ExplicitMethods explicitMethods;
+        ImplicitMethods implicitMethods;
+        for (int k = 0; k < members; k++)
+        {
+            tsurf[k] = TSURF + k;
+            temperatureInits[k] = values.getT_values(numberOfPoint, tsurf[k], TINIT - k);
+            switch (scheme)
+            {
+            case 0:
+                singles[k] = explicitMethods.richardsonMethods(DELTAX, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]);
+                break;
+            case 1:
+                singles[k] = explicitMethods.dufort_frankelMethods(DELTAX, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]);
+                break;
+            case 2:
+                singles[k] = implicitMethods.laasonenMethod(DELTAX, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]);
+                break;
+            default:
+                singles[k] = implicitMethods.crankNicholsonMethod(DELTAX, numberOfPoint, tsurf[k], TINIT, D, deltat, t, temperatureInits[k]);
+                break;
+            }
+        }
+
+        for (int threads : {1, 3})
+        {
+            EnsembleMethods ensemble;
+            ensemble.setThreads(threads);
+            ensemble.load(numberOfPoint, tsurf, temperatureInits);
+            ensemble.run(schemes[scheme], DELTAX, D, deltat, t);
+            span<const double> temperatures = ensemble.getTemperatures();
+            bool same = true;
+            for (int k = 0; k < members; k++)
+            {
+                for (int i = 0; i < numberOfPoint; i++)
+                {
+                    same = same && std::memcmp(&temperatures[static_cast<size_t>(i) * members + k], &singles[k][i], sizeof(double)) == 0;
+                }
+            }
+            check(same, string(names[scheme]) + " ensemble of " + to_string(members) + ", " + to_string(threads) + " threads = single-rod runs");
+        }
+    }
+}
+
+/**
+ * @brief On a uniform grid the explicit schemes with per-point coefficients give the ExplicitMethods results within
+ * round-off, and on a stretched grid the Crank-Nicholson error against the analytical solution decreases with N.
+ */
+void testNonUniform()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    Grid grid = Grid::uniform(DELTAX, numberOfPoint, D);
+    NonUniformMethods methods;
+    ExplicitMethods explicitMethods;
+    //! Richardson is unstable at any time step: few enough steps that it stays finite
+    double deltat = 0.4 * grid.explicitTimeStepLimit();
+    vector<double> temperatureInit = Initializer(deltat, deltat * 200).getT_values(numberOfPoint, TSURF, TINIT);
+    //! Relative to max(1, |T|): the Richardson levels grow far above the temperatures, and so does their round-off
+    auto relativeDifference = [](const vector<double> &variable, const vector<double> &uniform)
+    {
+        double difference = 0;
+        for (size_t i = 0; i < uniform.size(); i++)
+        {
+            difference = std::max(difference, std::abs(variable[i] - uniform[i]) / std::max(1.0, std::abs(uniform[i])));
+        }
+        return difference;
+    };
+    double difference = relativeDifference(methods.solve(NonUniformMethods::Richardson, grid, TSURF, deltat, deltat * 50, temperatureInit),
+                                           explicitMethods.richardsonMethods(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, deltat * 50, temperatureInit));
+    check(difference <= 1e-10, withDifference("richardson on a uniform grid = ExplicitMethods (relative)", difference, 1e-10));
+    difference = relativeDifference(methods.solve(NonUniformMethods::DufortFrankel, grid, TSURF, deltat, deltat * 200, temperatureInit),
+                                    explicitMethods.dufort_frankelMethods(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, deltat * 200, temperatureInit));
+    check(difference <= 1e-12, withDifference("dufort_frankel on a uniform grid = ExplicitMethods (relative)", difference, 1e-12));
+
+    AnalyticalSolution analytical(D, TSURF, TINIT);
+    double errors[3];
+    int sizes[3] = {41, 81, 161};
+    for (int k = 0; k < 3; k++)
+    {
+        Grid stretched = Grid::stretched(XMAX - XMIN, sizes[k], D, 1);
+        deltat = 1e-4;
+        methods.setup(NonUniformMethods::CrankNicholson, stretched, deltat);
+        span<const double> temperature = methods.run(TSURF, 0.5, Initializer(deltat, 0.5).getT_values(sizes[k], TSURF, TINIT));
+        errors[k] = analytical.errorNorms(stretched.getPositions(), temperature, methods.getTime()).linf;
+    }
+    ostringstream what;
+    what << "crank_nicholson on stretched grids: Linf " << errors[0] << ", " << errors[1] << ", " << errors[2] << " for N = 41, 81, 161";
+    check(errors[2] < errors[1] && errors[1] < errors[0], what.str());
+}
+
+/**
+ * @brief The ADI schemes on a plate and a block follow the product of the 1D analytical solutions along each axis,
+ * and their threaded runs give the serial result bit for bit.
+ */
+void testMultiDimensional()
+{
+    int numberOfPoint = 41;
+    double deltax = (XMAX - XMIN) / static_cast<double>(numberOfPoint - 1);
+    double deltat = 0.01;
+    double t = 1.0;
+    AnalyticalSolution analytical(D, TSURF, TINIT);
+    const char *names[2] = {"peaceman_rachford", "douglas"};
+    MultiDimensionalMethods::Scheme schemes[2] = {MultiDimensionalMethods::PeacemanRachford, MultiDimensionalMethods::Douglas};
+    for (int nz : {1, numberOfPoint})
+    {
+        vector<double> temperatureInit = MultiDimensionalMethods::initialField(numberOfPoint, numberOfPoint, nz, TSURF, TINIT);
+        for (int scheme = 0; scheme < 2; scheme++)
+        {
+            if (schemes[scheme] == MultiDimensionalMethods::PeacemanRachford && nz > 1)
+            {
+                continue;
+            }
+            MultiDimensionalMethods methods;
+            vector<double> temperature = methods.solve(schemes[scheme], deltax, numberOfPoint, numberOfPoint, nz, TSURF, D, deltat, t, temperatureInit);
+
+            //! theta = (T - TSURF) / (TINIT - TSURF) of the block is the product of those of the walls along each axis
+            vector<double> wall = analytical.evaluate(deltax, numberOfPoint, methods.getTime());
+            double error = 0;
+            for (int k = 0; k < nz; k++)
+            {
+                double thetaZ = nz == 1 ? 1 : (wall[k] - TSURF) / (TINIT - TSURF);
+                for (int j = 0; j < numberOfPoint; j++)
+                {
+                    for (int i = 0; i < numberOfPoint; i++)
+                    {
+                        double theta = thetaZ * (wall[j] - TSURF) / (TINIT - TSURF) * (wall[i] - TSURF) / (TINIT - TSURF);
+                        error = std::max(error, std::abs(temperature[(static_cast<size_t>(k) * numberOfPoint + j) * numberOfPoint + i] - (TSURF + (TINIT - TSURF) * theta)));
+                    }
+                }
+            }
+            string run = string(names[scheme]) + (nz == 1 ? " 2D" : " 3D");
+            check(error <= 1e-2, withDifference(run + " = product of the 1D analytical solutions", error, 1e-2));
+
+            MultiDimensionalMethods threaded;
+            threaded.setThreads(3);
+            check(identical(temperature, threaded.solve(schemes[scheme], deltax, numberOfPoint, numberOfPoint, nz, TSURF, D, deltat, t, temperatureInit)),
+                  run + " 3 threads = serial");
+        }
+    }
+}
+
+/**
+ * @brief A HeatSolver run stopped at a checkpoint and restarted from the file in a new solver ends on the
+ * uninterrupted run bit for bit, for the four schemes.
+ */
+void testCheckpointRestart()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    int numStep = 400;
+    const char *fileName = "tests_checkpoint.ckpt";
+    const char *names[4] = {"richardson", "dufort_frankel", "laasonen", "crank_nicholson"};
+    HeatSolver::Scheme schemes[4] = {HeatSolver::Richardson, HeatSolver::DufortFrankel, HeatSolver::Laasonen, HeatSolver::CrankNicholson};
+    for (int scheme = 0; scheme < 4; scheme++)
+    {
+        double deltat = scheme == 0 ? 0.1 * DELTAX * DELTAX / D : scheme == 1 ? 0.4 * DELTAX * DELTAX / D : 0.01;
+        HeatProblem problem = {DELTAX, numberOfPoint, TSURF, D, deltat, Initializer(deltat, deltat * numStep).getT_values(numberOfPoint, TSURF, TINIT)};
+
+        HeatSolver uninterrupted(schemes[scheme], problem);
+        uninterrupted.advance(numStep);
+
+        {
+            HeatSolver interrupted(schemes[scheme], problem);
+            CheckpointWriter writer(fileName, false);
+            interrupted.advance(numStep / 2);
+            interrupted.writeCheckpoint(writer);
+        }
+        HeatSolver resumed(schemes[scheme], problem);
+        resumed.restart(CheckpointReader(fileName));
+        resumed.advance(uninterrupted.getLevel() - resumed.getLevel());
+        check(resumed.getLevel() == uninterrupted.getLevel() && identical(resumed.temperature(), uninterrupted.temperature()),
+              string(names[scheme]) + " restart from a checkpoint = uninterrupted run");
+        std::remove(fileName);
+    }
+}
+
+/**
+ * @brief Forcing the Thomas backend of BandedSolver on the default operator gives the result of the tridiagonal path
+ * bit for bit, for both implicit schemes.
+ */
+void testForcedThomas()
+{
+    int numberOfPoint = NUMBER_OF_POINTS;
+    double deltat = 0.01;
+    double t = 1.0;
+    vector<double> temperatureInit = Initializer(deltat, t).getT_values(numberOfPoint, TSURF, TINIT);
+    ImplicitMethods tridiagonal;
+    ImplicitMethods banded;
+    banded.setLinearSolver(BandedSolver::Thomas);
+    check(identical(tridiagonal.laasonenMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit),
+                    banded.laasonenMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit)),
+          "laasonen with the BandedSolver Thomas backend = tridiagonal path");
+    check(identical(tridiagonal.crankNicholsonMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit),
+                    banded.crankNicholsonMethod(DELTAX, numberOfPoint, TSURF, TINIT, D, deltat, t, temperatureInit)),
+          "crank_nicholson with the BandedSolver Thomas backend = tridiagonal path");
+}
+
+int main()
+{
+    //! ./tests: one line per check, exit status 1 when one fails
+    testBatch();
+    testTemporalBlocking();
+    testExplicitThreads();
+    testSnapshotRoundTrip();
+    testAdaptive();
+    testSteadyState();
+    testAnalytical();
+    testSpectralLaasonen();
+    testPrecision();
+    testRejectedPrecision();
+    testEnsemble();
+    testNonUniform();
+    testMultiDimensional();
+    testCheckpointRestart();
+    testForcedThomas();
+
+    if (g_failures > 0)
+    {
+        cout << g_failures << " check(s) failed" << endl;
+        return 1;
+    }
+    cout << "All checks passed" << endl;
+    return 0;
+}